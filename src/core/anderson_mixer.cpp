@@ -0,0 +1,125 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "anderson_mixer.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <Eigen/QR>
+#include "util/error.hpp"
+
+namespace {
+// Mixing coefficients larger than this indicate that the history has become
+// nearly linearly dependent.
+const mocc::real_t max_coeff = 1.0e4;
+}
+
+namespace mocc {
+AndersonMixer::AndersonMixer(int depth, real_t damping, real_t growth)
+    : depth_(depth),
+      damping_(damping),
+      growth_(growth),
+      have_x_(false),
+      have_f_(false),
+      residual_(0.0),
+      n_restart_(0)
+{
+    if (depth_ < 1) {
+        throw EXCEPT("Anderson depth must be at least 1");
+    }
+    if ((damping_ <= 0.0) || (damping_ > 1.0)) {
+        throw EXCEPT("Anderson damping must be in (0, 1]");
+    }
+    if (growth_ <= 1.0) {
+        throw EXCEPT("Anderson growth factor must be greater than 1");
+    }
+    return;
+}
+
+VectorX AndersonMixer::mix(const VectorX &g)
+{
+    if (!have_x_) {
+        x_      = g;
+        have_x_ = true;
+        return x_;
+    }
+
+    assert(g.size() == x_.size());
+
+    VectorX f = g - x_;
+    residual_ = f.norm();
+
+    bool restart = false;
+    if (have_f_) {
+        if (residual_ > growth_ * f_.norm()) {
+            restart = true;
+        } else {
+            df_.push_back(f - f_);
+            dg_.push_back(g - g_);
+            if ((int)df_.size() > depth_) {
+                df_.pop_front();
+                dg_.pop_front();
+            }
+        }
+    }
+
+    VectorX x_new;
+    if (!restart && !df_.empty()) {
+        int m = df_.size();
+        MatrixX df(f.size(), m);
+        for (int i = 0; i < m; i++) {
+            df.col(i) = df_[i];
+        }
+        VectorX gamma = df.colPivHouseholderQr().solve(f);
+
+        if (gamma.allFinite() && (gamma.cwiseAbs().maxCoeff() < max_coeff)) {
+            VectorX f_bar = f - df * gamma;
+            x_new         = g - (1.0 - damping_) * f_bar;
+            for (int i = 0; i < m; i++) {
+                x_new -= gamma[i] * dg_[i];
+            }
+        } else {
+            restart = true;
+        }
+    }
+
+    if (restart) {
+        n_restart_++;
+        df_.clear();
+        dg_.clear();
+    }
+
+    if (x_new.size() == 0) {
+        x_new = g - (1.0 - damping_) * f;
+    }
+
+    f_      = f;
+    g_      = g;
+    have_f_ = true;
+    x_      = x_new;
+
+    return x_;
+}
+
+void AndersonMixer::reset()
+{
+    have_x_ = false;
+    have_f_ = false;
+    df_.clear();
+    dg_.clear();
+    return;
+}
+}
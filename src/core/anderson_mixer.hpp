@@ -0,0 +1,109 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <deque>
+
+#include "util/global_config.hpp"
+#include "eigen_interface.hpp"
+
+namespace mocc {
+/**
+ * \brief Anderson mixing for a fixed-point iteration x = G(x).
+ *
+ * The mixer is handed successive evaluations of the fixed-point map, g_n =
+ * G(x_n), where x_n is the iterate that it returned on the previous call. It
+ * keeps a limited history of the differences in g and in the residual f = g
+ * - x, and returns the combination of past evaluations that minimizes the
+ * linearized residual (the "type II" formulation of Walker and Ni).
+ *
+ * Two safeguards are applied: if the residual norm grows by more than a
+ * specified factor from one call to the next, or if the mixing coefficients
+ * become very large (indicating an ill-conditioned history), the history is
+ * discarded and the plain fixed-point update is returned instead.
+ */
+class AndersonMixer {
+public:
+    /**
+     * \brief Construct an Anderson mixer
+     *
+     * \param depth the maximum number of difference vectors to keep
+     * \param damping the relaxation factor applied to the residual. A value
+     * of 1.0 applies no damping.
+     * \param growth the factor by which the residual norm may grow between
+     * successive calls before the history is restarted.
+     */
+    AndersonMixer(int depth, real_t damping = 1.0, real_t growth = 2.0);
+
+    /**
+     * \brief Given g = G(x) for the last iterate x, return the next iterate.
+     *
+     * On the first call (or after \ref reset()), \p g is returned unaltered.
+     */
+    VectorX mix(const VectorX &g);
+
+    /**
+     * \brief Discard all history.
+     */
+    void reset();
+
+    /**
+     * \brief Return the number of difference vectors currently stored
+     */
+    int history() const
+    {
+        return (int)df_.size();
+    }
+
+    /**
+     * \brief Return the number of times the history has been restarted by
+     * the safeguards
+     */
+    int n_restart() const
+    {
+        return n_restart_;
+    }
+
+    /**
+     * \brief Return the norm of the residual from the last call to \ref
+     * mix()
+     */
+    real_t residual() const
+    {
+        return residual_;
+    }
+
+private:
+    int depth_;
+    real_t damping_;
+    real_t growth_;
+
+    // Last iterate returned, and the last evaluation/residual
+    VectorX x_;
+    VectorX g_;
+    VectorX f_;
+    bool have_x_;
+    bool have_f_;
+
+    // History of differences in residual and in G
+    std::deque<VectorX> df_;
+    std::deque<VectorX> dg_;
+
+    real_t residual_;
+    int n_restart_;
+};
+}
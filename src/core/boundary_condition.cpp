@@ -16,7 +16,9 @@
 
 #include "core/boundary_condition.hpp"
 
+#include <algorithm>
 #include "util/error.hpp"
+#include "util/h5file.hpp"
 
 namespace mocc {
 
@@ -142,6 +144,20 @@ void BoundaryCondition::initialize_spectrum(const ArrayB1 &spectrum)
     return;
 }
 
+void BoundaryCondition::checkpoint(H5Node &node,
+                                   const std::string &path) const
+{
+    node.write(path, data_);
+    return;
+}
+
+void BoundaryCondition::restart(H5Node &node, const std::string &path)
+{
+    assert(data_.size() > 0);
+    node.read(path, data_);
+    return;
+}
+
 void BoundaryCondition::update(int group, const BoundaryCondition &out)
 {
     assert(out.n_group_ == 1);
@@ -170,14 +186,18 @@ void BoundaryCondition::update(int group, int angle,
         int offset_out       = out.offset_(angle, (int)n);
         ;
 
+        // Work with raw pointers rather than Blitz slices, since slicing
+        // touches the reference count of the shared storage, and different
+        // groups may be updated concurrently
+        real_t *data_in        = data_.data() + offset_in;
+        const real_t *data_out = out.data_.data() + offset_out;
         switch (bc_[(int)(angle_in.upwind_surface(n))]) {
         case Boundary::VACUUM:
-            data_(blitz::Range(offset_in, offset_in + size - 1)) = 0.0;
+            std::fill(data_in, data_in + size, 0.0);
             break;
 
         case Boundary::REFLECT:
-            data_(blitz::Range(offset_in, offset_in + size - 1)) =
-                out.data_(blitz::Range(offset_out, offset_out + size - 1));
+            std::copy(data_out, data_out + size, data_in);
             break;
 
         case Boundary::PRESCRIBED:
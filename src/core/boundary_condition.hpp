@@ -17,6 +17,7 @@
 #pragma once
 
 #include <array>
+#include <string>
 
 #include "util/blitz_typedefs.hpp"
 #include "util/global_config.hpp"
@@ -24,6 +25,7 @@
 #include "constants.hpp"
 
 namespace mocc {
+class H5Node;
 
 typedef std::array<int, 3> BC_Size_t;
 typedef std::array<Boundary, 6> BC_Type_t;
@@ -86,6 +88,32 @@ public:
      */
     BoundaryCondition(const BoundaryCondition &rhs);
 
+    /**
+     * \brief Copy the boundary values from another \ref BoundaryCondition
+     * of the same size
+     */
+    void copy_values(const BoundaryCondition &rhs)
+    {
+        assert(rhs.size() == this->size());
+        data_ = rhs.data_;
+        return;
+    }
+
+    /**
+     * \brief Write the boundary values to a checkpoint
+     *
+     * \param node the HDF5 node in which to write the values
+     * \param path the name of the dataset to write
+     */
+    void checkpoint(H5Node &node, const std::string &path) const;
+
+    /**
+     * \brief Read the boundary values from a checkpoint written by \ref
+     * checkpoint(). The dataset must be of the same size as the boundary
+     * condition.
+     */
+    void restart(H5Node &node, const std::string &path);
+
     /**
      * \brief Return the total number of boundary condition points.
      */
@@ -0,0 +1,111 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "chebyshev_accelerator.hpp"
+
+#include <cmath>
+#include "util/error.hpp"
+
+namespace {
+// Upper limit for the dominance ratio estimate. The Chebyshev parameters are
+// singular as the dominance ratio approaches unity.
+const mocc::real_t max_sigma = 0.999;
+}
+
+namespace mocc {
+ChebyshevAccelerator::ChebyshevAccelerator(int order, int delay)
+    : order_(order),
+      delay_(delay),
+      have_x_(false),
+      p_(0),
+      n_plain_(0),
+      n_needed_(delay),
+      sigma_(-1.0),
+      residual_prev_(-1.0),
+      residual_cycle_start_(0.0),
+      n_fail_(0)
+{
+    if (order_ < 1) {
+        throw EXCEPT("Chebyshev order must be at least 1");
+    }
+    if (delay_ < 1) {
+        throw EXCEPT("Chebyshev delay must be at least 1");
+    }
+    return;
+}
+
+VectorX ChebyshevAccelerator::extrapolate(const VectorX &g, real_t residual)
+{
+    if (!have_x_) {
+        x_      = g;
+        x_prev_ = g;
+        have_x_ = true;
+        return x_;
+    }
+
+    // Update the dominance ratio estimate if the last iterate was not
+    // extrapolated.
+    if ((p_ == 0) && (residual_prev_ > 0.0)) {
+        real_t ratio = residual / residual_prev_;
+        // After a successful cycle, the residual has been damped across the
+        // spectrum, which tends to underestimate the dominance ratio. Keep
+        // the larger estimate.
+        sigma_ = (n_plain_ == 0 && sigma_ > 0.0) ? std::max(sigma_, ratio)
+                                                 : ratio;
+        n_plain_++;
+    }
+
+    // Check the outcome of a completed cycle
+    if (p_ == order_) {
+        p_       = 0;
+        n_plain_ = 0;
+        if (residual > residual_cycle_start_) {
+            n_fail_++;
+            sigma_    = -1.0;
+            n_needed_ = delay_;
+        } else {
+            n_needed_ = 1;
+        }
+    }
+
+    VectorX x;
+    if (p_ == 0) {
+        if ((n_plain_ >= n_needed_) && (sigma_ > 0.0) && (sigma_ < 1.0)) {
+            // Start a new cycle
+            sigma_                = std::min(sigma_, max_sigma);
+            residual_cycle_start_ = residual;
+            p_                    = 1;
+            real_t alpha          = 2.0 / (2.0 - sigma_);
+            x                     = x_ + alpha * (g - x_);
+        } else {
+            x = g;
+        }
+    } else {
+        p_++;
+        real_t gamma = std::acosh(2.0 / sigma_ - 1.0);
+        real_t alpha = 4.0 / sigma_ * std::cosh((p_ - 1) * gamma) /
+                       std::cosh(p_ * gamma);
+        real_t beta = (1.0 - 0.5 * sigma_) * alpha - 1.0;
+        x           = x_ + alpha * (g - x_) + beta * (x_ - x_prev_);
+    }
+
+    residual_prev_ = residual;
+    x_prev_        = x_;
+    x_             = x;
+
+    return x_;
+}
+}
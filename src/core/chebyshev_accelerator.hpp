@@ -0,0 +1,106 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "util/global_config.hpp"
+#include "eigen_interface.hpp"
+
+namespace mocc {
+/**
+ * \brief Chebyshev semi-iterative extrapolation for a fixed-point iteration x
+ * = G(x), such as the power iteration.
+ *
+ * The accelerator is handed successive evaluations of the fixed-point map, g_n
+ * = G(x_n), along with the norm of the residual g_n - x_n, where x_n is the
+ * iterate that it returned on the previous call. It alternates between
+ * unextrapolated iterations, which are used to estimate the dominance ratio
+ * from the ratio of successive residual norms, and cycles of Chebyshev
+ * extrapolation of a fixed length. The extrapolation assumes that the
+ * eigenvalues of the error propagation operator lie in [0, σ], where σ is the
+ * estimated dominance ratio.
+ *
+ * If the residual at the end of a cycle is larger than at the start, the
+ * dominance ratio estimate is considered unreliable, and a fresh estimate is
+ * made after a number of unextrapolated iterations.
+ */
+class ChebyshevAccelerator {
+public:
+    /**
+     * \brief Construct a Chebyshev accelerator
+     *
+     * \param order the number of extrapolated iterations in each cycle
+     * \param delay the number of unextrapolated iterations to perform before
+     * the first cycle, and after a failed cycle
+     */
+    ChebyshevAccelerator(int order, int delay);
+
+    /**
+     * \brief Given g = G(x) for the last iterate x and the norm of g - x,
+     * return the next iterate.
+     */
+    VectorX extrapolate(const VectorX &g, real_t residual);
+
+    /**
+     * \brief Return the current estimate of the dominance ratio. Negative if
+     * there is not yet an estimate.
+     */
+    real_t dominance_ratio() const
+    {
+        return sigma_;
+    }
+
+    /**
+     * \brief Return whether the last iterate was extrapolated
+     */
+    bool active() const
+    {
+        return p_ > 0;
+    }
+
+    /**
+     * \brief Return the number of cycles that have failed to reduce the
+     * residual
+     */
+    int n_fail() const
+    {
+        return n_fail_;
+    }
+
+private:
+    int order_;
+    int delay_;
+
+    // Last two iterates returned
+    VectorX x_;
+    VectorX x_prev_;
+    bool have_x_;
+
+    // Position in the current cycle. Zero when performing unextrapolated
+    // iterations
+    int p_;
+
+    // Number of consecutive unextrapolated iterations with a residual ratio,
+    // and the number needed before starting the next cycle
+    int n_plain_;
+    int n_needed_;
+
+    real_t sigma_;
+    real_t residual_prev_;
+    real_t residual_cycle_start_;
+    int n_fail_;
+};
+}
@@ -24,7 +24,9 @@
 #include "util/error.hpp"
 #include "util/files.hpp"
 #include "util/global_config.hpp"
+#include "util/string_utils.hpp"
 #include "util/validate_input.hpp"
+#include "parallel_environment.hpp"
 
 typedef Eigen::Triplet<mocc::real_t> T;
 typedef Eigen::SparseMatrix<mocc::real_t> M;
@@ -33,7 +35,8 @@ namespace {
 using namespace mocc;
 const std::vector<std::string> recognized_attributes = {
     "enabled",  "k_tol",          "psi_tol",     "residual_reduction",
-    "max_iter", "negative_fixup", "dump_current"};
+    "max_iter", "negative_fixup", "dump_current",       "few_group",
+    "smooth",   "pcmfd"};
 
 /**
  * \brief Helper function for making the CMFD mesh
@@ -80,7 +83,9 @@ CMFD::CMFD(const pugi::xml_node &input, const CoreMesh *mesh,
       source_(n_cell_, &xsmesh_, coarse_data_.flux),
       m_(n_group_, Eigen::SparseMatrix<real_t>(n_cell_, n_cell_)),
       solvers_(n_group_),
+      is_distributed_(ParEnv.comm().size() > 1),
       d_hat_(n_surf_, n_group_),
+      d_hat_m_(n_surf_, n_group_),
       d_tilde_(n_surf_, n_group_),
       s_hat_(n_surf_, n_group_),
       s_tilde_(n_surf_, n_group_),
@@ -89,8 +94,13 @@ CMFD::CMFD(const pugi::xml_node &input, const CoreMesh *mesh,
       psi_tol_(1.0e-5),
       resid_reduction_(0.001),
       max_iter_(100),
+      last_iter_(0),
+      last_converged_(false),
       zero_fixup_(false),
-      dump_current_(false)
+      dump_current_(false),
+      pcmfd_(false),
+      n_few_group_(0),
+      fg_smooth_(false)
 {
     // Check input attributes
     validate_input(input, recognized_attributes);
@@ -114,6 +124,21 @@ CMFD::CMFD(const pugi::xml_node &input, const CoreMesh *mesh,
         m.makeCompressed();
     }
 
+    // Split the linear solves over all processes, if there are more than
+    // one. Partitions are aligned to whole planes when possible. The
+    // matrices are still assembled in full on every process, and each solve
+    // gathers the full solution back to all of them.
+    int n_cell_plane = n_cell_ / mesh_.nz();
+    if (is_distributed_) {
+        dist_solvers_.reserve(n_group_);
+        for (int ig = 0; ig < n_group_; ig++) {
+            dist_solvers_.emplace_back(std::make_unique<DistributedBiCGSTAB>(
+                ParEnv.comm(), n_cell_, n_cell_plane));
+        }
+        LogFile << "CMFD linear solves split over " << ParEnv.comm().size()
+                << " processes (matrix assembly is replicated)" << std::endl;
+    }
+
     // Parse options from the XML, if present
     if (!input.empty()) {
         // Eigenvalue tolerance
@@ -161,6 +186,80 @@ CMFD::CMFD(const pugi::xml_node &input, const CoreMesh *mesh,
         if (!input.attribute("dump_current").empty()) {
             dump_current_ = input.attribute("dump_current").as_bool(false);
         }
+
+        // Partial-current CMFD
+        if (!input.attribute("pcmfd").empty()) {
+            pcmfd_ = input.attribute("pcmfd").as_bool(false);
+        }
+
+        // Few-group structure. Specified as the last fine group (1-based) in
+        // each few group
+        if (!input.attribute("few_group").empty()) {
+            VecI last_groups;
+            try {
+                last_groups =
+                    explode_string<int>(input.attribute("few_group").value());
+            } catch (Exception e) {
+                throw EXCEPT_E("Failed to parse few-group structure", e);
+            }
+            if (last_groups.empty() || (last_groups.back() != n_group_)) {
+                throw EXCEPT("Few-group structure must end with the last "
+                             "energy group");
+            }
+            fg_bounds_.push_back(0);
+            for (int g : last_groups) {
+                if (g <= fg_bounds_.back()) {
+                    throw EXCEPT("Few-group structure must be strictly "
+                                 "increasing");
+                }
+                fg_bounds_.push_back(g);
+            }
+            n_few_group_ = last_groups.size();
+        }
+
+        if (!input.attribute("smooth").empty()) {
+            fg_smooth_ = input.attribute("smooth").as_bool(false);
+            if (fg_smooth_ && (n_few_group_ == 0)) {
+                Warn("CMFD smoothing requested without a few-group "
+                     "structure. Ignoring.");
+                fg_smooth_ = false;
+            }
+        }
+    }
+
+    // Allocate space for the few-group system
+    if (n_few_group_ > 0) {
+        fg_map_.resize(n_group_);
+        for (int ifg = 0; ifg < n_few_group_; ifg++) {
+            for (int ig = fg_bounds_[ifg]; ig < fg_bounds_[ifg + 1]; ig++) {
+                fg_map_[ig] = ifg;
+            }
+        }
+        fg_flux_.resize(n_cell_, n_few_group_);
+        fg_flux_old_.resize(n_cell_, n_few_group_);
+        fg_xsrm_.resize(n_few_group_, VecF(n_cell_, 0.0));
+        fg_xsnf_.resize(n_few_group_, VecF(n_cell_, 0.0));
+        fg_xsch_.resize(n_few_group_, VecF(n_cell_, 0.0));
+        fg_d_.resize(n_few_group_, VecF(n_cell_, 0.0));
+        fg_scat_.resize(n_cell_, n_few_group_, n_few_group_);
+        fg_d_tilde_.resize(n_surf_, n_few_group_);
+        fg_d_hat_.resize(n_surf_, n_few_group_);
+        fg_d_hat_m_.resize(n_surf_, n_few_group_);
+        fg_b_.resize(n_cell_);
+        fg_m_.resize(n_few_group_, m_.front());
+        fg_solvers_ = std::vector<Eigen::BiCGSTAB<Eigen::SparseMatrix<real_t>>>(
+            n_few_group_);
+        if (is_distributed_) {
+            fg_dist_solvers_.reserve(n_few_group_);
+            for (int ifg = 0; ifg < n_few_group_; ifg++) {
+                fg_dist_solvers_.emplace_back(
+                    std::make_unique<DistributedBiCGSTAB>(
+                        ParEnv.comm(), n_cell_, n_cell_plane));
+            }
+        }
+
+        LogFile << "CMFD will be solved with " << n_few_group_
+                << " energy groups" << std::endl;
     }
 
     timer_.toc();
@@ -172,6 +271,99 @@ void CMFD::solve(real_t &k)
 {
     timer_.tic();
 
+    this->begin_solve();
+
+    timer_solve_.tic();
+
+    if (n_few_group_ > 0) {
+        this->solve_few_group(k);
+    } else {
+        this->solve_multigroup(k);
+    }
+
+    this->end_solve();
+
+    timer_solve_.toc();
+    timer_.toc();
+    return;
+} // solve()
+
+void CMFD::solve_fixed_source(const ArrayB2 &q)
+{
+    assert(q.extent(0) == n_cell_);
+    assert(q.extent(1) == n_group_);
+
+    timer_.tic();
+
+    this->begin_solve();
+
+    timer_solve_.tic();
+
+    for (auto &solver : solvers_) {
+        solver.setTolerance(resid_reduction_);
+    }
+    for (auto &solver : dist_solvers_) {
+        solver->setTolerance(resid_reduction_);
+    }
+
+    ArrayB1 flux_old(n_cell_);
+    int iter        = 0;
+    real_t r0       = 0.0;
+    real_t ri       = 0.0;
+    real_t flux_err = 0.0;
+    while (true) {
+        iter++;
+
+        ri          = 0.0;
+        real_t diff = 0.0;
+        real_t norm = 0.0;
+        for (int group = 0; group < n_group_; group++) {
+            ArrayB1 flux_1g = coarse_data_.flux(blitz::Range::all(), group);
+            flux_old        = flux_1g;
+
+            source_.group_source(group, nullptr);
+            source_.auxiliary(q(blitz::Range::all(), group));
+            source_.scale(mesh_.coarse_volume());
+
+            ri += this->solve_1g(group);
+
+            for (int i = 0; i < n_cell_; i++) {
+                real_t e = flux_1g(i) - flux_old(i);
+                diff += e * e;
+                norm += flux_1g(i) * flux_1g(i);
+            }
+        }
+        ri       = std::sqrt(ri) / (n_cell_ * n_group_);
+        flux_err = norm > 0.0 ? std::sqrt(diff / norm) : 0.0;
+        if (iter == 1) {
+            // The residual returned by the first group solves is that of the
+            // initial guess
+            r0 = ri > 0.0 ? ri : 1.0;
+        }
+
+        last_converged_ =
+            (flux_err < psi_tol_) && (ri / r0 < resid_reduction_);
+        if (last_converged_ || (iter > max_iter_)) {
+            break;
+        }
+    }
+    last_iter_ = iter;
+
+    auto flags = LogScreen.flags();
+    LogScreen << "       " << std::setprecision(5) << std::setw(6) << std::fixed
+              << RootTimer.time() << " " << iter << " " << std::scientific
+              << flux_err << " " << std::scientific << ri / r0 << std::endl;
+    LogScreen.flags(flags);
+
+    this->end_solve();
+
+    timer_solve_.toc();
+    timer_.toc();
+    return;
+} // solve_fixed_source()
+
+void CMFD::begin_solve()
+{
     // Make sure no negative flux
     if (zero_fixup_) {
         for (int ig = 0; ig < (int)m_.size(); ig++) {
@@ -189,8 +381,35 @@ void CMFD::solve(real_t &k)
     // Set up the linear systems
     this->setup_solve();
 
-    timer_solve_.tic();
+    return;
+}
+
+void CMFD::end_solve()
+{
+    // Clean up any negative values. These shouldnt be present at convergence,
+    // but sometimes things are nasty on the way there.
+    int n_neg = 0;
+    for (auto &v : coarse_data_.flux) {
+        if (v < 0.0) {
+            n_neg++;
+            v = -v;
+        }
+    }
+    if (n_neg > 0) {
+        LogFile << "Had to fix " << n_neg
+                << "negative fluxes coming from CMFD\n";
+    }
+
+    // Calculate the resultant currents and store back onto the coarse data
+    this->store_currents();
 
+    n_solve_++;
+
+    return;
+}
+
+void CMFD::solve_multigroup(real_t &k)
+{
     real_t k_old = k;
     this->fission_source(k);
     real_t tfis = this->total_fission();
@@ -202,6 +421,9 @@ void CMFD::solve(real_t &k)
     for (auto &solver : solvers_) {
         solver.setTolerance(resid_reduction_ * r0);
     }
+    for (auto &solver : dist_solvers_) {
+        solver->setTolerance(resid_reduction_ * r0);
+    }
 
     auto flags = LogScreen.flags();
     LogScreen << "CMFD Converging to " << std::scientific << k_tol_ << " "
@@ -221,9 +443,7 @@ void CMFD::solve(real_t &k)
 
         ri = 0.0;
         for (int group = 0; group < n_group_; group++) {
-            source_.initialize_group(group);
-            source_.fission(fs_, group);
-            source_.in_scatter(group);
+            source_.group_source(group, &fs_);
             source_.scale(mesh_.coarse_volume());
 
             ri += this->solve_1g(group);
@@ -242,9 +462,9 @@ void CMFD::solve(real_t &k)
         }
         psi_err = std::sqrt(psi_err);
 
-        if (((std::abs(k - k_old) < k_tol_) && (psi_err < psi_tol_) &&
-             (ri / r0 < resid_reduction_)) ||
-            (iter > max_iter_)) {
+        last_converged_ = (std::abs(k - k_old) < k_tol_) &&
+                          (psi_err < psi_tol_) && (ri / r0 < resid_reduction_);
+        if (last_converged_ || (iter > max_iter_)) {
             break;
         }
 
@@ -253,30 +473,10 @@ void CMFD::solve(real_t &k)
         }
     }
     this->print(iter, k, std::abs(k - k_old), psi_err, ri / r0);
+    last_iter_ = iter;
 
-    // Clean up any negative values. These shouldnt be present at convergence,
-    // but sometimes things are nasty on the way there.
-    int n_neg = 0;
-    for (auto &v : coarse_data_.flux) {
-        if (v < 0.0) {
-            n_neg++;
-            v = -v;
-        }
-    }
-    if (n_neg > 0) {
-        LogFile << "Had to fix " << n_neg
-                << "negative fluxes coming from CMFD\n";
-    }
-
-    // Calculate the resultant currents and store back onto the coarse data
-    this->store_currents();
-
-    n_solve_++;
-
-    timer_solve_.toc();
-    timer_.toc();
     return;
-} // solve()
+}
 
 real_t CMFD::solve_1g(int group)
 {
@@ -288,7 +488,11 @@ real_t CMFD::solve_1g(int group)
 
     real_t resid = this->residual(group);
 
-    x_ = solvers_[group].solveWithGuess(source_.get(), x_);
+    if (is_distributed_) {
+        x_ = dist_solvers_[group]->solveWithGuess(source_.get(), x_);
+    } else {
+        x_ = solvers_[group].solveWithGuess(source_.get(), x_);
+    }
 
     // Store the result of the LS solution onto the CoarseData
     for (int i = 0; i < n_cell_; i++) {
@@ -298,6 +502,52 @@ real_t CMFD::solve_1g(int group)
     return resid;
 }
 
+real_t CMFD::solve_within_group(int group, const ArrayB1 &flux_old,
+                                ArrayB1 &flux)
+{
+    assert((int)flux.size() == n_cell_);
+    assert((int)flux_old.size() == n_cell_);
+
+    timer_.tic();
+
+    // D-hats come from the most recent inner iteration
+    coarse_data_.flux(blitz::Range::all(), group) = flux;
+    this->setup_group(group);
+
+    // The correction is driven by the change in the self-scattering source
+    VectorX b(n_cell_);
+    for (const auto &xsr : xsmesh_) {
+        real_t xssc = xsr.xsmacsc().self_scat(group);
+        for (const int i : xsr.reg()) {
+            b[i] = mesh_.coarse_volume(i) * xssc * (flux(i) - flux_old(i));
+        }
+    }
+
+    x_.setZero();
+    if (is_distributed_) {
+        dist_solvers_[group]->setTolerance(resid_reduction_);
+        x_ = dist_solvers_[group]->solveWithGuess(b, x_);
+    } else {
+        solvers_[group].setTolerance(resid_reduction_);
+        x_ = solvers_[group].solveWithGuess(b, x_);
+    }
+
+    // Apply the correction, leaving alone any cells that would go negative
+    real_t norm = 0.0;
+    for (int i = 0; i < n_cell_; i++) {
+        real_t corrected = flux(i) + x_[i];
+        if ((corrected > 0.0) && (flux(i) > 0.0)) {
+            real_t e = x_[i] / flux(i);
+            norm += e * e;
+            flux(i) = corrected;
+        }
+    }
+    coarse_data_.flux(blitz::Range::all(), group) = flux;
+
+    timer_.toc();
+    return std::sqrt(norm);
+}
+
 void CMFD::fission_source(real_t k)
 {
     fs_ = 0.0;
@@ -334,223 +584,587 @@ void CMFD::setup_solve()
 {
     timer_setup_.tic();
 
-    const Mesh::BCArray_t bc = mesh_.boundary_array();
     // Construct the system matrix
+    for (int group = 0; group < n_group_; group++) {
+        this->setup_group(group);
+    }
+
+    timer_setup_.toc();
+    return;
+} // setup_solve
+
+void CMFD::setup_group(int group)
+{
+    const Mesh::BCArray_t bc = mesh_.boundary_array();
 
     int nz        = fine_mesh_->nz();
     int n_mplanes = fine_mesh_->n_macroplanes();
-    int group     = 0;
-    for (auto &m : m_) {
-        // Diffusion coefficients
-        VecF d_coeff(n_cell_);
-        VecF xsrm(n_cell_);
-        for (const auto &xsr : xsmesh_) {
-            real_t d  = 1.0 / (3.0 * xsr.xsmactr(group));
-            real_t rm = xsr.xsmacrm(group);
-            for (const int i : xsr.reg()) {
-                d_coeff[i] = d;
-                xsrm[i]    = rm;
-            }
-        }
-
-        // Surface diffusivity (d_tilde) and non-linear correction coefficient
-        // (d_hat) There are lots of options to optimize this, mostly algebraic
-        // simplifications, but this is very conformal to the canonical
-        // formulations of CMFD found in the literature. If this starts taking
-        // too much time, optimize.
-        ArrayB1 d_tilde = d_tilde_(blitz::Range::all(), group);
-        ArrayB1 d_hat   = d_hat_(blitz::Range::all(), group);
-        ArrayB1 s_tilde = s_tilde_(blitz::Range::all(), group);
-        ArrayB1 s_hat   = s_hat_(blitz::Range::all(), group);
-
-        // Homogenize the currents to a coarser axial mesh
-        if (fine_mesh_->n_macroplanes() != nz) {
-            current_1g_        = 0.0;
-            int current_mplane = 0;
-            for (int iz = 0; iz < nz; iz++) {
-                int mplane     = fine_mesh_->macroplane_index(iz);
-                real_t dz      = fine_mesh_->dz(iz);
-                int stt_fine   = fine_mesh_->plane_surf_xy_begin(iz);
-                int stp_fine   = fine_mesh_->plane_surf_end(iz) - 1;
-                int stt_coarse = mesh_.plane_surf_xy_begin(mplane);
-                int stp_coarse = mesh_.plane_surf_end(mplane) - 1;
-                current_1g_(blitz::Range(stt_coarse, stp_coarse)) +=
-                    dz *
+    auto &m       = m_[group];
+
+    // Diffusion coefficients
+    VecF d_coeff(n_cell_);
+    VecF xsrm(n_cell_);
+    for (const auto &xsr : xsmesh_) {
+        real_t d  = 1.0 / (3.0 * xsr.xsmactr(group));
+        real_t rm = xsr.xsmacrm(group);
+        for (const int i : xsr.reg()) {
+            d_coeff[i] = d;
+            xsrm[i]    = rm;
+        }
+    }
+
+    // Surface diffusivity (d_tilde) and non-linear correction coefficient
+    // (d_hat) There are lots of options to optimize this, mostly algebraic
+    // simplifications, but this is very conformal to the canonical
+    // formulations of CMFD found in the literature. If this starts taking
+    // too much time, optimize.
+    ArrayB1 d_tilde = d_tilde_(blitz::Range::all(), group);
+    ArrayB1 d_hat   = d_hat_(blitz::Range::all(), group);
+    ArrayB1 d_hat_m = d_hat_m_(blitz::Range::all(), group);
+    ArrayB1 s_tilde = s_tilde_(blitz::Range::all(), group);
+    ArrayB1 s_hat   = s_hat_(blitz::Range::all(), group);
+
+    // Homogenize the currents to a coarser axial mesh
+    if (fine_mesh_->n_macroplanes() != nz) {
+        current_1g_        = 0.0;
+        int current_mplane = 0;
+        for (int iz = 0; iz < nz; iz++) {
+            int mplane     = fine_mesh_->macroplane_index(iz);
+            real_t dz      = fine_mesh_->dz(iz);
+            int stt_fine   = fine_mesh_->plane_surf_xy_begin(iz);
+            int stp_fine   = fine_mesh_->plane_surf_end(iz) - 1;
+            int stt_coarse = mesh_.plane_surf_xy_begin(mplane);
+            int stp_coarse = mesh_.plane_surf_end(mplane) - 1;
+            current_1g_(blitz::Range(stt_coarse, stp_coarse)) +=
+                dz *
+                coarse_data_.current(blitz::Range(stt_fine, stp_fine),
+                                     group);
+        }
+        // Normalize the radial currents
+        for (int iz = 0; iz < (int)mesh_.nz(); iz++) {
+            int stt = mesh_.plane_surf_xy_begin(iz);
+            int stp = mesh_.plane_surf_end(iz) - 1;
+            // since we are using the separate CMFD mesh, the dz here is the
+            // macroplane height, which we want
+            current_1g_(blitz::Range(stt, stp)) /= mesh_.dz(iz);
+        }
+
+        // Now apply the z-normal currents
+        current_mplane = -1;
+        for (int iz = 0; iz < nz; iz++) {
+            int mplane = fine_mesh_->macroplane_index(iz);
+            if (current_mplane != mplane) {
+                int stt_fine   = fine_mesh_->plane_surf_begin(iz);
+                int stp_fine   = fine_mesh_->plane_surf_xy_begin(iz) - 1;
+                int stt_coarse = mesh_.plane_surf_begin(mplane);
+                int stp_coarse = mesh_.plane_surf_xy_begin(mplane) - 1;
+                current_1g_(blitz::Range(stt_coarse, stp_coarse)) =
                     coarse_data_.current(blitz::Range(stt_fine, stp_fine),
                                          group);
+                current_mplane = mplane;
             }
-            // Normalize the radial currents
-            for (int iz = 0; iz < (int)mesh_.nz(); iz++) {
-                int stt = mesh_.plane_surf_xy_begin(iz);
-                int stp = mesh_.plane_surf_end(iz) - 1;
-                // since we are using the separate CMFD mesh, the dz here is the
-                // macroplane height, which we want
-                current_1g_(blitz::Range(stt, stp)) /= mesh_.dz(iz);
-            }
+        }
+        // Lastly, grab the top surface currents
+        int stt_fine   = fine_mesh_->plane_surf_begin(nz);
+        int stp_fine   = fine_mesh_->plane_surf_xy_begin(nz) - 1;
+        int stt_coarse = mesh_.plane_surf_begin(n_mplanes);
+        int stp_coarse = mesh_.plane_surf_xy_begin(n_mplanes) - 1;
+        current_1g_(blitz::Range(stt_coarse, stp_coarse)) =
+            coarse_data_.current(blitz::Range(stt_fine, stp_fine), group);
+    } else {
+        current_1g_ = coarse_data_.current(blitz::Range::all(), group);
+    }
 
-            // Now apply the z-normal currents
-            current_mplane = -1;
-            for (int iz = 0; iz < nz; iz++) {
-                int mplane = fine_mesh_->macroplane_index(iz);
-                if (current_mplane != mplane) {
-                    int stt_fine   = fine_mesh_->plane_surf_begin(iz);
-                    int stp_fine   = fine_mesh_->plane_surf_xy_begin(iz) - 1;
-                    int stt_coarse = mesh_.plane_surf_begin(mplane);
-                    int stp_coarse = mesh_.plane_surf_xy_begin(mplane) - 1;
-                    current_1g_(blitz::Range(stt_coarse, stp_coarse)) =
-                        coarse_data_.current(blitz::Range(stt_fine, stp_fine),
-                                             group);
-                    current_mplane = mplane;
-                }
+    // Loop over the surfaces in the mesh, and calculate the inter-cell
+    // coupling coefficients
+    for (int is = 0; is < n_surf_; is++) {
+        auto cells  = mesh_.coarse_neigh_cells(is);
+        Normal norm = mesh_.surface_normal(is);
+
+        auto coeffs = this->surface_diffusivity(is, d_coeff, bc);
+        d_tilde(is) = coeffs.first;
+        s_tilde(is) = coeffs.second;
+
+        // If we have currents defined from a transport sweeper or the
+        // like, calculate D-hat coefficients
+        bool have_data = norm == Normal::Z_NORM
+                             ? coarse_data_.has_axial_data()
+                             : coarse_data_.has_radial_data();
+        if (have_data) {
+            real_t j        = current_1g_(is);
+            real_t sfc_flux = coarse_data_.surface_flux(is, group);
+            real_t flux_l   = cells.first >= 0
+                                ? coarse_data_.flux(cells.first, group)
+                                : 0.0;
+            real_t flux_r = cells.second >= 0
+                                ? coarse_data_.flux(cells.second, group)
+                                : 0.0;
+            d_hat(is) =
+                (j + d_tilde(is) * (flux_r - flux_l)) / (flux_l + flux_r);
+            if (!std::isfinite(d_hat(is))) {
+                d_hat(is) = 0.0;
+            }
+            s_hat(is) = (cells.first >= 0)
+                            ? (sfc_flux - s_tilde(is) * flux_l -
+                               (1.0 - s_tilde(is)) * flux_r) /
+                                  (flux_l + flux_r)
+                            : (sfc_flux - s_tilde(is) * flux_r) / (flux_r);
+
+            d_hat_m(is) = -d_hat(is);
+            if (pcmfd_ && (cells.first >= 0) && (cells.second >= 0)) {
+                // Partial currents, reconstructed from the net current
+                // and surface flux
+                real_t j_p = 0.25 * sfc_flux + 0.5 * j;
+                real_t j_m = 0.25 * sfc_flux - 0.5 * j;
+                this->partial_d_hat(j_p, j_m, d_tilde(is), flux_l, flux_r,
+                                    d_hat(is), d_hat_m(is));
             }
-            // Lastly, grab the top surface currents
-            int stt_fine   = fine_mesh_->plane_surf_begin(nz);
-            int stp_fine   = fine_mesh_->plane_surf_xy_begin(nz) - 1;
-            int stt_coarse = mesh_.plane_surf_begin(n_mplanes);
-            int stp_coarse = mesh_.plane_surf_xy_begin(n_mplanes) - 1;
-            current_1g_(blitz::Range(stt_coarse, stp_coarse)) =
-                coarse_data_.current(blitz::Range(stt_fine, stp_fine), group);
         } else {
-            current_1g_ = coarse_data_.current(blitz::Range::all(), group);
+            d_hat(is)   = 0.0;
+            d_hat_m(is) = 0.0;
+            s_hat(is)   = 0.0;
         }
+    } // surfaces
 
-        // Loop over the surfaces in the mesh, and calculate the inter-cell
-        // coupling coefficients
-        for (int is = 0; is < n_surf_; is++) {
-            auto cells  = mesh_.coarse_neigh_cells(is);
-            Normal norm = mesh_.surface_normal(is);
-
-            real_t diffusivity_1 = 0.0;
-            real_t diffusivity_2 = 0.0;
-            if (cells.first > -1) {
-                diffusivity_1 = d_coeff[cells.first] /
-                                mesh_.cell_thickness(cells.first, norm);
+    this->fill_matrix(m, xsrm, d_tilde, d_hat, d_hat_m);
+
+    if (is_distributed_) {
+        dist_solvers_[group]->compute(m);
+    } else {
+        solvers_[group].compute(m);
+        solvers_[group].setMaxIterations(150);
+    }
+    return;
+} // setup_group
+
+std::pair<real_t, real_t> CMFD::surface_diffusivity(
+    int is, const VecF &d_coeff, const Mesh::BCArray_t &bc) const
+{
+    auto cells  = mesh_.coarse_neigh_cells(is);
+    Normal norm = mesh_.surface_normal(is);
+
+    real_t diffusivity_1 = 0.0;
+    real_t diffusivity_2 = 0.0;
+    if (cells.first > -1) {
+        diffusivity_1 =
+            d_coeff[cells.first] / mesh_.cell_thickness(cells.first, norm);
+    } else {
+        switch (bc[(int)(norm)][0]) {
+        case Boundary::REFLECT:
+            diffusivity_1 = 0.0 / 2.0;
+            break;
+        case Boundary::VACUUM:
+            diffusivity_1 = 0.5 / 2.0;
+            break;
+        default:
+            throw EXCEPT("Unsupported boundary type");
+        }
+    }
+
+    if (cells.second > -1) {
+        diffusivity_2 =
+            d_coeff[cells.second] / mesh_.cell_thickness(cells.second, norm);
+    } else {
+        switch (bc[(int)(norm)][1]) {
+        case Boundary::REFLECT:
+            diffusivity_2 = 0.0 / 2.0;
+            break;
+        case Boundary::VACUUM:
+            diffusivity_2 = 0.5 / 2.0;
+            break;
+        default:
+            throw EXCEPT("Unsupported boundary type");
+        }
+    }
+
+    real_t d_tilde =
+        2.0 * diffusivity_1 * diffusivity_2 / (diffusivity_1 + diffusivity_2);
+
+    // S-tilde is a mess. Since surface flux is calculated as
+    // phi = s_tilde*flux_left + (1-s_tilde)*flux_right, there is an
+    // inherent binding to a cell, as well as a surface. We assume
+    // the convention that if possible the bound cell is the one to
+    // the "left" of the surface. When such a cell is not present
+    // (domain boundary), the cell is to the "right"
+    real_t s_tilde = (diffusivity_1 > 0.0)
+                         ? diffusivity_1 / (diffusivity_1 + diffusivity_2)
+                         : diffusivity_2 / (diffusivity_1 + diffusivity_2);
+
+    return std::pair<real_t, real_t>(d_tilde, s_tilde);
+}
+
+void CMFD::partial_d_hat(real_t j_p, real_t j_m, real_t d_tilde,
+                         real_t flux_l, real_t flux_r, real_t &d_hat_p,
+                         real_t &d_hat_m) const
+{
+    real_t d_diff = 0.5 * d_tilde * (flux_r - flux_l);
+    real_t p      = (j_p + d_diff) / flux_l;
+    real_t m      = (j_m - d_diff) / flux_r;
+
+    // Only accept the partial-current coefficients if they are both
+    // well-defined, otherwise leave the net-current coefficients in place
+    if (std::isfinite(p) && std::isfinite(m)) {
+        d_hat_p = p;
+        d_hat_m = m;
+    }
+    return;
+}
+
+void CMFD::fill_matrix(Eigen::SparseMatrix<real_t> &m, const VecF &xsrm,
+                       const ArrayB1 &d_tilde, const ArrayB1 &d_hat,
+                       const ArrayB1 &d_hat_m) const
+{
+    // put values into the matrix. Optimal access patterns in sparse
+    // matrix representations are not obvious, so the best way is to
+    // iterate through the matrix linearly and act according to the
+    // indices (i.e.  row/col) that we get for each coefficient.
+    for (int k = 0; k < m.outerSize(); k++) {
+        for (M::InnerIterator it(m, k); it; ++it) {
+            auto i = it.row();
+            auto j = it.col();
+            if (i == j) {
+                // Diagonal element
+                real_t v = mesh_.coarse_volume(i) * xsrm[i];
+                for (auto is : AllSurfaces) {
+                    int surf = mesh_.coarse_surf(i, is);
+                    real_t a = mesh_.coarse_area(i, is);
+
+                    // Use the D-hat associated with this cell. For the
+                    // net-current formulation, d_hat_m = -d_hat
+                    real_t d_hat_ij = d_hat(surf);
+                    if ((is == Surface::WEST) || (is == Surface::SOUTH) ||
+                        (is == Surface::BOTTOM)) {
+                        d_hat_ij = d_hat_m(surf);
+                    }
+
+                    v += a * (d_tilde(surf) + d_hat_ij);
+                }
+                it.valueRef() = v;
             } else {
-                switch (bc[(int)(norm)][0]) {
-                case Boundary::REFLECT:
-                    diffusivity_1 = 0.0 / 2.0;
-                    break;
-                case Boundary::VACUUM:
-                    diffusivity_1 = 0.5 / 2.0;
-                    break;
-                default:
-                    throw EXCEPT("Unsupported boundary type");
+                // off-diagonal element
+                auto pair       = mesh_.coarse_interface(i, j);
+                real_t a        = mesh_.coarse_area(i, pair.second);
+                int surf        = pair.first;
+                // Use the D-hat associated with the neighbor cell
+                real_t d_hat_ij = -d_hat_m(surf);
+                if ((pair.second == Surface::WEST) ||
+                    (pair.second == Surface::SOUTH) ||
+                    (pair.second == Surface::BOTTOM)) {
+                    d_hat_ij = -d_hat(surf);
+                }
+
+                real_t v      = a * (d_hat_ij - d_tilde(surf));
+                it.valueRef() = v;
+            }
+        }
+    } // matrix element loop
+
+    return;
+}
+
+void CMFD::condense()
+{
+    auto all = blitz::Range::all();
+
+    // Few-group flux and cross sections for each cell
+    for (const auto &xsr : xsmesh_) {
+        const ScatteringMatrix &scat = xsr.xsmacsc();
+        for (const int i : xsr.reg()) {
+            ArrayB1 flux_1c = coarse_data_.flux(i, all);
+
+            // Fall back to a flat spectrum within any few group that
+            // doesn't have a positive flux to weight with
+            VecF weight(n_group_);
+            for (int ifg = 0; ifg < n_few_group_; ifg++) {
+                real_t phi = 0.0;
+                for (int ig = fg_bounds_[ifg]; ig < fg_bounds_[ifg + 1];
+                     ig++) {
+                    phi += flux_1c(ig);
                 }
+                bool flat = !(phi > 0.0);
+                for (int ig = fg_bounds_[ifg]; ig < fg_bounds_[ifg + 1];
+                     ig++) {
+                    weight[ig] = flat ? 1.0 : flux_1c(ig);
+                }
+                fg_flux_(i, ifg) = phi;
             }
 
-            if (cells.second > -1) {
-                diffusivity_2 = d_coeff[cells.second] /
-                                mesh_.cell_thickness(cells.second, norm);
-            } else {
-                switch (bc[(int)(norm)][1]) {
-                case Boundary::REFLECT:
-                    diffusivity_2 = 0.0 / 2.0;
-                    break;
-                case Boundary::VACUUM:
-                    diffusivity_2 = 0.5 / 2.0;
-                    break;
-                default:
-                    throw EXCEPT("Unsupported boundary type");
+            for (int ifg = 0; ifg < n_few_group_; ifg++) {
+                real_t w_sum = 0.0;
+                real_t rm    = 0.0;
+                real_t nf    = 0.0;
+                real_t ch    = 0.0;
+                real_t d     = 0.0;
+                for (int ig = fg_bounds_[ifg]; ig < fg_bounds_[ifg + 1];
+                     ig++) {
+                    real_t w = weight[ig];
+                    w_sum += w;
+                    rm += w * xsr.xsmacrm(ig);
+                    nf += w * xsr.xsmacnf(ig);
+                    ch += xsr.xsmacch(ig);
+                    d += w / (3.0 * xsr.xsmactr(ig));
                 }
+                fg_xsrm_[ifg][i] = rm;
+                fg_xsnf_[ifg][i] = nf / w_sum;
+                fg_xsch_[ifg][i] = ch;
+                fg_d_[ifg][i]    = d / w_sum;
             }
 
-            d_tilde(is) = 2.0 * diffusivity_1 * diffusivity_2 /
-                          (diffusivity_1 + diffusivity_2);
-
-            // S-tilde is a mess. Since surface flux is calculated as
-            // phi = s_tilde*flux_left + (1-s_tilde)*flux_right, there is an
-            // inherent binding to a cell, as well as a surface. We assume
-            // the convention that if possible the bound cell is the one to
-            // the "left" of the surface. When such a cell is not present
-            // (domain boundary), the cell is to the "right"
-            real_t stil = (diffusivity_1 > 0.0)
-                              ? diffusivity_1 / (diffusivity_1 + diffusivity_2)
-                              : diffusivity_2 / (diffusivity_1 + diffusivity_2);
-
-            s_tilde(is) = stil;
-
-            // If we have currents defined from a transport sweeper or the
-            // like, calculate D-hat coefficients
-            bool have_data = norm == Normal::Z_NORM
-                                 ? coarse_data_.has_axial_data()
-                                 : coarse_data_.has_radial_data();
-            if (have_data) {
-                real_t j        = current_1g_(is);
-                real_t sfc_flux = coarse_data_.surface_flux(is, group);
-                real_t flux_l   = cells.first >= 0
-                                    ? coarse_data_.flux(cells.first, group)
+            // Scattering. Transfers between fine groups in the same few group
+            // are removed from the few-group removal cross section, the rest
+            // go to the few-group scattering matrix
+            fg_scat_(i, all, all) = 0.0;
+            for (int ig = 0; ig < n_group_; ig++) {
+                int ifg        = fg_map_[ig];
+                const auto &row = scat.to(ig);
+                for (int igg = row.min_g; igg <= row.max_g; igg++) {
+                    if (igg == ig) {
+                        continue;
+                    }
+                    int iffg = fg_map_[igg];
+                    real_t s = row[igg] * weight[igg];
+                    if (iffg == ifg) {
+                        fg_xsrm_[ifg][i] -= s;
+                    } else {
+                        fg_scat_(i, ifg, iffg) += s;
+                    }
+                }
+            }
+
+            // Normalize the weighted quantities
+            for (int ifg = 0; ifg < n_few_group_; ifg++) {
+                real_t w_sum = 0.0;
+                for (int ig = fg_bounds_[ifg]; ig < fg_bounds_[ifg + 1];
+                     ig++) {
+                    w_sum += weight[ig];
+                }
+                fg_xsrm_[ifg][i] /= w_sum;
+                for (int ifg_to = 0; ifg_to < n_few_group_; ifg_to++) {
+                    fg_scat_(i, ifg_to, ifg) /= w_sum;
+                }
+            }
+        }
+    }
+
+    // Few-group coupling coefficients. The few-group currents are the sum of
+    // the multigroup currents implied by the multigroup coefficients
+    const Mesh::BCArray_t bc = mesh_.boundary_array();
+    for (int ifg = 0; ifg < n_few_group_; ifg++) {
+        ArrayB1 d_tilde = fg_d_tilde_(all, ifg);
+        ArrayB1 d_hat   = fg_d_hat_(all, ifg);
+        ArrayB1 d_hat_m = fg_d_hat_m_(all, ifg);
+        for (int is = 0; is < n_surf_; is++) {
+            auto cells = mesh_.coarse_neigh_cells(is);
+
+            real_t j_p = 0.0;
+            real_t j_m = 0.0;
+            for (int ig = fg_bounds_[ifg]; ig < fg_bounds_[ifg + 1]; ig++) {
+                real_t flux_l = cells.first >= 0
+                                    ? coarse_data_.flux(cells.first, ig)
                                     : 0.0;
                 real_t flux_r = cells.second >= 0
-                                    ? coarse_data_.flux(cells.second, group)
+                                    ? coarse_data_.flux(cells.second, ig)
                                     : 0.0;
-                d_hat(is) =
-                    (j + d_tilde(is) * (flux_r - flux_l)) / (flux_l + flux_r);
-                if (!std::isfinite(d_hat(is))) {
-                    d_hat(is) = 0.0;
+                real_t d_diff = 0.5 * d_tilde_(is, ig) * (flux_r - flux_l);
+                j_p += -d_diff + d_hat_(is, ig) * flux_l;
+                j_m += d_diff + d_hat_m_(is, ig) * flux_r;
+            }
+            real_t j = j_p - j_m;
+
+            d_tilde(is) = this->surface_diffusivity(is, fg_d_[ifg], bc).first;
+
+            real_t flux_l =
+                cells.first >= 0 ? fg_flux_(cells.first, ifg) : 0.0;
+            real_t flux_r =
+                cells.second >= 0 ? fg_flux_(cells.second, ifg) : 0.0;
+            d_hat(is) =
+                (j + d_tilde(is) * (flux_r - flux_l)) / (flux_l + flux_r);
+            if (!std::isfinite(d_hat(is))) {
+                d_hat(is) = 0.0;
+            }
+            d_hat_m(is) = -d_hat(is);
+            if (pcmfd_ && (cells.first >= 0) && (cells.second >= 0)) {
+                this->partial_d_hat(j_p, j_m, d_tilde(is), flux_l, flux_r,
+                                    d_hat(is), d_hat_m(is));
+            }
+        }
+
+        this->fill_matrix(fg_m_[ifg], fg_xsrm_[ifg], d_tilde, d_hat,
+                          d_hat_m);
+        if (is_distributed_) {
+            fg_dist_solvers_[ifg]->compute(fg_m_[ifg]);
+        } else {
+            fg_solvers_[ifg].compute(fg_m_[ifg]);
+            fg_solvers_[ifg].setMaxIterations(150);
+        }
+    }
+
+    fg_flux_old_ = fg_flux_;
+
+    return;
+}
+
+void CMFD::solve_few_group(real_t &k)
+{
+    this->condense();
+
+    const VecF &vol = mesh_.coarse_volume();
+
+    // Few-group fission source and total fission. The group-independent
+    // fission source is stored in fs_, just like for the multigroup system.
+    auto fg_fission_source = [&](real_t k_fs) {
+        fs_ = 0.0;
+        for (int ifg = 0; ifg < n_few_group_; ifg++) {
+            for (int i = 0; i < n_cell_; i++) {
+                fs_(i) += fg_xsnf_[ifg][i] * fg_flux_(i, ifg);
+            }
+        }
+        fs_ /= k_fs;
+        return;
+    };
+    auto fg_total_fission = [&]() {
+        real_t f = 0.0;
+        for (int ifg = 0; ifg < n_few_group_; ifg++) {
+            for (int i = 0; i < n_cell_; i++) {
+                f += fg_xsnf_[ifg][i] * fg_flux_(i, ifg);
+            }
+        }
+        return f;
+    };
+
+    // Form the right-hand side for a few group and store the current
+    // few-group flux in x_. Return the squared residual norm.
+    auto setup_1g = [&](int ifg) {
+        for (int i = 0; i < n_cell_; i++) {
+            real_t q = fg_xsch_[ifg][i] * fs_(i);
+            for (int iffg = 0; iffg < n_few_group_; iffg++) {
+                if (iffg != ifg) {
+                    q += fg_scat_(i, ifg, iffg) * fg_flux_(i, iffg);
                 }
-                s_hat(is) = (cells.first >= 0)
-                                ? (sfc_flux - s_tilde(is) * flux_l -
-                                   (1.0 - s_tilde(is)) * flux_r) /
-                                      (flux_l + flux_r)
-                                : (sfc_flux - s_tilde(is) * flux_r) / (flux_r);
+            }
+            fg_b_[i] = q * vol[i];
+            x_[i]    = fg_flux_(i, ifg);
+        }
+        VectorX resid = fg_m_[ifg] * x_ - fg_b_;
+        return resid.squaredNorm();
+    };
+
+    real_t k_old = k;
+    fg_fission_source(k);
+    real_t tfis = fg_total_fission();
+
+    real_t r0 = 0.0;
+    for (int ifg = 0; ifg < n_few_group_; ifg++) {
+        r0 += setup_1g(ifg);
+    }
+    r0 = std::sqrt(r0) / (n_cell_ * n_few_group_);
+
+    for (auto &solver : fg_solvers_) {
+        solver.setTolerance(resid_reduction_ * r0);
+    }
+    for (auto &solver : fg_dist_solvers_) {
+        solver->setTolerance(resid_reduction_ * r0);
+    }
+
+    auto flags = LogScreen.flags();
+    LogScreen << "CMFD (" << n_few_group_ << " groups) Converging to "
+              << std::scientific << k_tol_ << " " << std::scientific
+              << psi_tol_ << " " << std::scientific << r0 << std::endl;
+    LogScreen.flags(flags);
+
+    int iter       = 0;
+    real_t psi_err = 1.0;
+    real_t ri      = 0.0;
+    while (true) {
+        iter++;
+        fs_old_ = fs_;
+        fg_fission_source(k);
+        real_t tfis_old = tfis;
+
+        ri = 0.0;
+        for (int ifg = 0; ifg < n_few_group_; ifg++) {
+            ri += setup_1g(ifg);
+            if (is_distributed_) {
+                x_ = fg_dist_solvers_[ifg]->solveWithGuess(fg_b_, x_);
             } else {
-                d_hat(is) = 0.0;
-                s_hat(is) = 0.0;
+                x_ = fg_solvers_[ifg].solveWithGuess(fg_b_, x_);
             }
-        } // surfaces
+            for (int i = 0; i < n_cell_; i++) {
+                fg_flux_(i, ifg) = x_[i];
+            }
+        }
+        ri = std::sqrt(ri) / (n_cell_ * n_few_group_);
 
-        // put values into the matrix. Optimal access patterns in sparse
-        // matrix representations are not obvious, so the best way is to
-        // iterate through the matrix linearly and act according to the
-        // indices (i.e.  row/col) that we get for each coefficient.
-        for (int k = 0; k < m.outerSize(); k++) {
-            for (M::InnerIterator it(m, k); it; ++it) {
-                auto i = it.row();
-                auto j = it.col();
-                if (i == j) {
-                    // Diagonal element
-                    real_t v = mesh_.coarse_volume(i) * xsrm[i];
-                    for (auto is : AllSurfaces) {
-                        int surf = mesh_.coarse_surf(i, is);
-                        real_t a = mesh_.coarse_area(i, is);
-
-                        // Switch sign of D-hat if necessary
-                        real_t d_hat_ij = d_hat(surf);
-                        if ((is == Surface::WEST) || (is == Surface::SOUTH) ||
-                            (is == Surface::BOTTOM)) {
-                            d_hat_ij = -d_hat_ij;
-                        }
-
-                        v += a * (d_tilde(surf) + d_hat_ij);
-                    }
-                    it.valueRef() = v;
-                } else {
-                    // off-diagonal element
-                    auto pair       = mesh_.coarse_interface(i, j);
-                    real_t a        = mesh_.coarse_area(i, pair.second);
-                    int surf        = pair.first;
-                    real_t d_hat_ij = d_hat(surf);
-                    // Switch sign of D-hat if necessary
-                    if ((pair.second == Surface::WEST) ||
-                        (pair.second == Surface::SOUTH) ||
-                        (pair.second == Surface::BOTTOM)) {
-                        d_hat_ij = -d_hat_ij;
-                    }
+        tfis  = fg_total_fission();
+        k_old = k;
+        k     = k * tfis / tfis_old;
 
-                    real_t v      = a * (d_hat_ij - d_tilde(surf));
-                    it.valueRef() = v;
+        psi_err = 0.0;
+        for (int i = 0; i < n_cell_; i++) {
+            real_t e = fs_(i) - fs_old_(i);
+            psi_err += e * e;
+        }
+        psi_err = std::sqrt(psi_err);
+
+        last_converged_ = (std::abs(k - k_old) < k_tol_) &&
+                          (psi_err < psi_tol_) && (ri / r0 < resid_reduction_);
+        if (last_converged_ || (iter > max_iter_)) {
+            break;
+        }
+
+        if ((iter % 10) == 0) {
+            this->print(iter, k, std::abs(k - k_old), psi_err, ri / r0);
+        }
+    }
+    this->print(iter, k, std::abs(k - k_old), psi_err, ri / r0);
+    last_iter_ = iter;
+
+    // Prolong back to the multigroup flux, preserving the spectrum within
+    // each few group
+    for (int i = 0; i < n_cell_; i++) {
+        for (int ifg = 0; ifg < n_few_group_; ifg++) {
+            real_t phi_old = fg_flux_old_(i, ifg);
+            real_t phi_new = fg_flux_(i, ifg);
+            int stt        = fg_bounds_[ifg];
+            int stp        = fg_bounds_[ifg + 1];
+            if (phi_old > 0.0) {
+                real_t f = phi_new / phi_old;
+                for (int ig = stt; ig < stp; ig++) {
+                    coarse_data_.flux(i, ig) *= f;
+                }
+            } else {
+                for (int ig = stt; ig < stp; ig++) {
+                    coarse_data_.flux(i, ig) = phi_new / (stp - stt);
                 }
             }
-        } // matrix element loop
+        }
+    }
 
-        solvers_[group].compute(m);
-        solvers_[group].setMaxIterations(150);
+    // Optionally smooth with a single multigroup iteration
+    if (fg_smooth_) {
+        this->fission_source(k);
+        real_t tfis_mg = this->total_fission();
+
+        real_t r0_mg = this->residual();
+        for (auto &solver : solvers_) {
+            solver.setTolerance(resid_reduction_ * r0_mg);
+        }
+        for (auto &solver : dist_solvers_) {
+            solver->setTolerance(resid_reduction_ * r0_mg);
+        }
+
+        for (int group = 0; group < n_group_; group++) {
+            source_.group_source(group, &fs_);
+            source_.scale(vol);
+
+            this->solve_1g(group);
+        }
+
+        k = k * this->total_fission() / tfis_mg;
+    }
 
-        group++;
-    } // group loop
-    timer_setup_.toc();
     return;
-} // setup_solve
+}
 
 void CMFD::store_currents()
 {
@@ -579,9 +1193,10 @@ void CMFD::store_currents()
                 cells.first >= 0 ? coarse_data_.flux(cells.first, ig) : 0.0;
 
             real_t d_hat   = d_hat_(is, ig);
+            real_t d_hat_m = d_hat_m_(is, ig);
             real_t d_tilde = d_tilde_(is, ig);
-            real_t current =
-                -d_tilde * (flux_r - flux_l) + d_hat * (flux_r + flux_l);
+            real_t current = -d_tilde * (flux_r - flux_l) + d_hat * flux_l -
+                             d_hat_m * flux_r;
 
             current_1g_(is) = current;
 
@@ -643,9 +1258,7 @@ real_t CMFD::residual()
 
     for (int group = 0; group < n_group_; group++) {
         ArrayB1 flux_1g = coarse_data_.flux(blitz::Range::all(), group);
-        source_.initialize_group(group);
-        source_.fission(fs_, group);
-        source_.in_scatter(group);
+        source_.group_source(group, &fs_);
         source_.scale(mesh_.coarse_volume());
 
         for (int icell = 0; icell < n_cell_; ++icell) {
@@ -697,6 +1310,39 @@ void CMFD::output(H5Node &node) const
     return;
 }
 
+void CMFD::checkpoint(H5Node &node) const
+{
+    auto g = node.create_group("coarse_data");
+    coarse_data_.checkpoint(g);
+
+    node.write("n_solve", n_solve_);
+    node.write("k_tol", VecF(1, k_tol_));
+    node.write("psi_tol", VecF(1, psi_tol_));
+    node.write("max_iter", max_iter_);
+    node.write("last_iter", last_iter_);
+    node.write("last_converged", (int)last_converged_);
+    return;
+}
+
+void CMFD::restart(H5Node &node)
+{
+    auto g = node["coarse_data"];
+    coarse_data_.restart(g);
+
+    std::vector<double> v;
+    node.read("n_solve", n_solve_);
+    node.read("k_tol", v);
+    k_tol_ = v[0];
+    node.read("psi_tol", v);
+    psi_tol_ = v[0];
+    node.read("max_iter", max_iter_);
+    node.read("last_iter", last_iter_);
+    int converged = 0;
+    node.read("last_converged", converged);
+    last_converged_ = converged;
+    return;
+}
+
 void CMFD::print(int iter, real_t k, real_t k_err, real_t psi_err,
                  real_t resid_ratio)
 {
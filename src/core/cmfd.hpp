@@ -17,12 +17,15 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <Eigen/Sparse>
 
 #include "util/global_config.hpp"
 #include "util/timers.hpp"
 #include "coarse_data.hpp"
+#include "distributed_bicgstab.hpp"
 #include "eigen_interface.hpp"
 #include "mesh.hpp"
 #include "source_isotropic.hpp"
@@ -42,6 +45,20 @@ public:
      */
     void solve(real_t &k);
 
+    /**
+     * \brief Solve the CMFD system for a fixed external source
+     *
+     * \param q the external source on the CMFD mesh, indexed by cell and
+     * group, per unit volume
+     *
+     * The multigroup system, without fission, is solved with Gauss-Seidel
+     * iteration in energy until the L-2 norm of the relative change in the
+     * flux between iterations is below the fission source tolerance and the
+     * residual has been reduced by the requested factor. The few-group
+     * structure, if any, is not used.
+     */
+    void solve_fixed_source(const ArrayB2 &q);
+
     /**
      * \brief Return a pointer to the coarse data.
      *
@@ -104,8 +121,97 @@ public:
         return;
     }
 
+    /**
+     * \brief Set the maximum number of iterations to perform in a solve
+     */
+    void set_max_iter(int max_iter)
+    {
+        assert(max_iter > 0);
+
+        max_iter_ = max_iter;
+        return;
+    }
+
+    /**
+     * \brief Return the eigenvalue convergence tolerance
+     */
+    real_t k_tolerance() const
+    {
+        return k_tol_;
+    }
+
+    /**
+     * \brief Return the fission source convergence tolerance
+     */
+    real_t psi_tolerance() const
+    {
+        return psi_tol_;
+    }
+
+    /**
+     * \brief Return the maximum number of iterations to perform in a solve
+     */
+    int max_iter() const
+    {
+        return max_iter_;
+    }
+
+    /**
+     * \brief Return the number of iterations performed by the last call to
+     * \ref solve()
+     */
+    int n_iterations() const
+    {
+        return last_iter_;
+    }
+
+    /**
+     * \brief Return whether the last call to \ref solve() satisfied the
+     * convergence criteria before reaching the maximum number of iterations
+     */
+    bool converged() const
+    {
+        return last_converged_;
+    }
+
+    /**
+     * \brief Apply a one-group CMFD correction to the flux of a single group
+     * between the inner iterations of a transport sweeper.
+     *
+     * \param group the energy group
+     * \param flux_old the coarse-mesh flux from which the self-scattering
+     * source of the last inner iteration was computed
+     * \param [in,out] flux the coarse-mesh flux resulting from the last
+     * inner iteration. On output, the corrected flux.
+     *
+     * \returns the L-2 norm of the relative flux correction
+     *
+     * \pre The currents for \p group in the \ref CoarseData are those that
+     * were tallied during the last inner iteration.
+     *
+     * Using the D-hat coefficients from the tallied currents, the coarse
+     * balance of the transport solution is reproduced exactly by the CMFD
+     * operator, A, so that the within-group CMFD problem reduces to an
+     * additive correction, A dphi = V sigma_s (phi - phi_old), driven only by
+     * the change in the self-scattering source. The fine-mesh flux should be
+     * rescaled to the corrected coarse flux by the caller.
+     */
+    real_t solve_within_group(int group, const ArrayB1 &flux_old,
+                              ArrayB1 &flux);
+
     void output(H5Node &node) const;
 
+    /**
+     * \brief Write the \ref CoarseData and the solver state that carries over
+     * between calls to \ref solve() to a checkpoint
+     */
+    void checkpoint(H5Node &node) const;
+
+    /**
+     * \brief Restore the state written by \ref checkpoint()
+     */
+    void restart(H5Node &node);
+
 private:
     // Private methods
     /**
@@ -163,6 +269,97 @@ norm = std::sqrt(norm)/(n_cell_*n_group_);
     real_t residual(int group) const;
     real_t solve_1g(int group);
     void fission_source(real_t k);
+
+    /**
+     * \brief Perform the power iteration on the full multigroup CMFD system
+     *
+     * \param [in,out] k the eigenvalue guess, updated by the solve
+     *
+     * \pre The linear systems have been set up with \ref setup_solve()
+     */
+    void solve_multigroup(real_t &k);
+
+    /**
+     * \brief Perform the power iteration on the energy-condensed, few-group
+     * CMFD system, then prolong the result back to the multigroup flux
+     *
+     * \param [in,out] k the eigenvalue guess, updated by the solve
+     *
+     * The few-group system is formed by \ref condense(). Following
+     * convergence, the multigroup flux is scaled group-wise by the ratio of
+     * new to old few-group flux, preserving the intra-group spectral shape in
+     * each cell. If requested, a single multigroup smoothing pass is then
+     * applied, using the multigroup operators and the prolonged fission
+     * source.
+     *
+     * \pre The multigroup coupling coefficients have been calculated by \ref
+     * setup_solve()
+     */
+    void solve_few_group(real_t &k);
+
+    /**
+     * \brief Condense the multigroup CMFD system to the few-group structure
+     *
+     * Cross sections are flux-weighted over the fine groups in each few
+     * group, with within-few-group scattering folded into the removal cross
+     * section. The few-group currents are the sum of the fine-group currents,
+     * as implied by the multigroup D-tilde and D-hat terms, so that the
+     * few-group system preserves the multigroup solution at convergence.
+     */
+    void condense();
+
+    /**
+     * \brief Compute the D-tilde and S-tilde coupling coefficients for a
+     * single surface, returned as a pair, in that order.
+     *
+     * \param is the index of the surface
+     * \param d_coeff the diffusion coefficients for all cells
+     * \param bc the boundary conditions of the CMFD mesh
+     */
+    std::pair<real_t, real_t> surface_diffusivity(
+        int is, const VecF &d_coeff, const Mesh::BCArray_t &bc) const;
+
+    /**
+     * \brief Compute the partial-current D-hat coefficients for an interior
+     * surface
+     *
+     * \param j_p the partial current in the positive direction
+     * \param j_m the partial current in the negative direction
+     * \param d_tilde the D-tilde coefficient for the surface
+     * \param flux_l the flux in the cell on the negative side of the surface
+     * \param flux_r the flux in the cell on the positive side of the surface
+     * \param [out] d_hat_p the D-hat for the positive partial current
+     * \param [out] d_hat_m the D-hat for the negative partial current
+     *
+     * In the pCMFD formulation, each partial current is corrected using only
+     * the flux of the cell from which it originates:
+     * \f[
+     * J^{\pm} = \mp\frac{\tilde{D}}{2}(\phi_r - \phi_l) +
+     * \hat{D}^{\pm}\phi_{l,r},
+     * \f]
+     * which keeps the system well-behaved for optically thick cells, where
+     * the net-current \f$\hat{D}\f$ can become large and change sign. If
+     * either coefficient is not finite, the outputs are left unchanged.
+     */
+    void partial_d_hat(real_t j_p, real_t j_m, real_t d_tilde, real_t flux_l,
+                       real_t flux_r, real_t &d_hat_p, real_t &d_hat_m) const;
+
+    /**
+     * \brief Populate the coefficients of a one-group CMFD matrix
+     *
+     * \param m the matrix to fill. Must already have the proper sparsity
+     * structure
+     * \param xsrm the removal cross section for each cell
+     * \param d_tilde the D-tilde coefficients for each surface
+     * \param d_hat the D-hat coefficients for each surface, applied to the
+     * flux of the cell on the negative side of the surface
+     * \param d_hat_m the D-hat coefficients for each surface, applied to the
+     * flux of the cell on the positive side of the surface. For the
+     * net-current formulation, this is simply \c -d_hat.
+     */
+    void fill_matrix(Eigen::SparseMatrix<real_t> &m, const VecF &xsrm,
+                     const ArrayB1 &d_tilde, const ArrayB1 &d_hat,
+                     const ArrayB1 &d_hat_m) const;
     void print(int iter, real_t k, real_t k_err, real_t psi_err,
                real_t resid_ratio);
 
@@ -186,6 +383,26 @@ norm = std::sqrt(norm)/(n_cell_*n_group_);
      * systems for each group, it should be faster.
      */
     void setup_solve();
+
+    /**
+     * \brief Prepare for a solve, fixing up negative flux if requested,
+     * updating the homogenized cross sections and setting up the linear
+     * systems.
+     */
+    void begin_solve();
+
+    /**
+     * \brief Finish a solve, cleaning up negative flux and storing the
+     * resultant currents on the \ref CoarseData.
+     */
+    void end_solve();
+
+    /**
+     * \brief Set up the linear system for a single group, computing the
+     * D-hat coefficients from the current state of the \ref CoarseData.
+     */
+    void setup_group(int group);
+
     real_t total_fission();
 
     // Private data
@@ -220,11 +437,21 @@ norm = std::sqrt(norm)/(n_cell_*n_group_);
     // Vector of BiCGSTAB objects.
     std::vector<Eigen::BiCGSTAB<Eigen::SparseMatrix<real_t>>> solvers_;
 
+    // Whether the linear solves are split over multiple processes, and the
+    // distributed solvers used in that case, in place of solvers_ and
+    // fg_solvers_. The matrices themselves are replicated on all processes.
+    bool is_distributed_;
+    std::vector<std::unique_ptr<DistributedBiCGSTAB>> dist_solvers_;
+    std::vector<std::unique_ptr<DistributedBiCGSTAB>> fg_dist_solvers_;
+
     // Surface quantities. We need to keep these around to do the current
     // update without having to recalculate. Based on profiling, might be
     // nice to still get these on the fly to save on memory, but this is
     // fine for now.
     ArrayB2 d_hat_;
+    // D-hat for the partial current in the negative direction. Only differs
+    // from -d_hat_ when using pCMFD
+    ArrayB2 d_hat_m_;
     ArrayB2 d_tilde_;
     ArrayB2 s_hat_;
     ArrayB2 s_tilde_;
@@ -238,9 +465,40 @@ norm = std::sqrt(norm)/(n_cell_*n_group_);
     real_t resid_reduction_;
     int max_iter_;
 
+    // Iteration count and convergence status of the last solve
+    int last_iter_;
+    bool last_converged_;
+
     // Other options
     bool zero_fixup_;
     bool dump_current_;
+    // Whether to use the partial-current (pCMFD) formulation
+    bool pcmfd_;
+
+    // Few-group condensation. n_few_group_ is zero if the full multigroup
+    // system is to be solved. fg_bounds_ stores the first fine group of each
+    // few group, with a trailing n_group_, while fg_map_ maps each fine group
+    // to its few group.
+    int n_few_group_;
+    VecI fg_bounds_;
+    VecI fg_map_;
+    bool fg_smooth_;
+
+    // Few-group data. Cross sections are indexed [few group][cell], the
+    // scattering array is (cell, to group, from group)
+    ArrayB2 fg_flux_;
+    ArrayB2 fg_flux_old_;
+    std::vector<VecF> fg_xsrm_;
+    std::vector<VecF> fg_xsnf_;
+    std::vector<VecF> fg_xsch_;
+    std::vector<VecF> fg_d_;
+    ArrayB3 fg_scat_;
+    ArrayB2 fg_d_tilde_;
+    ArrayB2 fg_d_hat_;
+    ArrayB2 fg_d_hat_m_;
+    VectorX fg_b_;
+    std::vector<Eigen::SparseMatrix<real_t>> fg_m_;
+    std::vector<Eigen::BiCGSTAB<Eigen::SparseMatrix<real_t>>> fg_solvers_;
 };
 typedef std::unique_ptr<CMFD> UP_CMFD_t;
 }
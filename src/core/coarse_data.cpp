@@ -16,6 +16,51 @@
 
 #include "coarse_data.hpp"
 
+#include "util/h5file.hpp"
+
+namespace {
+using namespace mocc;
+typedef blitz::Array<std::array<real_t, 2>, 2> PartialArray;
+
+// Write partial currents as a (surface, group, direction) dataset
+void write_partial(H5Node &node, const std::string &path,
+                   const PartialArray &partial)
+{
+    VecF data;
+    data.reserve(2 * partial.size());
+    for (int is = 0; is < partial.extent(0); is++) {
+        for (int ig = 0; ig < partial.extent(1); ig++) {
+            data.push_back(partial(is, ig)[0]);
+            data.push_back(partial(is, ig)[1]);
+        }
+    }
+    node.write(path, data, {partial.extent(0), partial.extent(1), 2});
+    return;
+}
+
+// Read partial currents written by write_partial(). The dataset is
+// three-dimensional, so check its shape and then read it flat.
+void read_partial(H5Node &node, const std::string &path, PartialArray &partial)
+{
+    auto dims = node.dimensions(path);
+    if ((dims.size() != 3) || ((int)dims[0] != partial.extent(0)) ||
+        ((int)dims[1] != partial.extent(1)) || (dims[2] != 2)) {
+        throw EXCEPT("Incorrect partial current shape in checkpoint.");
+    }
+
+    ArrayB1 data(2 * partial.size());
+    node.read(path, data);
+    int i = 0;
+    for (int is = 0; is < partial.extent(0); is++) {
+        for (int ig = 0; ig < partial.extent(1); ig++) {
+            partial(is, ig)[0] = data(i++);
+            partial(is, ig)[1] = data(i++);
+        }
+    }
+    return;
+}
+}
+
 namespace mocc {
 CoarseData::CoarseData(const Mesh &mesh, size_t ngroup)
     : current((int)mesh.n_surf(), ngroup),
@@ -84,4 +129,64 @@ void CoarseData::zero_data_radial(int group, bool zero_partial)
     }
     return;
 }
+void CoarseData::checkpoint(H5Node &node) const
+{
+    node.write("current", current);
+    node.write("surface_flux", surface_flux);
+    write_partial(node, "partial_current", partial_current);
+    write_partial(node, "partial_current_old", partial_current_old);
+    node.write("flux", flux);
+    node.write("old_flux", old_flux);
+    node.write("has_data_radial", (int)has_data_radial_);
+    node.write("has_data_axial", (int)has_data_axial_);
+    node.write("has_old_partial", (int)has_old_partial_);
+    return;
+}
+
+bool CoarseData::compatible(H5Node &node, const std::string &path) const
+{
+    auto matches = [&](const std::string &name, VecI extents) {
+        std::vector<hsize_t> dims;
+        try {
+            dims = node.dimensions(path + "/" + name);
+        } catch (...) {
+            return false;
+        }
+        if (dims.size() != extents.size()) {
+            return false;
+        }
+        for (int i = 0; i < (int)dims.size(); i++) {
+            if ((int)dims[i] != extents[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    VecI surf  = {current.extent(0), current.extent(1)};
+    VecI part  = {partial_current.extent(0), partial_current.extent(1), 2};
+    VecI cells = {flux.extent(0), flux.extent(1)};
+    return matches("current", surf) && matches("surface_flux", surf) &&
+           matches("partial_current", part) &&
+           matches("partial_current_old", part) && matches("flux", cells) &&
+           matches("old_flux", cells);
+}
+
+void CoarseData::restart(H5Node &node)
+{
+    node.read("current", current);
+    node.read("surface_flux", surface_flux);
+    read_partial(node, "partial_current", partial_current);
+    read_partial(node, "partial_current_old", partial_current_old);
+    node.read("flux", flux);
+    node.read("old_flux", old_flux);
+    int has = 0;
+    node.read("has_data_radial", has);
+    has_data_radial_ = has;
+    node.read("has_data_axial", has);
+    has_data_axial_ = has;
+    node.read("has_old_partial", has);
+    has_old_partial_ = has;
+    return;
+}
 }
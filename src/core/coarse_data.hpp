@@ -25,6 +25,8 @@
 #include "core/mesh.hpp"
 
 namespace mocc {
+class H5Node;
+
 /**
  * CoarseData stores the data needed to do CMFD. Coarse surface currents,
  * fluxes, etc.
@@ -148,6 +150,24 @@ public:
      */
     void zero_data_radial(int group, bool zero_partial = false);
 
+    /**
+     * \brief Write the coarse fluxes and surface quantities to a checkpoint
+     */
+    void checkpoint(H5Node &node) const;
+
+    /**
+     * \brief Read the coarse fluxes and surface quantities from a checkpoint
+     * written by \ref checkpoint()
+     */
+    void restart(H5Node &node);
+
+    /**
+     * \brief Return whether the checkpoint data at \p path in \p node exists
+     * and has the dimensions of this \ref CoarseData, so that it may be
+     * passed to \ref restart()
+     */
+    bool compatible(H5Node &node, const std::string &path) const;
+
     ArrayB2 current;
     ArrayB2 surface_flux;
     blitz::Array<std::array<real_t, 2>, 2> partial_current;
@@ -0,0 +1,145 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "communicator.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+#ifdef MOCC_MPI
+#ifdef FORCE_SINGLE
+const MPI_Datatype MPI_REAL_T = MPI_FLOAT;
+#else
+const MPI_Datatype MPI_REAL_T = MPI_DOUBLE;
+#endif
+#endif
+}
+
+namespace mocc {
+Communicator::Communicator() : rank_(0), size_(1)
+{
+#ifdef MOCC_MPI
+    comm_ = MPI_COMM_SELF;
+#endif
+    return;
+}
+
+Communicator Communicator::world()
+{
+    Communicator comm;
+#ifdef MOCC_MPI
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (initialized) {
+        comm.comm_ = MPI_COMM_WORLD;
+        MPI_Comm_rank(comm.comm_, &comm.rank_);
+        MPI_Comm_size(comm.comm_, &comm.size_);
+    }
+#endif
+    return comm;
+}
+
+void Communicator::barrier() const
+{
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        MPI_Barrier(comm_);
+    }
+#endif
+    return;
+}
+
+real_t Communicator::sum(real_t v) const
+{
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        real_t result = 0.0;
+        MPI_Allreduce(&v, &result, 1, MPI_REAL_T, MPI_SUM, comm_);
+        return result;
+    }
+#endif
+    return v;
+}
+
+real_t Communicator::max(real_t v) const
+{
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        real_t result = 0.0;
+        MPI_Allreduce(&v, &result, 1, MPI_REAL_T, MPI_MAX, comm_);
+        return result;
+    }
+#endif
+    return v;
+}
+
+void Communicator::sum(real_t *data, int n) const
+{
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        MPI_Allreduce(MPI_IN_PLACE, data, n, MPI_REAL_T, MPI_SUM, comm_);
+    }
+#endif
+    return;
+}
+
+void Communicator::broadcast(real_t *data, int n, int root) const
+{
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        MPI_Bcast(data, n, MPI_REAL_T, root, comm_);
+    }
+#endif
+    return;
+}
+
+void Communicator::allgatherv(const real_t *send, int n_send, real_t *recv,
+                              const VecI &counts, const VecI &displs) const
+{
+    assert((int)counts.size() == size_);
+    assert((int)displs.size() == size_);
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        MPI_Allgatherv(send, n_send, MPI_REAL_T, recv, counts.data(),
+                       displs.data(), MPI_REAL_T, comm_);
+        return;
+    }
+#endif
+    std::copy(send, send + n_send, recv + displs[0]);
+    return;
+}
+
+void Communicator::sendrecv(const real_t *send, int n_send, int dest,
+                            real_t *recv, int n_recv, int src) const
+{
+#ifdef MOCC_MPI
+    if (size_ > 1) {
+        MPI_Sendrecv(send, n_send, MPI_REAL_T,
+                     dest >= 0 ? dest : MPI_PROC_NULL, 0, recv, n_recv,
+                     MPI_REAL_T, src >= 0 ? src : MPI_PROC_NULL, 0, comm_,
+                     MPI_STATUS_IGNORE);
+        return;
+    }
+#endif
+    // With only one process, the only valid exchange is with ourselves
+    if ((dest == rank_) && (src == rank_)) {
+        assert(n_send == n_recv);
+        std::copy(send, send + n_send, recv);
+    }
+    return;
+}
+}
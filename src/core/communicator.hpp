@@ -0,0 +1,130 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "util/global_config.hpp"
+
+#ifdef MOCC_MPI
+#include <mpi.h>
+#endif
+
+namespace mocc {
+/**
+ * \brief Thin abstraction over a group of cooperating processes.
+ *
+ * This wraps the small subset of MPI functionality that MOCC needs, so that
+ * the rest of the code can be written against a single interface regardless
+ * of whether it is built with MPI support. When MOCC is built without MPI
+ * (the default), or MPI has not been initialized, a \ref Communicator
+ * behaves as a communicator of size one, and all of the collective
+ * operations reduce to no-ops or copies.
+ *
+ * Processes are referred to by their rank in the communicator. Where a rank
+ * is passed as an argument, a negative value means "no process," and the
+ * corresponding half of the operation is skipped.
+ */
+class Communicator {
+public:
+    /**
+     * \brief Construct a serial communicator, containing only the calling
+     * process.
+     */
+    Communicator();
+
+    /**
+     * \brief Return a \ref Communicator containing all processes.
+     *
+     * If MPI is not available or has not been initialized, this is the same
+     * as a default-constructed \ref Communicator.
+     */
+    static Communicator world();
+
+    int rank() const
+    {
+        return rank_;
+    }
+
+    int size() const
+    {
+        return size_;
+    }
+
+    bool is_root() const
+    {
+        return rank_ == 0;
+    }
+
+    /**
+     * \brief Block until all processes in the communicator reach this point
+     */
+    void barrier() const;
+
+    /**
+     * \brief Return the sum of \p v over all processes
+     */
+    real_t sum(real_t v) const;
+
+    /**
+     * \brief Return the maximum of \p v over all processes
+     */
+    real_t max(real_t v) const;
+
+    /**
+     * \brief Sum the \p n values in \p data over all processes, in place.
+     */
+    void sum(real_t *data, int n) const;
+
+    /**
+     * \brief Broadcast \p n values in \p data from the \p root process to all
+     * others.
+     */
+    void broadcast(real_t *data, int n, int root = 0) const;
+
+    /**
+     * \brief Gather variable-sized contributions from all processes into
+     * \p recv on all processes.
+     *
+     * \param send the local contribution
+     * \param n_send the size of the local contribution
+     * \param recv the destination array, large enough to store all
+     * contributions
+     * \param counts the size of the contribution from each process
+     * \param displs the offset into \p recv for the contribution from each
+     * process
+     */
+    void allgatherv(const real_t *send, int n_send, real_t *recv,
+                    const VecI &counts, const VecI &displs) const;
+
+    /**
+     * \brief Send \p n_send values to process \p dest while receiving \p
+     * n_recv values from process \p src.
+     *
+     * Either \p dest or \p src may be negative, in which case that half of
+     * the exchange is skipped. Like MPI_Sendrecv, every process taking part
+     * must make a matching call.
+     */
+    void sendrecv(const real_t *send, int n_send, int dest, real_t *recv,
+                  int n_recv, int src) const;
+
+private:
+#ifdef MOCC_MPI
+    MPI_Comm comm_;
+#endif
+    int rank_;
+    int size_;
+};
+}
@@ -243,6 +243,51 @@ Point2 CoreMesh::pin_origin(size_t ipin) const
     return p;
 }
 
+VecI CoreMesh::coarse_cell_map(MeshTreatment treatment) const
+{
+    VecI map;
+    map.reserve(this->n_reg(treatment));
+
+    switch (treatment) {
+    case MeshTreatment::PLANE: {
+        int implane = 0;
+        for (const auto &mplane : macroplanes_) {
+            int ipin = 0;
+            for (const auto mpin : mplane) {
+                Position pos = this->pin_position(ipin);
+                pos.z        = implane;
+                int cell     = this->coarse_cell(pos);
+                for (int ir = 0; ir < mpin->n_reg(); ir++) {
+                    map.push_back(cell);
+                }
+                ipin++;
+            }
+            implane++;
+        }
+    } break;
+
+    case MeshTreatment::PIN:
+        // PIN regions are indexed by coarse cell, not in pin order
+        for (int i = 0; i < (int)this->n_pin(); i++) {
+            Position pos = this->coarse_position(i);
+            pos.z        = this->macroplane_index(pos.z);
+            map.push_back(this->coarse_cell(pos));
+        }
+        break;
+
+    case MeshTreatment::PIN_PLANE:
+        for (int i = 0; i < (int)this->n_reg(treatment); i++) {
+            map.push_back(i);
+        }
+        break;
+
+    default:
+        throw EXCEPT("Unsupported mesh treatment for coarse cell map");
+    }
+
+    return map;
+}
+
 CoreMesh::LocationInfo CoreMesh::get_location_info(Point3 p,
                                                    Direction dir) const
 {
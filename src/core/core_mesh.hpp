@@ -273,6 +273,17 @@ public:
      */
     Point2 pin_origin(size_t ipin) const;
 
+    /**
+     * \brief Return, for each region of the passed \ref MeshTreatment, the
+     * index of the \ref MeshTreatment::PIN_PLANE coarse cell that contains
+     * it.
+     *
+     * This is useful for homogenizing arbitrary quantities on a sweeper mesh
+     * to the CMFD mesh. The \ref MeshTreatment::TRUE treatment is not
+     * supported.
+     */
+    VecI coarse_cell_map(MeshTreatment treatment) const;
+
     /**
      * \brief Return a const reference to the vector of plane IDs
      *
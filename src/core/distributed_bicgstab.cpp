@@ -0,0 +1,226 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "distributed_bicgstab.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "util/error.hpp"
+
+namespace mocc {
+DistributedBiCGSTAB::DistributedBiCGSTAB(const Communicator &comm, int n,
+                                         int block)
+    : comm_(comm),
+      n_(n),
+      counts_(comm.size()),
+      displs_(comm.size()),
+      ext_stt_(0),
+      ext_stp_(n),
+      send_begin_(comm.size(), 0),
+      send_count_(comm.size(), 0),
+      recv_begin_(comm.size(), 0),
+      recv_count_(comm.size(), 0),
+      tol_(1.0e-8),
+      max_iter_(150),
+      iterations_(0),
+      error_(0.0)
+{
+    int size = comm_.size();
+
+    // Partition in whole blocks if there are enough of them to go around
+    if ((block < 1) || (n % block != 0) || (n / block < size)) {
+        block = 1;
+    }
+    if (n < size) {
+        throw EXCEPT("Too many processes for the size of the system");
+    }
+    int n_block = n / block;
+    int pos     = 0;
+    for (int ip = 0; ip < size; ip++) {
+        int nb      = n_block / size + ((ip < n_block % size) ? 1 : 0);
+        displs_[ip] = pos;
+        counts_[ip] = nb * block;
+        pos += nb * block;
+    }
+    stt_ = displs_[comm_.rank()];
+    stp_ = stt_ + counts_[comm_.rank()];
+
+    return;
+}
+
+void DistributedBiCGSTAB::compute(const Eigen::SparseMatrix<real_t> &m)
+{
+    assert(m.rows() == n_);
+    assert(m.cols() == n_);
+
+    LocalMatrix m_row(m);
+
+    // Determine the bandwidth of the matrix, so we know how far the halo
+    // needs to reach
+    int bw = 0;
+    for (int i = 0; i < n_; i++) {
+        for (LocalMatrix::InnerIterator it(m_row, i); it; ++it) {
+            bw = std::max(bw, (int)std::abs(it.col() - i));
+        }
+    }
+    ext_stt_ = std::max(0, stt_ - bw);
+    ext_stp_ = std::min(n_, stp_ + bw);
+
+    // Extract local rows, re-indexing columns into the extended vector, as
+    // well as the diagonal block for the preconditioner
+    int n_loc = stp_ - stt_;
+    std::vector<Eigen::Triplet<real_t>> a_trip;
+    std::vector<Eigen::Triplet<real_t>> d_trip;
+    for (int i = stt_; i < stp_; i++) {
+        for (LocalMatrix::InnerIterator it(m_row, i); it; ++it) {
+            int j = it.col();
+            a_trip.push_back(
+                Eigen::Triplet<real_t>(i - stt_, j - ext_stt_, it.value()));
+            if ((j >= stt_) && (j < stp_)) {
+                d_trip.push_back(
+                    Eigen::Triplet<real_t>(i - stt_, j - stt_, it.value()));
+            }
+        }
+    }
+    a_.resize(n_loc, ext_stp_ - ext_stt_);
+    a_.setFromTriplets(a_trip.begin(), a_trip.end());
+    a_.makeCompressed();
+
+    Eigen::SparseMatrix<real_t> d(n_loc, n_loc);
+    d.setFromTriplets(d_trip.begin(), d_trip.end());
+    d.makeCompressed();
+    ilu_.compute(d);
+    if (ilu_.info() != Eigen::Success) {
+        throw EXCEPT("Failed to factorize local preconditioner");
+    }
+
+    x_ext_.resize(ext_stp_ - ext_stt_);
+
+    // Set up the halo exchange. The halo of each process is everything
+    // within the bandwidth of its own rows, so what we need from a process
+    // is the overlap of its rows with our extended range, and what it needs
+    // from us is the overlap of our rows with its extended range.
+    int size = comm_.size();
+    int rank = comm_.rank();
+    for (int d = 1; d < size; d++) {
+        int dest     = (rank + d) % size;
+        int src      = (rank - d + size) % size;
+        int dest_stt = std::max(0, displs_[dest] - bw);
+        int dest_stp = std::min(n_, displs_[dest] + counts_[dest] + bw);
+
+        send_begin_[d] = std::max(stt_, dest_stt);
+        send_count_[d] = std::max(0, std::min(stp_, dest_stp) - send_begin_[d]);
+
+        int src_stp    = displs_[src] + counts_[src];
+        recv_begin_[d] = std::max(ext_stt_, displs_[src]);
+        recv_count_[d] =
+            std::max(0, std::min(ext_stp_, src_stp) - recv_begin_[d]);
+    }
+
+    return;
+}
+
+void DistributedBiCGSTAB::multiply(const VectorX &x, VectorX &y)
+{
+    int size = comm_.size();
+    int rank = comm_.rank();
+
+    x_ext_.segment(stt_ - ext_stt_, stp_ - stt_) = x;
+    for (int d = 1; d < size; d++) {
+        int dest = send_count_[d] > 0 ? (rank + d) % size : -1;
+        int src  = recv_count_[d] > 0 ? (rank - d + size) % size : -1;
+        comm_.sendrecv(x.data() + send_begin_[d] - stt_, send_count_[d], dest,
+                       x_ext_.data() + recv_begin_[d] - ext_stt_,
+                       recv_count_[d], src);
+    }
+
+    y = a_ * x_ext_;
+    return;
+}
+
+VectorX DistributedBiCGSTAB::solveWithGuess(const VectorX &b_full,
+                                            const VectorX &x0)
+{
+    int n_loc = stp_ - stt_;
+
+    VectorX b = b_full.segment(stt_, n_loc);
+    VectorX x = x0.segment(stt_, n_loc);
+
+    VectorX r(n_loc);
+    this->multiply(x, r);
+    r = b - r;
+    VectorX r_hat = r;
+
+    real_t b_norm = std::sqrt(this->dot(b, b));
+    if (b_norm == 0.0) {
+        b_norm = 1.0;
+    }
+
+    VectorX p    = VectorX::Zero(n_loc);
+    VectorX v    = VectorX::Zero(n_loc);
+    VectorX y(n_loc);
+    VectorX z(n_loc);
+    VectorX s(n_loc);
+    VectorX t(n_loc);
+    real_t rho   = 1.0;
+    real_t alpha = 1.0;
+    real_t omega = 1.0;
+
+    iterations_ = 0;
+    error_      = std::sqrt(this->dot(r, r)) / b_norm;
+    while ((error_ > tol_) && (iterations_ < max_iter_)) {
+        real_t rho_new = this->dot(r_hat, r);
+        if (rho_new == 0.0) {
+            // Breakdown. Restart with the current residual
+            r_hat   = r;
+            rho_new = this->dot(r_hat, r);
+            p.setZero();
+            v.setZero();
+            rho   = 1.0;
+            alpha = 1.0;
+            omega = 1.0;
+        }
+        real_t beta = (rho_new / rho) * (alpha / omega);
+        rho         = rho_new;
+
+        p = r + beta * (p - omega * v);
+        y = ilu_.solve(p);
+        this->multiply(y, v);
+        alpha = rho / this->dot(r_hat, v);
+
+        s = r - alpha * v;
+        z = ilu_.solve(s);
+        this->multiply(z, t);
+        real_t tt = this->dot(t, t);
+        omega     = tt > 0.0 ? this->dot(t, s) / tt : 0.0;
+
+        x += alpha * y + omega * z;
+        r = s - omega * t;
+
+        iterations_++;
+        error_ = std::sqrt(this->dot(r, r)) / b_norm;
+        if (omega == 0.0) {
+            break;
+        }
+    }
+
+    // Gather the full solution to all processes
+    VectorX x_full(n_);
+    comm_.allgatherv(x.data(), n_loc, x_full.data(), counts_, displs_);
+
+    return x_full;
+}
+}
@@ -0,0 +1,168 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/Sparse>
+
+#include "util/global_config.hpp"
+#include "communicator.hpp"
+#include "eigen_interface.hpp"
+
+namespace mocc {
+/**
+ * \brief A BiCGSTAB linear solver, distributed over the processes of a \ref
+ * Communicator.
+ *
+ * The rows of the system are partitioned into contiguous blocks, one per
+ * process. When possible the blocks are aligned to multiples of a
+ * user-specified block size (e.g. the number of cells in a plane of a \ref
+ * Mesh), so that for a 3-D mesh each process owns a set of whole planes.
+ * Only the Krylov iteration itself is distributed: the full matrix is passed
+ * to \ref compute() on every process, which then keeps only its own rows.
+ * Matrix-vector products need off-process vector entries within the
+ * bandwidth of the matrix; these are exchanged as halos before each product.
+ *
+ * Preconditioning is block-Jacobi, where each process applies an incomplete
+ * LU factorization of the diagonal block of the matrix it owns.
+ *
+ * The interface mirrors that of the Eigen iterative solvers, so that it can
+ * be swapped in where an \c Eigen::BiCGSTAB is otherwise used. The
+ * right-hand side, initial guess and solution are all full-length vectors,
+ * replicated on every process; the local parts of the solution are gathered
+ * to all processes at the end of each solve.
+ */
+class DistributedBiCGSTAB {
+public:
+    typedef Eigen::SparseMatrix<real_t, Eigen::RowMajor> LocalMatrix;
+
+    /**
+     * \brief Construct a solver for systems of size \p n
+     *
+     * \param comm the \ref Communicator over which to distribute the system
+     * \param n the number of rows in the system
+     * \param block the preferred granularity of the row partitioning
+     */
+    DistributedBiCGSTAB(const Communicator &comm, int n, int block = 1);
+
+    /**
+     * \brief Extract the local rows of \p m and factorize the local
+     * preconditioner.
+     *
+     * The matrix should be identical on all processes.
+     */
+    void compute(const Eigen::SparseMatrix<real_t> &m);
+
+    /**
+     * \brief Solve the system for the right-hand side \p b, starting from
+     * the initial guess \p x0, and return the full solution on all processes.
+     */
+    VectorX solveWithGuess(const VectorX &b, const VectorX &x0);
+
+    /**
+     * \brief Set the convergence tolerance, relative to the norm of the
+     * right-hand side.
+     */
+    void setTolerance(real_t tol)
+    {
+        tol_ = tol;
+    }
+
+    void setMaxIterations(int max_iter)
+    {
+        max_iter_ = max_iter;
+    }
+
+    /**
+     * \brief Return the number of iterations performed by the last solve
+     */
+    int iterations() const
+    {
+        return iterations_;
+    }
+
+    /**
+     * \brief Return the relative residual norm at the end of the last solve
+     */
+    real_t error() const
+    {
+        return error_;
+    }
+
+    /**
+     * \brief Return the first row owned by this process
+     */
+    int first_row() const
+    {
+        return stt_;
+    }
+
+    /**
+     * \brief Return the number of rows owned by this process
+     */
+    int n_local() const
+    {
+        return stp_ - stt_;
+    }
+
+private:
+    /**
+     * \brief Compute y = A*x for the local rows, exchanging the halo of x.
+     */
+    void multiply(const VectorX &x, VectorX &y);
+
+    /**
+     * \brief Dot product, reduced over all processes
+     */
+    real_t dot(const VectorX &a, const VectorX &b) const
+    {
+        return comm_.sum(a.dot(b));
+    }
+
+    Communicator comm_;
+    int n_;
+
+    // Row partitioning. counts_ and displs_ are used to gather the solution
+    int stt_;
+    int stp_;
+    VecI counts_;
+    VecI displs_;
+
+    // Extent of the vector needed by the local rows, including halo
+    int ext_stt_;
+    int ext_stp_;
+
+    // Halo exchange pattern. For each offset d in [1, size), this process
+    // sends to rank + d and receives from rank - d.
+    VecI send_begin_;
+    VecI send_count_;
+    VecI recv_begin_;
+    VecI recv_count_;
+
+    // Local rows, with columns indexed into the extended vector
+    LocalMatrix a_;
+    Eigen::IncompleteLUT<real_t> ilu_;
+
+    // Extended vector workspace
+    VectorX x_ext_;
+
+    real_t tol_;
+    int max_iter_;
+    int iterations_;
+    real_t error_;
+};
+}
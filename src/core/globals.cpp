@@ -19,5 +19,6 @@
 namespace mocc {
 namespace global {
 std::string case_name;
+volatile std::sig_atomic_t interrupted = 0;
 }
 }
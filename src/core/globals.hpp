@@ -15,10 +15,16 @@
 */
 
 #pragma once
+#include <csignal>
 #include <string>
 
 namespace mocc {
 namespace global {
 extern std::string case_name;
+
+// Set by the driver when the run has been interrupted. Solvers that support
+// checkpoints should write one at the end of their current iteration and
+// return.
+extern volatile std::sig_atomic_t interrupted;
 }
 }
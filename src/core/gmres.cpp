@@ -0,0 +1,124 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "gmres.hpp"
+
+#include <cmath>
+#include <vector>
+#include "util/error.hpp"
+
+namespace mocc {
+GMRES::GMRES(int max_krylov, real_t tol, int max_restarts)
+    : max_krylov_(max_krylov),
+      tol_(tol),
+      max_restarts_(max_restarts),
+      error_(0.0)
+{
+    if (max_krylov_ < 1) {
+        throw EXCEPT("Krylov subspace dimension must be at least 1");
+    }
+    return;
+}
+
+int GMRES::solve(const Operator &a, const VectorX &b, VectorX &x)
+{
+    int n        = b.size();
+    int m        = max_krylov_;
+    real_t bnorm = b.norm();
+    if (bnorm == 0.0) {
+        x      = VectorX::Zero(n);
+        error_ = 0.0;
+        return 0;
+    }
+
+    std::vector<VectorX> v(m + 1);
+    MatrixX h = MatrixX::Zero(m + 1, m);
+    VectorX cs(m);
+    VectorX sn(m);
+    VectorX g(m + 1);
+    VectorX w(n);
+
+    int n_apply = 0;
+    for (int restart = 0; restart <= max_restarts_; restart++) {
+        // Initial residual. Skip the operator for a zero initial guess.
+        VectorX r = b;
+        if (x.squaredNorm() > 0.0) {
+            a(x, w);
+            r -= w;
+        }
+        real_t beta = r.norm();
+        error_      = beta / bnorm;
+        if (error_ <= tol_) {
+            break;
+        }
+
+        v[0] = r / beta;
+        g    = VectorX::Zero(m + 1);
+        g[0] = beta;
+
+        int k = 0;
+        for (; k < m; k++) {
+            a(v[k], w);
+            n_apply++;
+
+            // Modified Gram-Schmidt
+            for (int j = 0; j <= k; j++) {
+                h(j, k) = w.dot(v[j]);
+                w -= h(j, k) * v[j];
+            }
+            h(k + 1, k) = w.norm();
+
+            // Apply previous Givens rotations to the new column
+            for (int j = 0; j < k; j++) {
+                real_t tmp  = cs[j] * h(j, k) + sn[j] * h(j + 1, k);
+                h(j + 1, k) = -sn[j] * h(j, k) + cs[j] * h(j + 1, k);
+                h(j, k)     = tmp;
+            }
+
+            // Form and apply the new rotation
+            real_t denom = std::sqrt(h(k, k) * h(k, k) +
+                                     h(k + 1, k) * h(k + 1, k));
+            cs[k]    = h(k, k) / denom;
+            sn[k]    = h(k + 1, k) / denom;
+            h(k, k)  = denom;
+            g[k + 1] = -sn[k] * g[k];
+            g[k]     = cs[k] * g[k];
+
+            error_ = std::abs(g[k + 1]) / bnorm;
+
+            if ((error_ <= tol_) || (h(k + 1, k) == 0.0)) {
+                k++;
+                break;
+            }
+            v[k + 1] = w / h(k + 1, k);
+        }
+
+        // Solve the upper-triangular least-squares system and update x
+        VectorX y = h.topLeftCorner(k, k)
+                        .triangularView<Eigen::Upper>()
+                        .solve(g.head(k));
+        for (int j = 0; j < k; j++) {
+            x += y[j] * v[j];
+        }
+
+        if (error_ <= tol_) {
+            break;
+        }
+    }
+
+    return n_apply;
+}
+}
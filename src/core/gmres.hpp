@@ -0,0 +1,83 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <functional>
+
+#include "util/global_config.hpp"
+#include "eigen_interface.hpp"
+
+namespace mocc {
+/**
+ * \brief A restarted GMRES solver for matrix-free linear operators.
+ *
+ * The linear operator is supplied as a function that computes y = Ax, so that
+ * the matrix need never be formed. This makes it suitable for Krylov solves
+ * where the action of the operator is a transport sweep, or a finite
+ * difference approximation of a Jacobian.
+ */
+class GMRES {
+public:
+    /**
+     * \brief Function computing the action of the linear operator, \p out =
+     * A \p in
+     */
+    typedef std::function<void(const VectorX &in, VectorX &out)> Operator;
+
+    /**
+     * \brief Construct a GMRES solver
+     *
+     * \param max_krylov the maximum dimension of the Krylov subspace before
+     * restarting
+     * \param tol the convergence tolerance on the residual norm, relative to
+     * the norm of the right-hand side
+     * \param max_restarts the maximum number of restarts
+     */
+    GMRES(int max_krylov, real_t tol, int max_restarts = 0);
+
+    /**
+     * \brief Solve Ax = b
+     *
+     * \param a the linear operator
+     * \param b the right-hand side
+     * \param x the initial guess on input, and the solution on output
+     *
+     * \returns the total number of operator applications, not counting those
+     * used to form the initial residual.
+     */
+    int solve(const Operator &a, const VectorX &b, VectorX &x);
+
+    /**
+     * \brief Return the relative residual norm at the end of the last solve
+     */
+    real_t error() const
+    {
+        return error_;
+    }
+
+    void set_tolerance(real_t tol)
+    {
+        tol_ = tol;
+    }
+
+private:
+    int max_krylov_;
+    real_t tol_;
+    int max_restarts_;
+    real_t error_;
+};
+}
@@ -17,6 +17,7 @@
 #include "material_lib.hpp"
 
 #include <iostream>
+#include <memory>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -49,6 +50,13 @@ MaterialLib::MaterialLib(const pugi::xml_node &input) : n_material_(0)
     }
     std::string matLibName = input.attribute("path").value();
     LogFile << "Using material library at: " << matLibName << std::endl;
+
+    if ((matLibName.size() > 3) &&
+        (matLibName.compare(matLibName.size() - 3, 3, ".h5") == 0)) {
+        this->read_h5(input, matLibName);
+        return;
+    }
+
     FileScrubber matLibFile;
 
     try {
@@ -92,11 +100,11 @@ MaterialLib::MaterialLib(const pugi::xml_node &input) : n_material_(0)
     }
 
     // Read in material data
+    const regex headExp("^\\s*XSMACRO\\s+([^\\s]+)\\s+([0-9]+)\\s*$");
     for (size_t imat = 0; imat < n_material_lib_; imat++) {
         // Get the name of the material
         line = matLibFile.getline();
 
-        regex headExp("^\\s*XSMACRO\\s+([^\\s]+)\\s+([0-9]+)\\s*$");
         smatch results;
         regex_match(line, results, headExp);
         string materialName = results[1].str();
@@ -182,11 +190,11 @@ MaterialLib::MaterialLib(FileScrubber &input) : n_material_(0)
     }
 
     // Read in material data
+    const regex headExp("^\\s*XSMACRO\\s+([^\\s]+)\\s+([0-9]+)\\s*$");
     for (size_t imat = 0; imat < n_material_lib_; imat++) {
         // Get the name of the material
         line = input.getline();
 
-        regex headExp("^\\s*XSMACRO\\s+([^\\s]+)\\s+([0-9]+)\\s*$");
         smatch results;
         regex_match(line, results, headExp);
         string materialName = results[1].str();
@@ -237,6 +245,113 @@ MaterialLib::MaterialLib(FileScrubber &input) : n_material_(0)
     }
 }
 
+void MaterialLib::read_h5(const pugi::xml_node &input,
+                          const std::string &path)
+{
+    std::unique_ptr<H5Node> h5f;
+    try {
+        h5f.reset(new H5Node(path, H5Access::READ));
+    } catch (...) {
+        std::stringstream msg;
+        msg << "Failed to open the cross-section library at: " << path;
+        throw EXCEPT(msg.str());
+    }
+
+    int ng = 0;
+    h5f->read("n_group", ng);
+    if (ng < 1) {
+        throw EXCEPT("Invalid number of groups in material library");
+    }
+    n_grp_ = ng;
+
+    std::vector<double> bounds;
+    h5f->read("g_bounds", bounds);
+    if ((int)bounds.size() != ng) {
+        throw EXCEPT("Wrong number of group bounds in material library");
+    }
+    g_bounds_ = VecF(bounds.begin(), bounds.end());
+
+    // Only load the materials that are actually referenced by the input.
+    // Each cross section is a single bulk read.
+    n_material_lib_ = 0;
+    for (auto mat = input.child("material"); mat;
+         mat      = mat.next_sibling("material")) {
+        std::string name = mat.attribute("name").value();
+        if (material_names_.count(name) > 0) {
+            continue;
+        }
+
+        std::string base = "materials/" + name + "/";
+        std::vector<double> xsab(ng);
+        std::vector<double> xsnf(ng);
+        std::vector<double> xsf(ng);
+        std::vector<double> xsch(ng);
+        std::vector<double> xssc(ng * ng);
+        try {
+            h5f->read(base + "xsab", xsab);
+            h5f->read(base + "xsnf", xsnf);
+            h5f->read(base + "xsf", xsf);
+            h5f->read(base + "xsch", xsch);
+            h5f->read(base + "xssc", xssc);
+        } catch (Exception e) {
+            std::stringstream msg;
+            msg << "Failed to read material '" << name
+                << "' from the cross-section library. Does it exist?";
+            throw EXCEPT(msg.str());
+        }
+
+        std::vector<VecF> scatTable;
+        scatTable.reserve(ng);
+        for (int ig = 0; ig < ng; ig++) {
+            scatTable.emplace_back(xssc.begin() + ig * ng,
+                                   xssc.begin() + (ig + 1) * ng);
+        }
+
+        lib_materials_.push_back(Material(
+            VecF(xsab.begin(), xsab.end()), VecF(xsnf.begin(), xsnf.end()),
+            VecF(xsf.begin(), xsf.end()), VecF(xsch.begin(), xsch.end()),
+            scatTable));
+        material_names_[name] = n_material_lib_;
+        n_material_lib_++;
+    }
+    LogFile << "Loaded " << n_material_lib_
+            << " materials from binary library" << std::endl;
+
+    // Parse material IDs
+    for (auto mat = input.child("material"); mat;
+         mat      = mat.next_sibling("material")) {
+        this->assignID(mat.attribute("id").as_int(),
+                       mat.attribute("name").value());
+    }
+
+    return;
+}
+
+void MaterialLib::output(H5Node &file) const
+{
+    file.write("n_group", (int)n_grp_);
+    file.write("g_bounds", g_bounds_);
+
+    auto g = file.create_group("materials");
+    for (const auto &name_index : material_names_) {
+        const std::string &name = name_index.first;
+        if (name.find('/') != std::string::npos) {
+            std::stringstream msg;
+            msg << "Material name '" << name << "' is not a valid HDF5 name";
+            throw EXCEPT(msg.str());
+        }
+        const Material &mat = lib_materials_[name_index.second];
+        auto mat_g          = g.create_group(name);
+        mat_g.write("xsab", mat.xsab());
+        mat_g.write("xsnf", mat.xsnf());
+        mat_g.write("xsf", mat.xsf());
+        mat_g.write("xsch", mat.xsch());
+        mat_g.write("xssc", mat.xssc().as_vector());
+    }
+
+    return;
+}
+
 void MaterialLib::assignID(int id, std::string name)
 {
     try {
@@ -20,6 +20,7 @@
 
 #include "util/file_scrubber.hpp"
 #include "util/global_config.hpp"
+#include "util/h5file.hpp"
 #include "util/pugifwd.hpp"
 #include "core/material.hpp"
 
@@ -43,6 +44,15 @@ public:
      */
     MaterialLib(FileScrubber &input);
 
+    /**
+     * \brief Construct a \ref MaterialLib from a \<material_lib\> tag.
+     *
+     * The library at the \c path attribute may either be a text "MPACT user
+     * cross-section library," or, if the path ends in ".h5," a binary
+     * library as produced by \ref MaterialLib::output(). For binary
+     * libraries, only the materials referenced by the \<material\> tags are
+     * read from the file.
+     */
     MaterialLib(const pugi::xml_node &input);
 
     /**
@@ -124,7 +134,25 @@ public:
         return material_ids_.count(id) > 0;
     }
 
+    /**
+     * \brief Write the entire library to an HDF5 file.
+     *
+     * The resulting file can be used in place of the original text library,
+     * and is much faster to load. Each material is stored in its own group
+     * under \c /materials, named by the material name, containing the
+     * absorption, nu-fission, fission, chi and scattering cross sections. The
+     * scattering matrix is stored densely, as a flattened, row-major
+     * (to, from) matrix. The number of groups and group bounds are stored at
+     * the root of the file.
+     */
+    void output(H5Node &file) const;
+
 private:
+    /**
+     * \brief Read the materials referenced by \p input from an HDF5 library
+     */
+    void read_h5(const pugi::xml_node &input, const std::string &path);
+
     // Vector storing all of the materials in the library.
     MaterialVec lib_materials_;
 
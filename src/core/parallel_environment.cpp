@@ -21,7 +21,7 @@
 
 namespace mocc {
 ParallelEnvironment::ParallelEnvironment(const pugi::xml_node &input)
-    : num_threads_(1)
+    : num_threads_(1), comm_(Communicator::world())
 {
     if (!input.empty()) {
         num_threads_ =
@@ -45,5 +45,23 @@ ParallelEnvironment::ParallelEnvironment(const pugi::xml_node &input)
     return;
 }
 
+void ParallelEnvironment::start(int &argc, char **&argv)
+{
+#ifdef MOCC_MPI
+    MPI_Init(&argc, &argv);
+    comm_ = Communicator::world();
+#endif
+    return;
+}
+
+void ParallelEnvironment::stop()
+{
+#ifdef MOCC_MPI
+    comm_ = Communicator();
+    MPI_Finalize();
+#endif
+    return;
+}
+
 ParallelEnvironment ParEnv;
 }
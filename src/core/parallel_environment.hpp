@@ -17,6 +17,7 @@
 #pragma once
 
 #include "util/pugifwd.hpp"
+#include "communicator.hpp"
 
 namespace mocc {
 /**
@@ -26,8 +27,9 @@ namespace mocc {
  * There should be a global instance of this class, initialized somewhere
  * like \ref InputProc or similar. For now, since we only do threading this
  * class is not much more useful than a global integer storing the number of
- * threads available. As we get more complicated or add MPI, this will
- * become more useful.
+ * threads available, and the \ref Communicator spanning all processes. When
+ * MOCC is built without MPI, that \ref Communicator only ever contains the
+ * calling process.
  *
  * Really, this should be a singleton class, but I have better things to do
  * than make sure I handle all the nasty corner cases that that would
@@ -36,9 +38,10 @@ namespace mocc {
 class ParallelEnvironment {
 private:
     int num_threads_;
+    Communicator comm_;
 
 public:
-    ParallelEnvironment() : num_threads_(1)
+    ParallelEnvironment() : num_threads_(1), comm_(Communicator::world())
     {
         return;
     }
@@ -54,6 +57,29 @@ public:
     {
         num_threads_ = num_threads;
     }
+
+    /**
+     * \brief Return the \ref Communicator containing all processes.
+     */
+    const Communicator &comm() const
+    {
+        return comm_;
+    }
+
+    /**
+     * \brief Initialize the message passing environment, if MOCC is built
+     * with MPI support.
+     *
+     * This should be called once, at the very beginning of execution, before
+     * the global \ref ParallelEnvironment is used for anything else.
+     */
+    void start(int &argc, char **&argv);
+
+    /**
+     * \brief Shut down the message passing environment, if MOCC is built
+     * with MPI support.
+     */
+    void stop();
 };
 
 // Declare the global instance of ParallelEnvironment
@@ -0,0 +1,244 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "pin_projection.hpp"
+
+#include "util/error.hpp"
+
+namespace {
+/**
+ * \brief Build a CSR operator that volume-averages regions into the cells
+ * given by \p cell.
+ */
+void build_average(const mocc::VecI &cell, const mocc::VecF &vol, int n_cell,
+                   mocc::VecI &row, mocc::VecI &col, mocc::VecF &wt)
+{
+    int n = cell.size();
+    assert((int)vol.size() == n);
+
+    // Count the entries in each row, and turn them into offsets
+    row.assign(n_cell + 1, 0);
+    for (int i = 0; i < n; i++) {
+        row[cell[i] + 1]++;
+    }
+    for (int c = 0; c < n_cell; c++) {
+        row[c + 1] += row[c];
+    }
+
+    // Fill the rows, preserving the region order within each
+    col.resize(n);
+    wt.resize(n);
+    mocc::VecI next(row.begin(), row.end() - 1);
+    for (int i = 0; i < n; i++) {
+        int k  = next[cell[i]]++;
+        col[k] = i;
+        wt[k]  = vol[i];
+    }
+
+    // Normalize the weights by the total volume of each cell
+    for (int c = 0; c < n_cell; c++) {
+        mocc::real_t v = 0.0;
+        for (int k = row[c]; k < row[c + 1]; k++) {
+            v += wt[k];
+        }
+        for (int k = row[c]; k < row[c + 1]; k++) {
+            wt[k] /= v;
+        }
+    }
+
+    return;
+}
+}
+
+namespace mocc {
+PinProjection::PinProjection(const CoreMesh &mesh, MeshTreatment treatment,
+                             const VecF &vol)
+    : n_fine_(mesh.n_reg(treatment)),
+      n_cell_(mesh.n_reg(MeshTreatment::PIN_PLANE)),
+      fine_is_pin_(treatment == MeshTreatment::PIN)
+{
+    if ((treatment != MeshTreatment::PLANE) &&
+        (treatment != MeshTreatment::PIN)) {
+        throw EXCEPT("Unsupported mesh treatment for pin projection");
+    }
+    if ((int)vol.size() != n_fine_) {
+        throw EXCEPT("Wrong number of volumes for pin projection");
+    }
+
+    fine_cell_ = mesh.coarse_cell_map(treatment);
+    build_average(fine_cell_, vol, n_cell_, row_, col_, wt_);
+
+    pin_cell_ = mesh.coarse_cell_map(MeshTreatment::PIN);
+    build_average(pin_cell_, mesh.volumes(MeshTreatment::PIN), n_cell_,
+                  axial_row_, axial_col_, axial_wt_);
+
+    return;
+}
+
+void PinProjection::homogenize(const ArrayB2 &fine, ArrayB2 &coarse,
+                               MeshTreatment treatment) const
+{
+    assert(!this->empty());
+    assert(fine.extent(0) == n_fine_);
+    assert(coarse.extent(0) == (int)(treatment == MeshTreatment::PIN
+                                         ? pin_cell_.size()
+                                         : n_cell_));
+    assert(coarse.extent(1) == fine.extent(1));
+
+    const int ng = fine.extent(1);
+
+    switch (treatment) {
+    case MeshTreatment::PIN_PLANE:
+#pragma omp parallel for
+        for (int c = 0; c < n_cell_; c++) {
+            for (int ig = 0; ig < ng; ig++) {
+                coarse(c, ig) = 0.0;
+            }
+            for (int k = row_[c]; k < row_[c + 1]; k++) {
+                const int i    = col_[k];
+                const real_t w = wt_[k];
+                for (int ig = 0; ig < ng; ig++) {
+                    coarse(c, ig) += w * fine(i, ig);
+                }
+            }
+        }
+        break;
+
+    case MeshTreatment::PIN: {
+        const int n_pin = pin_cell_.size();
+        if (fine_is_pin_) {
+#pragma omp parallel for
+            for (int i = 0; i < n_pin; i++) {
+                for (int ig = 0; ig < ng; ig++) {
+                    coarse(i, ig) = fine(i, ig);
+                }
+            }
+        } else {
+            // Each PIN cell takes the value of the PIN_PLANE cell that
+            // contains it. Rather than building the PIN_PLANE result, apply
+            // the corresponding row directly.
+#pragma omp parallel for
+            for (int i = 0; i < n_pin; i++) {
+                const int c = pin_cell_[i];
+                for (int ig = 0; ig < ng; ig++) {
+                    coarse(i, ig) = 0.0;
+                }
+                for (int k = row_[c]; k < row_[c + 1]; k++) {
+                    const int j    = col_[k];
+                    const real_t w = wt_[k];
+                    for (int ig = 0; ig < ng; ig++) {
+                        coarse(i, ig) += w * fine(j, ig);
+                    }
+                }
+            }
+        }
+    } break;
+
+    default:
+        throw EXCEPT("Unsupported mesh treatment for pin projection");
+    }
+
+    return;
+}
+
+void PinProjection::homogenize(const ArrayB2 &fine, int group,
+                               ArrayB1 &coarse, MeshTreatment treatment) const
+{
+    assert(!this->empty());
+    assert(fine.extent(0) == n_fine_);
+
+    switch (treatment) {
+    case MeshTreatment::PIN_PLANE:
+        assert((int)coarse.size() == n_cell_);
+#pragma omp parallel for
+        for (int c = 0; c < n_cell_; c++) {
+            real_t v = 0.0;
+            for (int k = row_[c]; k < row_[c + 1]; k++) {
+                v += wt_[k] * fine(col_[k], group);
+            }
+            coarse(c) = v;
+        }
+        break;
+
+    case MeshTreatment::PIN: {
+        const int n_pin = pin_cell_.size();
+        assert((int)coarse.size() == n_pin);
+#pragma omp parallel for
+        for (int i = 0; i < n_pin; i++) {
+            if (fine_is_pin_) {
+                coarse(i) = fine(i, group);
+            } else {
+                const int c = pin_cell_[i];
+                real_t v    = 0.0;
+                for (int k = row_[c]; k < row_[c + 1]; k++) {
+                    v += wt_[k] * fine(col_[k], group);
+                }
+                coarse(i) = v;
+            }
+        }
+    } break;
+
+    default:
+        throw EXCEPT("Unsupported mesh treatment for pin projection");
+    }
+
+    return;
+}
+
+real_t PinProjection::prolong(const ArrayB1 &target, ArrayB2 &fine,
+                              int group) const
+{
+    assert(!this->empty());
+    assert((int)target.size() == n_cell_);
+    assert(fine.extent(0) == n_fine_);
+
+    real_t resid = 0.0;
+#pragma omp parallel for reduction(+ : resid)
+    for (int c = 0; c < n_cell_; c++) {
+        real_t v = 0.0;
+        for (int k = row_[c]; k < row_[c + 1]; k++) {
+            v += wt_[k] * fine(col_[k], group);
+        }
+        const real_t e = target(c) - v;
+        const real_t f = target(c) / v;
+        for (int k = row_[c]; k < row_[c + 1]; k++) {
+            fine(col_[k], group) *= f;
+        }
+        resid += e * e;
+    }
+
+    return resid;
+}
+
+void PinProjection::collapse_axial(const ArrayB1 &pin,
+                                   ArrayB1 &pin_plane) const
+{
+    assert(!this->empty());
+    assert(pin.size() == pin_cell_.size());
+    assert((int)pin_plane.size() == n_cell_);
+
+#pragma omp parallel for
+    for (int c = 0; c < n_cell_; c++) {
+        real_t v = 0.0;
+        for (int k = axial_row_[c]; k < axial_row_[c + 1]; k++) {
+            v += axial_wt_[k] * pin(axial_col_[k]);
+        }
+        pin_plane(c) = v;
+    }
+
+    return;
+}
+}
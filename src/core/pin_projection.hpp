@@ -0,0 +1,141 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "util/blitz_typedefs.hpp"
+#include "util/global_config.hpp"
+#include "core/core_mesh.hpp"
+
+namespace mocc {
+/**
+ * \brief Precomputed operators for homogenizing quantities on a sweeper mesh
+ * to the pin meshes, and for projecting pin-mesh quantities back.
+ *
+ * A sweeper mesh, using either the \ref MeshTreatment::PLANE or \ref
+ * MeshTreatment::PIN treatment, is mapped to the \ref MeshTreatment::PIN_PLANE
+ * mesh through a compressed sparse row (CSR) operator, where each row
+ * contains the sweeper regions in a coarse cell, along with their volume
+ * fractions. Since each sweeper region belongs to exactly one coarse cell,
+ * the same operator serves to scale the sweeper quantities to match a
+ * coarse-mesh solution. Homogenization to the \ref MeshTreatment::PIN mesh is
+ * performed through the \ref MeshTreatment::PIN_PLANE result, or is the
+ * identity for a \ref MeshTreatment::PIN sweeper mesh. An axial operator,
+ * which collapses \ref MeshTreatment::PIN quantities to the \ref
+ * MeshTreatment::PIN_PLANE mesh, is also provided.
+ *
+ * All of the multi-group operations treat every group in a single pass, and
+ * are threaded over the coarse cells. None of them allocate.
+ */
+class PinProjection {
+public:
+    /**
+     * \brief Construct an empty projection, which may not be applied.
+     */
+    PinProjection() : n_fine_(0), n_cell_(0), fine_is_pin_(false)
+    {
+        return;
+    }
+
+    /**
+     * \brief Construct the projection operators for the passed mesh.
+     *
+     * \param mesh the \ref CoreMesh
+     * \param treatment the \ref MeshTreatment of the sweeper mesh. Must be
+     * either \ref MeshTreatment::PLANE or \ref MeshTreatment::PIN.
+     * \param vol the volumes of the sweeper mesh regions
+     */
+    PinProjection(const CoreMesh &mesh, MeshTreatment treatment,
+                  const VecF &vol);
+
+    /**
+     * \brief Return whether the operators have been constructed
+     */
+    bool empty() const
+    {
+        return n_fine_ == 0;
+    }
+
+    /**
+     * \brief Homogenize a multi-group quantity on the sweeper mesh to the
+     * passed coarse \ref MeshTreatment, for all groups.
+     *
+     * \param fine the quantity on the sweeper mesh, indexed (region, group)
+     * \param coarse storage for the result, which must already be sized to
+     * the number of coarse regions by the number of groups
+     * \param treatment the coarse mesh treatment. Either \ref
+     * MeshTreatment::PIN or \ref MeshTreatment::PIN_PLANE.
+     */
+    void homogenize(const ArrayB2 &fine, ArrayB2 &coarse,
+                    MeshTreatment treatment) const;
+
+    /**
+     * \brief Homogenize a single group of a multi-group quantity on the
+     * sweeper mesh to the passed coarse \ref MeshTreatment.
+     */
+    void homogenize(const ArrayB2 &fine, int group, ArrayB1 &coarse,
+                    MeshTreatment treatment) const;
+
+    /**
+     * \brief Scale a single group of a quantity on the sweeper mesh so that
+     * its \ref MeshTreatment::PIN_PLANE homogenization matches \p target.
+     *
+     * \returns the sum of the squared differences between \p target and the
+     * homogenized quantity before scaling.
+     */
+    real_t prolong(const ArrayB1 &target, ArrayB2 &fine, int group) const;
+
+    /**
+     * \brief Return the \ref MeshTreatment::PIN_PLANE cell containing each
+     * sweeper region.
+     */
+    const VecI &fine_cell() const
+    {
+        return fine_cell_;
+    }
+
+    /**
+     * \brief Collapse a \ref MeshTreatment::PIN quantity axially to the \ref
+     * MeshTreatment::PIN_PLANE mesh, weighting by plane height.
+     */
+    void collapse_axial(const ArrayB1 &pin, ArrayB1 &pin_plane) const;
+
+private:
+    // Compressed sparse row operator from the sweeper mesh to the PIN_PLANE
+    // mesh.
+    VecI row_;
+    VecI col_;
+    VecF wt_;
+
+    // Axial operator from the PIN mesh to the PIN_PLANE mesh
+    VecI axial_row_;
+    VecI axial_col_;
+    VecF axial_wt_;
+
+    // PIN_PLANE cell containing each sweeper region
+    VecI fine_cell_;
+
+    // PIN_PLANE cell containing each PIN cell
+    VecI pin_cell_;
+
+    int n_fine_;
+    int n_cell_;
+
+    // Whether the sweeper mesh is the PIN mesh, in which case homogenization
+    // to the PIN mesh is the identity
+    bool fine_is_pin_;
+};
+}
@@ -106,20 +106,46 @@ ScatteringMatrix::ScatteringMatrix(const ArrayB2 &scat)
     }
 
     scat_.reserve(size);
+    in_scat_.reserve(size);
+    self_scat_.reserve(ng_);
 
-    int to  = 0;
-    int pos = 0;
+    int to = 0;
     for (auto &these_bounds : bounds) {
         for (int from = these_bounds.first; from <= these_bounds.second;
              from++) {
             scat_.push_back(scat(to, from));
+            in_scat_.push_back(from == to ? 0.0 : scat(to, from));
             out_[from] += scat(to, from);
         }
-        rows_.push_back(ScatteringRow(these_bounds.first, these_bounds.second,
-                                      &scat_[pos]));
+        self_scat_.push_back(scat(to, to));
         to++;
-        pos += these_bounds.second - these_bounds.first + 1;
     }
+
+    std::vector<ScatteringRow> rows;
+    rows.reserve(ng_);
+    for (auto &these_bounds : bounds) {
+        rows.push_back(
+            ScatteringRow(these_bounds.first, these_bounds.second, nullptr));
+    }
+    this->link_rows(rows);
+}
+
+void ScatteringMatrix::link_rows(const std::vector<ScatteringRow> &bounds)
+{
+    assert(&bounds != &rows_);
+    rows_.clear();
+    in_rows_.clear();
+    rows_.reserve(bounds.size());
+    in_rows_.reserve(bounds.size());
+
+    int pos = 0;
+    for (const auto &row : bounds) {
+        rows_.push_back(ScatteringRow(row.min_g, row.max_g, &scat_[pos]));
+        in_rows_.push_back(
+            ScatteringRow(row.min_g, row.max_g, &in_scat_[pos]));
+        pos += row.max_g - row.min_g + 1;
+    }
+    return;
 }
 
 std::ostream &operator<<(std::ostream &os, const ScatteringMatrix &scat_mat)
@@ -112,16 +112,16 @@ public:
      * the scattering rows.
      */
     ScatteringMatrix(const ScatteringMatrix &other)
-        : ng_(other.ng_), scat_(other.scat_), out_(other.out_)
+        : ng_(other.ng_),
+          scat_(other.scat_),
+          in_scat_(other.in_scat_),
+          self_scat_(other.self_scat_),
+          out_(other.out_)
     {
         // Pretty much everything can copy straight over, but we need to
         // reach into the scattering rows and update their pointers to the
         // location of the new scat_ vector
-        int pos = 0;
-        for (auto &row : other) {
-            rows_.push_back(ScatteringRow(row.min_g, row.max_g, &scat_[pos]));
-            pos += row.max_g - row.min_g + 1;
-        }
+        this->link_rows(other.rows_);
 
         return;
     }
@@ -129,17 +129,12 @@ public:
     ScatteringMatrix &operator=(const ScatteringMatrix &rhs)
     {
         if (this != &rhs) {
-            ng_   = rhs.ng_;
-            scat_ = rhs.scat_;
-            out_  = rhs.out_;
-            rows_.clear();
-
-            int pos = 0;
-            for (auto &row : rhs) {
-                rows_.push_back(
-                    ScatteringRow(row.min_g, row.max_g, &scat_[pos]));
-                pos += row.max_g - row.min_g + 1;
-            }
+            ng_        = rhs.ng_;
+            scat_      = rhs.scat_;
+            in_scat_   = rhs.in_scat_;
+            self_scat_ = rhs.self_scat_;
+            out_       = rhs.out_;
+            this->link_rows(rhs.rows_);
         }
         return *this;
     }
@@ -150,13 +145,27 @@ public:
         return rows_[ig];
     }
 
+    /**
+     * \brief Return the scattering row into group \p ig, with the
+     * self-scattering entry set to zero.
+     *
+     * The row has the same bounds as that returned by \ref to(), so that the
+     * in-scattering source from all other groups may be formed from a dense
+     * product over the band, without having to branch around self-scatter.
+     */
+    const ScatteringRow &in_scat(int ig) const
+    {
+        assert((ig >= 0) && (ig < int(in_rows_.size())));
+        return in_rows_[ig];
+    }
+
     /**
      * \brief Return the self-scattering cross section for the indicated
      * group.
      */
     real_t self_scat(int group) const
     {
-        return rows_[group][group];
+        return self_scat_[group];
     }
 
     /**
@@ -264,11 +273,22 @@ public:
                                     const ScatteringMatrix &scat_mat);
 
 private:
+    /**
+     * \brief Point the scattering rows into \c scat_ and \c in_scat_, using
+     * the group bounds of the passed rows.
+     */
+    void link_rows(const std::vector<ScatteringRow> &bounds);
+
     int ng_;
     // Densified scattering cross sections
     VecF scat_;
+    // Densified scattering cross sections, without self-scatter
+    VecF in_scat_;
+    // Self-scattering cross sections
+    VecF self_scat_;
     // Group-wise outscatter cross sections
     VecF out_;
     std::vector<ScatteringRow> rows_;
+    std::vector<ScatteringRow> in_rows_;
 };
 }
@@ -55,6 +55,16 @@ public:
         return nullptr;
     }
 
+    /**
+    * Return whether the solver responds to \ref global::interrupted by
+    * writing a checkpoint and returning from solve(). If not, the driver
+    * bails immediately when interrupted.
+    */
+    virtual bool handles_interrupt() const
+    {
+        return false;
+    }
+
 private:
 };
 
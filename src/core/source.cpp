@@ -28,6 +28,7 @@ Source::Source(int nreg, const XSMesh *xs_mesh, const ArrayB2 &flux)
       n_group_(xs_mesh->n_group()),
       n_reg_(flux.size() / n_group_),
       has_external_(false),
+      check_negative_(false),
       source_1g_(nreg),
       flux_(flux)
 {
@@ -81,33 +82,85 @@ void Source::fission(const ArrayB1 &fs, int ig)
 /**
  * \brief Compute the contribution to the source from inscattering from
  * other groups.
+ *
+ * The flux is stored region-major, so the flux of all groups in the
+ * scattering band of a region is contiguous. For each XS mesh region, the
+ * source is then a dense product of the regions' banded flux with the
+ * in-scatter row, which has self-scatter zeroed out so that no branching is
+ * needed.
  */
 void Source::in_scatter(size_t ig)
 {
     assert(!state_.has_inscatter);
     assert(!state_.is_scaled);
-    for (auto &xsr : *xs_mesh_) {
-        if (xsr.reg().size() == 0) {
-            continue;
+    assert(flux_.stride(1) == 1);
+
+    const real_t *flux = flux_.data();
+    const int stride   = flux_.stride(0);
+#pragma omp parallel default(shared)
+    {
+        for (auto &xsr : *xs_mesh_) {
+            const ScatteringRow &scat_row = xsr.xsmacsc().in_scat(ig);
+            const real_t *sc              = scat_row.from;
+            const int min_g               = scat_row.min_g;
+            const int n_band              = scat_row.max_g - min_g + 1;
+            const auto &reg               = xsr.reg();
+            const int n_reg               = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg          = reg[i];
+                const real_t *flux_band = flux + ireg * stride + min_g;
+                real_t scat_src         = 0.0;
+                for (int igg = 0; igg < n_band; igg++) {
+                    scat_src += sc[igg] * flux_band[igg];
+                }
+                source_1g_[ireg] += scat_src;
+            }
         }
-        const ScatteringRow &scat_row = xsr.xsmacsc().to(ig);
-        size_t min_g                  = scat_row.min_g;
-        int igg                       = min_g;
-        for (auto sc : scat_row) {
-            // Dont add a contribution for self-scatter. It might be a
-            // good idea to remove self-scatter from the scattering matrix
-            // and store it separately. May also benefit the self-scatter
-            // routine to have less indirection.
-            if (igg != (int)ig) {
-                for (auto &ireg : xsr.reg()) {
-                    real_t scat_src = sc * flux_((int)ireg, igg);
-                    source_1g_[ireg] += scat_src;
+    }
+
+    return;
+}
+
+void Source::group_source(int ig, const ArrayB1 *fs)
+{
+    assert(!fs || ((int)fs->size() == n_reg_));
+    assert(flux_.stride(1) == 1);
+
+    const real_t *flux = flux_.data();
+    const int stride   = flux_.stride(0);
+#pragma omp parallel default(shared)
+    {
+        for (auto &xsr : *xs_mesh_) {
+            const ScatteringRow &scat_row = xsr.xsmacsc().in_scat(ig);
+            const real_t *sc              = scat_row.from;
+            const int min_g               = scat_row.min_g;
+            const int n_band              = scat_row.max_g - min_g + 1;
+            const real_t xsch             = fs ? xsr.xsmacch(ig) : 0.0;
+            const auto &reg               = xsr.reg();
+            const int n_reg               = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg = reg[i];
+                real_t src     = 0.0;
+                if (has_external_) {
+                    src = external_source_(ireg, ig);
                 }
+                if (fs) {
+                    src += xsch * (*fs)(ireg);
+                }
+                const real_t *flux_band = flux + ireg * stride + min_g;
+                for (int igg = 0; igg < n_band; igg++) {
+                    src += sc[igg] * flux_band[igg];
+                }
+                source_1g_[ireg] = src;
             }
-            igg++;
         }
     }
 
+    state_.reset();
+    state_.has_fission   = fs != nullptr;
+    state_.has_inscatter = true;
     return;
 }
 
@@ -75,6 +75,19 @@ public:
      */
     virtual void in_scatter(size_t ig);
 
+    /**
+     * \brief Form the source for a group from the external, fission and
+     * in-scattering contributions in a single pass over the regions.
+     *
+     * \param ig the group
+     * \param fs the group-independent fission source, or \c nullptr to omit
+     * the fission contribution
+     *
+     * This is equivalent to calling \ref initialize_group(), \ref fission()
+     * (if \p fs is provided) and \ref in_scatter() in turn.
+     */
+    virtual void group_source(int ig, const ArrayB1 *fs);
+
     /**
      * \brief Add a one-group auxiliary source
      *
@@ -109,6 +122,15 @@ public:
      */
     void add_external(const pugi::xml_node &input);
 
+    /**
+     * \brief Set whether to check the transport source for negative values
+     * each time it is formed.
+     */
+    virtual void set_check_negative(bool check)
+    {
+        check_negative_ = check;
+    }
+
     /**
      * \brief Scale the source by some weighting values.
      *
@@ -197,6 +219,9 @@ protected:
     // The external source, if set
     ArrayB2 external_source_;
 
+    // Whether to look for negative values in the transport source
+    bool check_negative_;
+
     // Single-group source. We use the Eigen storage class so that it can be
     // used directly as a source vector in a linear system.
     VectorX source_1g_;
@@ -65,6 +65,9 @@ UP_Source_t SourceFactory(const pugi::xml_node &input, int n_reg,
     // Apply an external source if its specified
     source->add_external(input);
 
+    source->set_check_negative(
+        input.attribute("check_negative").as_bool(false));
+
     return source;
 }
 } // namespace mocc
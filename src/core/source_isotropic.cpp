@@ -14,43 +14,41 @@
    limitations under the License.
 */
 
+#include "util/files.hpp"
 #include "core/source.hpp"
 #include "core/source_isotropic.hpp"
 
 namespace mocc {
 void SourceIsotropic::self_scatter(size_t ig, const ArrayB1 &xstr)
 {
-    // Take a slice reference for this group's flux
-    const ArrayB1 flux_1g = flux_(blitz::Range::all(), ig);
-    if (xstr.size() > 0) {
+    // Index the flux directly, rather than through a slice, so that
+    // different groups may be treated concurrently. The self-scatter, the
+    // scaling and the negative check are all done in the same pass.
+    const bool use_xstr = xstr.size() > 0;
+    int n_negative      = 0;
+#pragma omp parallel default(shared) reduction(+ : n_negative)
+    {
         for (auto &xsr : *xs_mesh_) {
-            const ScatteringRow &scat_row = xsr.xsmacsc().to(ig);
-            real_t xssc                   = scat_row[ig];
-            real_t r_fpi_tr               = 1.0 / (xsr.xsmactr(ig) * FPI);
-            for (const int ireg : xsr.reg()) {
-                q_[ireg] = (source_1g_[ireg] + flux_1g(ireg) * xssc) * r_fpi_tr;
-            }
-        }
-    } else {
-        real_t r_fpi = 1.0 / (FPI);
-        for (auto &xsr : *xs_mesh_) {
-            const ScatteringRow &scat_row = xsr.xsmacsc().to(ig);
-            real_t xssc                   = scat_row[ig];
-            for (const int ireg : xsr.reg()) {
-                q_[ireg] = (source_1g_[ireg] + flux_1g(ireg) * xssc) * r_fpi;
+            const real_t xssc  = xsr.xsmacsc().self_scat(ig);
+            const real_t scale = use_xstr ? 1.0 / (xsr.xsmactr(ig) * FPI)
+                                          : 1.0 / FPI;
+            const auto &reg    = xsr.reg();
+            const int n_reg    = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg = reg[i];
+                q_[ireg] =
+                    (source_1g_[ireg] + flux_(ireg, (int)ig) * xssc) * scale;
+                if (check_negative_ && (q_[ireg] < 0.0)) {
+                    n_negative++;
+                }
             }
         }
     }
 
-    // Check to make sure that the source is positive
-    bool any = false;
-    for (int i = 0; i < q_.size(); i++) {
-        if (q_[i] < 0.0) {
-            any = true;
-        }
-    }
-    if (any) {
-        //  throw EXCEPT("Negative source!");
+    if (n_negative > 0) {
+        LogFile << "Negative source in " << n_negative << " regions of group "
+                << ig << std::endl;
     }
 
     return;
@@ -0,0 +1,110 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include "core/anderson_mixer.hpp"
+
+using namespace mocc;
+
+namespace {
+// A slowly-converging linear fixed-point map, G(x) = Ax + b
+struct LinearMap {
+    LinearMap(int n) : a(n, n), b(n)
+    {
+        a = MatrixX::Zero(n, n);
+        for (int i = 0; i < n; i++) {
+            a(i, i) = 0.95 - 0.5 * i / n;
+            if (i > 0) {
+                a(i, i - 1) = 0.02;
+            }
+            b[i] = 1.0 + 0.1 * i;
+        }
+        MatrixX eye = MatrixX::Identity(n, n);
+        solution    = (eye - a).colPivHouseholderQr().solve(b);
+    }
+
+    VectorX operator()(const VectorX &x) const
+    {
+        return a * x + b;
+    }
+
+    MatrixX a;
+    VectorX b;
+    VectorX solution;
+};
+
+int iterate(const LinearMap &map, AndersonMixer *mixer)
+{
+    VectorX x = VectorX::Zero(map.b.size());
+    for (int i = 0; i < 2000; i++) {
+        VectorX g = map(x);
+        x         = mixer ? mixer->mix(g) : g;
+        if ((x - map.solution).norm() < 1.0e-10 * map.solution.norm()) {
+            return i + 1;
+        }
+    }
+    return 2000;
+}
+}
+
+TEST(testAndersonConvergence)
+{
+    LinearMap map(20);
+
+    int n_plain = iterate(map, nullptr);
+
+    AndersonMixer mixer(5);
+    int n_anderson = iterate(map, &mixer);
+
+    CHECK(n_plain > 300);
+    CHECK(n_anderson < n_plain / 5);
+    CHECK_EQUAL(5, mixer.history());
+}
+
+TEST(testAndersonRestart)
+{
+    AndersonMixer mixer(3, 1.0, 2.0);
+    VectorX g(2);
+
+    g << 1.0, 1.0;
+    mixer.mix(g);
+    g << 1.5, 1.0;
+    mixer.mix(g);
+    g << 1.6, 1.1;
+    mixer.mix(g);
+    CHECK_EQUAL(1, mixer.history());
+    CHECK_EQUAL(0, mixer.n_restart());
+
+    // A large jump in the residual should clear the history and fall back
+    // to the plain update
+    g << 100.0, -50.0;
+    VectorX x = mixer.mix(g);
+    CHECK_EQUAL(0, mixer.history());
+    CHECK_EQUAL(1, mixer.n_restart());
+    CHECK_CLOSE(100.0, x[0], 1.0e-12);
+    CHECK_CLOSE(-50.0, x[1], 1.0e-12);
+
+    mixer.reset();
+    g << 2.0, 3.0;
+    x = mixer.mix(g);
+    CHECK_CLOSE(2.0, x[0], 1.0e-12);
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
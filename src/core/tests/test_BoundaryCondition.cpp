@@ -18,6 +18,7 @@
 
 #include "pugixml.hpp"
 
+#include "util/h5file.hpp"
 #include "angular_quadrature.hpp"
 #include "boundary_condition.hpp"
 
@@ -132,6 +133,46 @@ TEST_FIXTURE(BCIrregularFixture, test_bc)
     std::cout << in << std::endl;
 }
 
+TEST_FIXTURE(BCIrregularFixture, test_bc_checkpoint)
+{
+    ArrayB1 spectrum(2);
+    spectrum(0) = 2.2222;
+    spectrum(1) = 4.4444;
+    in.initialize_spectrum(spectrum);
+    auto face = in.get_face(1, 3, Normal::Y_NORM);
+    for (int ibc = 0; ibc < face.first; ibc++) {
+        face.second[ibc] = 0.5 * ibc;
+    }
+
+    {
+        H5Node h5f("bc_checkpoint.h5", H5Access::WRITE);
+        in.checkpoint(h5f, "bc");
+    }
+
+    BoundaryCondition restarted(in);
+    restarted.initialize_scalar(0.0);
+    {
+        H5Node h5f("bc_checkpoint.h5", H5Access::READ);
+        restarted.restart(h5f, "bc");
+
+        // The dataset must match the size of the boundary condition
+        CHECK_THROW(out.restart(h5f, "bc"), Exception);
+    }
+
+    for (int ig = 0; ig < ngroup; ig++) {
+        for (int ia = 0; ia < nang; ia++) {
+            for (auto norm : {Normal::X_NORM, Normal::Y_NORM}) {
+                auto a = in.get_face(ig, ia, norm);
+                auto b = restarted.get_face(ig, ia, norm);
+                CHECK_EQUAL(a.first, b.first);
+                for (int ibc = 0; ibc < a.first; ibc++) {
+                    CHECK_EQUAL(a.second[ibc], b.second[ibc]);
+                }
+            }
+        }
+    }
+}
+
 int main()
 {
     return UnitTest::RunAllTests();
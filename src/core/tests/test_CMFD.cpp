@@ -16,12 +16,15 @@
 
 #include "UnitTest++/UnitTest++.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include "pugixml.hpp"
 
 #include "core/tests/pugi_utils.hpp"
 
+#include "util/h5file.hpp"
 #include "core/cmfd.hpp"
 #include "core/xs_mesh_homogenized.hpp"
 
@@ -50,6 +53,245 @@ TEST(testCMFD)
     std::cout << k << std::endl;
 }
 
+/**
+ * Repeated few-group CMFD solves should converge to the same eigenvalue as the
+ * full multigroup system, since the condensation preserves the multigroup
+ * solution at convergence.
+ */
+TEST(testCMFDFewGroup)
+{
+    auto mesh_xml = inline_xml_file("3x5.xml");
+    CoreMesh mesh(*mesh_xml);
+
+    auto mg_xml = inline_xml("<cmfd k_tol=\"1e-10\" "
+                             "psi_tol=\"1e-8\" "
+                             "max_iter=\"500\" />");
+    auto fg_xml = inline_xml("<cmfd k_tol=\"1e-10\" "
+                             "psi_tol=\"1e-8\" "
+                             "max_iter=\"500\" "
+                             "few_group=\"3 7\" "
+                             "smooth=\"t\" />");
+
+    std::shared_ptr<XSMeshHomogenized> xsmesh(
+        std::make_shared<XSMeshHomogenized>(mesh));
+
+    CMFD cmfd_mg(mg_xml->child("cmfd"), &mesh, xsmesh);
+    CMFD cmfd_fg(fg_xml->child("cmfd"), &mesh, xsmesh);
+
+    real_t k_mg = 1.0;
+    cmfd_mg.solve(k_mg);
+
+    real_t k_fg = 1.0;
+    for (int i = 0; i < 20; i++) {
+        cmfd_fg.solve(k_fg);
+    }
+
+    CHECK_CLOSE(k_mg, k_fg, 1.0e-5);
+}
+
+/**
+ * Given coarse data that is consistent with a converged coarse solution, the
+ * pCMFD and net-current formulations should both reproduce that solution, even
+ * though their D-hats differ. The consistent data is generated by a pCMFD solve
+ * from perturbed transport currents, so that the partial-current D-hats are
+ * non-trivial.
+ */
+TEST(testCMFDPartial)
+{
+    auto mesh_xml = inline_xml_file("3x5.xml");
+    CoreMesh mesh(*mesh_xml);
+
+    auto net_xml = inline_xml("<cmfd k_tol=\"1e-12\" "
+                              "psi_tol=\"1e-10\" "
+                              "max_iter=\"1000\" />");
+    auto p_xml = inline_xml("<cmfd k_tol=\"1e-12\" "
+                            "psi_tol=\"1e-10\" "
+                            "max_iter=\"1000\" "
+                            "pcmfd=\"t\" />");
+
+    std::shared_ptr<XSMeshHomogenized> xsmesh(
+        std::make_shared<XSMeshHomogenized>(mesh));
+
+    // Plain diffusion solution, as a starting point for the currents
+    CMFD cmfd_diff(net_xml->child("cmfd"), &mesh, xsmesh);
+    real_t k_diff = 1.0;
+    cmfd_diff.solve(k_diff);
+    const CoarseData &diff_data = cmfd_diff.coarse_data();
+
+    auto load_data = [&](CoarseData &data, const CoarseData &from) {
+        data.current      = from.current;
+        data.surface_flux = from.surface_flux;
+        data.flux         = from.flux;
+        data.set_has_radial_data(true);
+        data.set_has_axial_data(true);
+    };
+
+    // Perturb the net currents and surface fluxes, which are no longer
+    // consistent with the flux, and converge pCMFD on them. The currents and
+    // surface fluxes that it stores are consistent with its solution.
+    CMFD cmfd_gen(p_xml->child("cmfd"), &mesh, xsmesh);
+    load_data(cmfd_gen.coarse_data(), diff_data);
+    cmfd_gen.coarse_data().current *= 1.1;
+    cmfd_gen.coarse_data().surface_flux *= 0.9;
+    real_t k_gen = k_diff;
+    cmfd_gen.solve(k_gen);
+    const CoarseData &gen_data = cmfd_gen.coarse_data();
+
+    // The perturbation should actually have changed something
+    CHECK(std::abs(k_gen - k_diff) > 1.0e-6);
+
+    CMFD cmfd_net(net_xml->child("cmfd"), &mesh, xsmesh);
+    load_data(cmfd_net.coarse_data(), gen_data);
+    real_t k_net = k_gen;
+    cmfd_net.solve(k_net);
+
+    CMFD cmfd_p(p_xml->child("cmfd"), &mesh, xsmesh);
+    load_data(cmfd_p.coarse_data(), gen_data);
+    real_t k_p = k_gen;
+    cmfd_p.solve(k_p);
+
+    CHECK_CLOSE(k_gen, k_net, 1.0e-8);
+    CHECK_CLOSE(k_gen, k_p, 1.0e-8);
+    CHECK_CLOSE(k_net, k_p, 1.0e-8);
+
+    // The currents reconstructed from the pCMFD D-hats (d_hat, d_hat_m) and
+    // from the net-current D-hat should both match the currents they were
+    // computed from
+    const CoarseData &net_data = cmfd_net.coarse_data();
+    const CoarseData &p_data   = cmfd_p.coarse_data();
+    for (int is = 0; is < (int)mesh.n_surf(); is++) {
+        for (int ig = 0; ig < xsmesh->n_group(); ig++) {
+            real_t j   = gen_data.current(is, ig);
+            real_t tol = 1.0e-6 * std::max(std::abs(j), 1.0e-3);
+            CHECK_CLOSE(j, net_data.current(is, ig), tol);
+            CHECK_CLOSE(j, p_data.current(is, ig), tol);
+        }
+    }
+}
+
+/**
+ * The within-group correction is driven only by the change in the
+ * self-scattering source, so it should vanish when the flux has not changed
+ * over the inner iteration, and should move the flux back toward the
+ * converged solution when it has.
+ */
+TEST(testCMFDWithinGroup)
+{
+    auto mesh_xml = inline_xml_file("3x5.xml");
+    CoreMesh mesh(*mesh_xml);
+
+    auto cmfd_xml = inline_xml("<cmfd k_tol=\"1e-10\" "
+                               "psi_tol=\"1e-8\" "
+                               "max_iter=\"500\" "
+                               "residual_reduction=\"1e-8\" />");
+
+    std::shared_ptr<XSMeshHomogenized> xsmesh(
+        std::make_shared<XSMeshHomogenized>(mesh));
+
+    CMFD cmfd(cmfd_xml->child("cmfd"), &mesh, xsmesh);
+
+    real_t k = 1.0;
+    cmfd.solve(k);
+
+    int group = 6;
+    ArrayB1 flux_ref(cmfd.flux()(blitz::Range::all(), group).copy());
+
+    ArrayB1 flux(flux_ref.copy());
+    real_t e = cmfd.solve_within_group(group, flux_ref, flux);
+    CHECK_CLOSE(0.0, e, 1.0e-12);
+    for (int i = 0; i < (int)flux.size(); i++) {
+        CHECK_CLOSE(flux_ref(i), flux(i), 1.0e-12 * flux_ref(i));
+    }
+
+    // An increase in the self-scattering source over the inner iteration
+    // should produce a positive correction, since there are no transport
+    // currents and the diffusion operator is an M-matrix
+    ArrayB1 flux_old(flux_ref.copy());
+    flux_old *= 0.5;
+    flux = flux_ref * 0.75;
+    e    = cmfd.solve_within_group(group, flux_old, flux);
+    CHECK(e > 0.0);
+    for (int i = 0; i < (int)flux.size(); i++) {
+        CHECK(flux(i) > 0.75 * flux_ref(i));
+    }
+}
+
+/**
+ * A CMFD object restarted from a checkpoint should hold the same coarse data
+ * as the original, and its next solve should give a bitwise-identical
+ * eigenvalue.
+ */
+TEST(testCMFDCheckpoint)
+{
+    auto mesh_xml = inline_xml_file("3x5.xml");
+    CoreMesh mesh(*mesh_xml);
+
+    auto cmfd_xml = inline_xml("<cmfd k_tol=\"1e-10\" "
+                               "psi_tol=\"1e-8\" "
+                               "max_iter=\"500\" "
+                               "pcmfd=\"t\" />");
+
+    std::shared_ptr<XSMeshHomogenized> xsmesh(
+        std::make_shared<XSMeshHomogenized>(mesh));
+
+    CMFD cmfd(cmfd_xml->child("cmfd"), &mesh, xsmesh);
+
+    real_t k = 1.0;
+    cmfd.solve(k);
+
+    // Give the surface quantities distinct values, so that a transposed or
+    // truncated read would show up
+    CoarseData &data = cmfd.coarse_data();
+    for (int is = 0; is < (int)mesh.n_surf(); is++) {
+        for (int ig = 0; ig < xsmesh->n_group(); ig++) {
+            data.current(is, ig)             = 0.01 * is - 0.1 * ig;
+            data.surface_flux(is, ig)        = 1.0 + 0.01 * is + 0.1 * ig;
+            data.partial_current(is, ig)     = {{0.5 + is, 0.25 + ig}};
+            data.partial_current_old(is, ig) = {{0.75 + ig, 0.125 + is}};
+        }
+    }
+    data.set_has_old_partial(true);
+
+    {
+        H5Node h5f("cmfd_checkpoint.h5", H5Access::WRITE);
+        auto g = h5f.create_group("cmfd");
+        cmfd.checkpoint(g);
+    }
+
+    CMFD restarted(cmfd_xml->child("cmfd"), &mesh, xsmesh);
+    {
+        H5Node h5f("cmfd_checkpoint.h5", H5Access::READ);
+        auto g = h5f["cmfd"];
+        restarted.restart(g);
+    }
+
+    const CoarseData &data_r = restarted.coarse_data();
+    CHECK(data_r.has_old_partial());
+    CHECK_ARRAY_EQUAL(data.flux.data(), data_r.flux.data(),
+                      (int)data.flux.size());
+    CHECK_ARRAY_EQUAL(data.old_flux.data(), data_r.old_flux.data(),
+                      (int)data.old_flux.size());
+    CHECK_ARRAY_EQUAL(data.current.data(), data_r.current.data(),
+                      (int)data.current.size());
+    CHECK_ARRAY_EQUAL(data.surface_flux.data(), data_r.surface_flux.data(),
+                      (int)data.surface_flux.size());
+    for (int is = 0; is < (int)mesh.n_surf(); is++) {
+        for (int ig = 0; ig < xsmesh->n_group(); ig++) {
+            for (int i = 0; i < 2; i++) {
+                CHECK_EQUAL(data.partial_current(is, ig)[i],
+                            data_r.partial_current(is, ig)[i]);
+                CHECK_EQUAL(data.partial_current_old(is, ig)[i],
+                            data_r.partial_current_old(is, ig)[i]);
+            }
+        }
+    }
+
+    real_t k_r = k;
+    cmfd.solve(k);
+    restarted.solve(k_r);
+    CHECK_EQUAL(k, k_r);
+}
+
 int main()
 {
     return UnitTest::RunAllTests();
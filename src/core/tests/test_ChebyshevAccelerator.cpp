@@ -0,0 +1,78 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include "core/chebyshev_accelerator.hpp"
+
+using namespace mocc;
+
+namespace {
+// A slowly-converging linear fixed-point map, G(x) = Ax + b, where the
+// eigenvalues of A lie in [0, 0.95]
+struct LinearMap {
+    LinearMap(int n) : a(n), b(n)
+    {
+        for (int i = 0; i < n; i++) {
+            a[i] = 0.95 * (n - i) / n;
+            b[i] = 1.0 + 0.1 * i;
+        }
+        solution = b.array() / (1.0 - a.array());
+    }
+
+    VectorX operator()(const VectorX &x) const
+    {
+        return (a.array() * x.array()).matrix() + b;
+    }
+
+    VectorX a;
+    VectorX b;
+    VectorX solution;
+};
+
+int iterate(const LinearMap &map, ChebyshevAccelerator *cheb)
+{
+    VectorX x = VectorX::Zero(map.b.size());
+    for (int i = 0; i < 2000; i++) {
+        VectorX g = map(x);
+        x         = cheb ? cheb->extrapolate(g, (g - x).norm()) : g;
+        if ((x - map.solution).norm() < 1.0e-10 * map.solution.norm()) {
+            return i + 1;
+        }
+    }
+    return 2000;
+}
+}
+
+TEST(testChebyshevConvergence)
+{
+    LinearMap map(20);
+
+    int n_plain = iterate(map, nullptr);
+
+    ChebyshevAccelerator cheb(6, 5);
+    int n_cheb = iterate(map, &cheb);
+
+    CHECK(n_plain > 300);
+    CHECK(n_cheb < n_plain / 2);
+    CHECK(cheb.dominance_ratio() > 0.9);
+    CHECK(cheb.dominance_ratio() < 1.0);
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
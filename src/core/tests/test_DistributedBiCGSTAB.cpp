@@ -0,0 +1,98 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include <vector>
+
+#include <Eigen/SparseLU>
+
+#include "core/distributed_bicgstab.hpp"
+#include "core/parallel_environment.hpp"
+
+using namespace mocc;
+
+/**
+ * Solve a 7-point, diagonally-dominant system on a 5x4x6 mesh and compare
+ * against a direct solve. When run under MPI, each process owns some of the
+ * planes.
+ */
+TEST(testDistributedBiCGSTAB)
+{
+    int nx = 5;
+    int ny = 4;
+    int nz = 6;
+    int n  = nx * ny * nz;
+
+    std::vector<Eigen::Triplet<real_t>> triplets;
+    for (int iz = 0; iz < nz; iz++) {
+        for (int iy = 0; iy < ny; iy++) {
+            for (int ix = 0; ix < nx; ix++) {
+                int i = iz * nx * ny + iy * nx + ix;
+                triplets.push_back(
+                    Eigen::Triplet<real_t>(i, i, 6.5 + 0.1 * (i % 7)));
+                if (ix > 0) {
+                    triplets.push_back(Eigen::Triplet<real_t>(i, i - 1, -1.0));
+                }
+                if (ix < nx - 1) {
+                    triplets.push_back(Eigen::Triplet<real_t>(i, i + 1, -1.1));
+                }
+                if (iy > 0) {
+                    triplets.push_back(
+                        Eigen::Triplet<real_t>(i, i - nx, -0.9));
+                }
+                if (iy < ny - 1) {
+                    triplets.push_back(
+                        Eigen::Triplet<real_t>(i, i + nx, -1.0));
+                }
+                if (iz > 0) {
+                    triplets.push_back(
+                        Eigen::Triplet<real_t>(i, i - nx * ny, -0.8));
+                }
+                if (iz < nz - 1) {
+                    triplets.push_back(
+                        Eigen::Triplet<real_t>(i, i + nx * ny, -1.2));
+                }
+            }
+        }
+    }
+    Eigen::SparseMatrix<real_t> m(n, n);
+    m.setFromTriplets(triplets.begin(), triplets.end());
+
+    VectorX b(n);
+    for (int i = 0; i < n; i++) {
+        b[i] = 1.0 + (i % 5);
+    }
+
+    Eigen::SparseLU<Eigen::SparseMatrix<real_t>> lu(m);
+    VectorX ref = lu.solve(b);
+
+    DistributedBiCGSTAB solver(ParEnv.comm(), n, nx * ny);
+    solver.setTolerance(1.0e-12);
+    solver.compute(m);
+    VectorX x = solver.solveWithGuess(b, VectorX::Zero(n));
+
+    CHECK((x - ref).norm() / ref.norm() < 1.0e-10);
+    CHECK(solver.iterations() > 0);
+}
+
+int main(int argc, char *argv[])
+{
+    ParEnv.start(argc, argv);
+    int result = UnitTest::RunAllTests();
+    ParEnv.stop();
+    return result;
+}
@@ -0,0 +1,88 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include "core/gmres.hpp"
+
+using namespace mocc;
+
+namespace {
+// Build a non-symmetric, diagonally-dominant test matrix
+MatrixX test_matrix(int n)
+{
+    MatrixX a = MatrixX::Zero(n, n);
+    for (int i = 0; i < n; i++) {
+        a(i, i) = 4.0 + 0.1 * i;
+        if (i > 0) {
+            a(i, i - 1) = -1.5;
+        }
+        if (i < n - 1) {
+            a(i, i + 1) = -0.5;
+        }
+        a(i, (i * 7) % n) += 0.3;
+    }
+    return a;
+}
+}
+
+TEST(testGMRESFull)
+{
+    int n     = 30;
+    MatrixX a = test_matrix(n);
+    VectorX b(n);
+    for (int i = 0; i < n; i++) {
+        b[i] = 1.0 + (i % 4);
+    }
+    VectorX ref = a.colPivHouseholderQr().solve(b);
+
+    GMRES gmres(n, 1.0e-12);
+    GMRES::Operator op = [&](const VectorX &in, VectorX &out) {
+        out = a * in;
+    };
+
+    VectorX x   = VectorX::Zero(n);
+    int n_apply = gmres.solve(op, b, x);
+
+    CHECK(n_apply <= n);
+    CHECK(gmres.error() <= 1.0e-12);
+    CHECK((x - ref).norm() < 1.0e-10 * ref.norm());
+}
+
+TEST(testGMRESRestart)
+{
+    int n       = 30;
+    MatrixX a   = test_matrix(n);
+    VectorX b   = VectorX::Ones(n);
+    VectorX ref = a.colPivHouseholderQr().solve(b);
+
+    GMRES gmres(5, 1.0e-10, 50);
+    GMRES::Operator op = [&](const VectorX &in, VectorX &out) {
+        out = a * in;
+    };
+
+    // Start from a non-zero guess to exercise the initial residual
+    VectorX x = VectorX::Constant(n, 0.1);
+    gmres.solve(op, b, x);
+
+    CHECK(gmres.error() <= 1.0e-10);
+    CHECK((x - ref).norm() < 1.0e-8 * ref.norm());
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
@@ -19,9 +19,12 @@
 #include <cassert>
 #include <iostream>
 #include <string>
+#include "pugixml.hpp"
+#include "util/error.hpp"
 #include "util/file_scrubber.hpp"
 #include "util/fp_utils.hpp"
 #include "util/global_config.hpp"
+#include "util/h5file.hpp"
 #include "material.hpp"
 #include "material_lib.hpp"
 
@@ -54,6 +57,57 @@ TEST(material)
     CHECK_CLOSE(5.04050E-09, mat.xssc().to(3).from[0], 0.000000000001);
 }
 
+// Convert the text library to HDF5 and make sure that the materials come back
+// the same, and that only the referenced materials are loaded
+TEST(material_h5)
+{
+    {
+        FileScrubber c5g7_file("c5g7.xsl", "!");
+        MaterialLib matlib(c5g7_file);
+        H5Node h5f("c5g7.h5", H5Access::WRITE);
+        matlib.output(h5f);
+    }
+
+    FileScrubber c5g7_file("c5g7.xsl", "!");
+    MaterialLib reference(c5g7_file);
+    reference.assignID(1, "MOX-4.3");
+    reference.assignID(2, "Moderator");
+
+    pugi::xml_document doc;
+    doc.load_string("<material_lib path=\"c5g7.h5\">"
+                    "    <material id=\"1\" name=\"MOX-4.3\" />"
+                    "    <material id=\"2\" name=\"Moderator\" />"
+                    "</material_lib>");
+    MaterialLib matlib(doc.child("material_lib"));
+
+    CHECK_EQUAL(2, matlib.materials().size());
+    CHECK_EQUAL(2, matlib.n_materials());
+    CHECK_EQUAL(reference.n_group(), matlib.n_group());
+    for (int ig = 0; ig < matlib.n_group(); ig++) {
+        CHECK_EQUAL(reference.g_bounds()[ig], matlib.g_bounds()[ig]);
+    }
+
+    for (int id = 1; id <= 2; id++) {
+        const Material &ref = reference.get_material_by_id(id);
+        const Material &mat = matlib.get_material_by_id(id);
+        for (int ig = 0; ig < matlib.n_group(); ig++) {
+            CHECK_EQUAL(ref.xsab(ig), mat.xsab(ig));
+            CHECK_EQUAL(ref.xstr(ig), mat.xstr(ig));
+            CHECK_EQUAL(ref.xsnf(ig), mat.xsnf(ig));
+            CHECK_EQUAL(ref.xsf(ig), mat.xsf(ig));
+            CHECK_CLOSE(ref.xsch(ig), mat.xsch(ig), 0.000000000001);
+        }
+        CHECK(ref.xssc() == mat.xssc());
+    }
+
+    // Asking for a material that isnt in the library should fail
+    pugi::xml_document bad_doc;
+    bad_doc.load_string("<material_lib path=\"c5g7.h5\">"
+                        "    <material id=\"1\" name=\"Unobtainium\" />"
+                        "</material_lib>");
+    CHECK_THROW(MaterialLib bad(bad_doc.child("material_lib")), Exception);
+}
+
 int main(int, const char *[])
 {
     return UnitTest::RunAllTests();
@@ -0,0 +1,98 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include <iostream>
+#include "pugixml.hpp"
+#include "core/core_mesh.hpp"
+#include "core/pin_projection.hpp"
+
+#include "inputs.hpp"
+
+using namespace mocc;
+
+// Homogenize a fine-mesh flux, scale it to a target pin flux, and make sure
+// that the homogenized result matches the target
+TEST(plane_projection)
+{
+    pugi::xml_document geom_xml;
+    pugi::xml_parse_result result = geom_xml.load_string(complex_xml.c_str());
+    REQUIRE CHECK(result);
+
+    CoreMesh mesh(geom_xml);
+
+    const int ng     = 2;
+    const int n_fine = mesh.n_reg(MeshTreatment::PLANE);
+    const int n_cell = mesh.n_reg(MeshTreatment::PIN_PLANE);
+    const int n_pin  = mesh.n_reg(MeshTreatment::PIN);
+
+    PinProjection proj(mesh, MeshTreatment::PLANE,
+                       mesh.volumes(MeshTreatment::PLANE));
+    CHECK(!proj.empty());
+
+    ArrayB2 fine(n_fine, ng);
+    for (int i = 0; i < n_fine; i++) {
+        fine(i, 0) = 1.0;
+        fine(i, 1) = 1.0 + 0.001 * i;
+    }
+
+    // A flat flux should homogenize to a flat flux
+    ArrayB2 coarse(n_cell, ng);
+    proj.homogenize(fine, coarse, MeshTreatment::PIN_PLANE);
+    for (int c = 0; c < n_cell; c++) {
+        CHECK_CLOSE(1.0, coarse(c, 0), REAL_FUZZ);
+    }
+
+    // The single-group version should agree with the multi-group version
+    ArrayB1 coarse_1g(n_cell);
+    proj.homogenize(fine, 1, coarse_1g, MeshTreatment::PIN_PLANE);
+    for (int c = 0; c < n_cell; c++) {
+        CHECK_CLOSE(coarse(c, 1), coarse_1g(c), REAL_FUZZ);
+    }
+
+    // Every PIN cell should take the value of its PIN_PLANE cell
+    ArrayB2 pin(n_pin, ng);
+    proj.homogenize(fine, pin, MeshTreatment::PIN);
+    VecI pin_cell = mesh.coarse_cell_map(MeshTreatment::PIN);
+    for (int i = 0; i < n_pin; i++) {
+        CHECK_EQUAL(coarse(pin_cell[i], 1), pin(i, 1));
+    }
+
+    // Scale to a new shape and check that it comes back
+    ArrayB1 target(n_cell);
+    for (int c = 0; c < n_cell; c++) {
+        target(c) = 2.0 + 0.01 * c;
+    }
+    proj.prolong(target, fine, 1);
+    proj.homogenize(fine, 1, coarse_1g, MeshTreatment::PIN_PLANE);
+    for (int c = 0; c < n_cell; c++) {
+        CHECK_CLOSE(target(c), coarse_1g(c), 1.0e-12);
+    }
+
+    // Collapsing a flat PIN quantity should give a flat result
+    ArrayB1 pin_1g(n_pin);
+    pin_1g = 3.0;
+    proj.collapse_axial(pin_1g, coarse_1g);
+    for (int c = 0; c < n_cell; c++) {
+        CHECK_CLOSE(3.0, coarse_1g(c), 1.0e-12);
+    }
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
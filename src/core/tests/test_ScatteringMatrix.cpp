@@ -149,6 +149,30 @@ TEST(scat_matrix_ArrayB2)
     CHECK(scat_matrix_ref == scat_matrix);
 }
 
+TEST(scat_matrix_in_scat)
+{
+    ScatteringMatrix scat_matrix(sc);
+    ScatteringMatrix scat_matrix_copy(scat_matrix);
+
+    // The in-scatter rows have the same bounds as the full rows, with the
+    // self-scatter entry zeroed
+    for (const auto *m : {&scat_matrix, &scat_matrix_copy}) {
+        for (int ig = 0; ig < NG; ig++) {
+            const auto &row    = m->to(ig);
+            const auto &in_row = m->in_scat(ig);
+            CHECK(row == in_row);
+            for (int igg = row.min_g; igg <= row.max_g; igg++) {
+                real_t ref = (igg == ig) ? 0.0 : sc[ig][igg];
+                CHECK_CLOSE(ref, in_row[igg], 0.0000000000001);
+            }
+            CHECK_CLOSE(sc[ig][ig], m->self_scat(ig), 0.0000000000001);
+        }
+    }
+
+    // Make sure that the copy refers to its own data
+    CHECK(scat_matrix.in_scat(3).from != scat_matrix_copy.in_scat(3).from);
+}
+
 TEST(vecF_purely_absorbing)
 {
     ScatteringMatrix scat_matrix(sc3);
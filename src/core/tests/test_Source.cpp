@@ -0,0 +1,107 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include <cmath>
+#include "pugixml.hpp"
+#include "util/blitz_typedefs.hpp"
+#include "util/h5file.hpp"
+#include "core_mesh.hpp"
+#include "pugi_utils.hpp"
+#include "source_isotropic.hpp"
+#include "xs_mesh.hpp"
+
+using namespace mocc;
+
+namespace {
+// Compare the sources formed by group_source() against those from the
+// individual initialize_group(), fission() and in_scatter() calls, for all
+// groups
+void check_group_source(Source &reference, Source &fused, const ArrayB1 *fs,
+                        int n_group)
+{
+    int n_reg = reference.n_reg();
+    for (int ig = 0; ig < n_group; ig++) {
+        reference.initialize_group(ig);
+        if (fs) {
+            reference.fission(*fs, ig);
+        }
+        reference.in_scatter(ig);
+
+        fused.group_source(ig, fs);
+
+        for (int ireg = 0; ireg < n_reg; ireg++) {
+            real_t ref = reference[ireg];
+            CHECK_CLOSE(ref, fused[ireg], 1.0e-12 * std::abs(ref) + 1.0e-14);
+        }
+    }
+}
+}
+
+TEST(group_source)
+{
+    pugi::xml_document geom_xml;
+    pugi::xml_parse_result result = geom_xml.load_file("2x3_1.xml");
+    REQUIRE CHECK(result);
+
+    CoreMesh mesh(geom_xml);
+    XSMesh xs_mesh(mesh, MeshTreatment::PLANE);
+
+    int n_reg = xs_mesh.n_reg_expanded();
+    int ng    = xs_mesh.n_group();
+
+    // Make sure that the flux varies by region and group, so that any mixup
+    // in the indexing would show up
+    ArrayB2 flux(n_reg, ng);
+    ArrayB1 fs(n_reg);
+    for (int ireg = 0; ireg < n_reg; ireg++) {
+        for (int ig = 0; ig < ng; ig++) {
+            flux(ireg, ig) = 1.0 + 0.01 * ireg + 0.1 * ig;
+        }
+        fs(ireg) = 2.0 + std::sin(0.1 * ireg);
+    }
+
+    SourceIsotropic reference(n_reg, &xs_mesh, flux);
+    SourceIsotropic fused(n_reg, &xs_mesh, flux);
+
+    check_group_source(reference, fused, &fs, ng);
+    check_group_source(reference, fused, nullptr, ng);
+
+    // Add an external source and do it all again
+    ArrayB2 external(ng, n_reg);
+    for (int ig = 0; ig < ng; ig++) {
+        for (int ireg = 0; ireg < n_reg; ireg++) {
+            external(ig, ireg) = 0.5 + 0.02 * ireg + 0.3 * ig;
+        }
+    }
+    {
+        H5Node h5f("test_source.h5", H5Access::WRITE);
+        h5f.write("source", external);
+    }
+
+    auto source_xml = inline_xml("<source file=\"test_source.h5\" />");
+    reference.add_external(source_xml->child("source"));
+    fused.add_external(source_xml->child("source"));
+
+    check_group_source(reference, fused, &fs, ng);
+    check_group_source(reference, fused, nullptr, ng);
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
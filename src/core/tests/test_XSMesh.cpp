@@ -52,6 +52,60 @@ TEST(test)
     }
 }
 
+// Compact and dense expanded cross sections should agree, with and without
+// splitting
+TEST(expanded_compact)
+{
+    pugi::xml_document geom_xml;
+    pugi::xml_parse_result result = geom_xml.load_file("2x3_1.xml");
+    CHECK(result);
+
+    CoreMesh mesh(geom_xml);
+
+    XSMesh xs_mesh(mesh, MeshTreatment::PLANE);
+
+    ExpandedXS dense(&xs_mesh);
+    ExpandedXS compact(&xs_mesh, true, true);
+    CHECK(!dense.compact());
+    CHECK(compact.compact());
+    CHECK_EQUAL(dense.size(), compact.size());
+
+    // Instances sharing the compact data should always see the same cross
+    // sections
+    ExpandedXS shared(compact);
+    CHECK(shared.compact());
+
+    int n_reg = xs_mesh.n_reg_expanded();
+    ArrayB1 split(n_reg);
+    split = 0.0;
+    for (int i = 0; i < n_reg; i += 7) {
+        split(i) = 0.01 * (i % 3 + 1);
+    }
+
+    for (int ig = 0; ig < (int)xs_mesh.n_group(); ig++) {
+        dense.expand(ig);
+        compact.expand(ig);
+        for (int i = 0; i < n_reg; i++) {
+            CHECK_EQUAL(dense[i], compact[i]);
+        }
+
+        dense.expand(ig, split);
+        compact.expand(ig, split);
+        for (int i = 0; i < n_reg; i++) {
+            CHECK_EQUAL(dense[i], compact[i]);
+            CHECK_EQUAL(dense[i], shared[i]);
+        }
+    }
+
+    // Going back to an unsplit expansion should revert the split regions
+    compact.expand(0);
+    CHECK_EQUAL(xs_mesh[0].xsmactr(0), compact[xs_mesh[0].reg()[0]]);
+
+    // Compact storage that was not set up for splitting should refuse it
+    ExpandedXS no_split(&xs_mesh, true);
+    CHECK_THROW(no_split.expand(0, split), Exception);
+}
+
 int main()
 {
     return UnitTest::RunAllTests();
@@ -243,6 +243,52 @@ TEST(complicated)
     CHECK_CLOSE(1.9242061690222E-01, xs[icell], REAL_FUZZ);
 }
 
+// Make sure that the incremental update only touches the groups that have
+// been marked dirty, and that it agrees with a from-scratch homogenization
+TEST(incremental_update)
+{
+    pugi::xml_document geom_xml;
+    pugi::xml_parse_result result = geom_xml.load_file("2x3_1.xml");
+    REQUIRE CHECK(result);
+
+    CoreMesh mesh(geom_xml);
+
+    int n_reg = mesh.n_reg(MeshTreatment::PLANE);
+    int ng    = mesh.mat_lib().n_group();
+    ArrayB2 flux(n_reg, ng);
+    for (int ireg = 0; ireg < n_reg; ireg++) {
+        for (int ig = 0; ig < ng; ig++) {
+            flux(ireg, ig) = 1.0 + 0.01 * ireg + 0.1 * ig;
+        }
+    }
+
+    XSMeshHomogenized xs_mesh(mesh);
+    xs_mesh.set_flux(flux);
+    xs_mesh.update();
+    int state = xs_mesh.state();
+
+    // Nothing changed, so the state should stay put
+    xs_mesh.update();
+    CHECK_EQUAL(state, xs_mesh.state());
+
+    // Perturb a single group. Nothing happens until the group is marked.
+    for (int ireg = 0; ireg < n_reg; ireg++) {
+        flux(ireg, 1) *= 1.0 + 0.05 * (ireg % 3);
+    }
+    xs_mesh.update();
+    CHECK_EQUAL(state, xs_mesh.state());
+
+    xs_mesh.mark_dirty(1);
+    xs_mesh.update();
+    CHECK(xs_mesh.state() != state);
+
+    XSMeshHomogenized xs_reference(mesh);
+    xs_reference.set_flux(flux);
+    xs_reference.update();
+
+    CHECK(xs_mesh == xs_reference);
+}
+
 int main()
 {
     return UnitTest::RunAllTests();
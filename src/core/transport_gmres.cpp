@@ -0,0 +1,116 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "transport_gmres.hpp"
+
+#include <string>
+#include "pugixml.hpp"
+#include "util/error.hpp"
+#include "util/files.hpp"
+#include "util/string_utils.hpp"
+
+namespace {
+void copy_to(const mocc::ArrayB2 &flux, mocc::VectorX &x)
+{
+    int i = 0;
+    for (int ireg = 0; ireg < flux.extent(0); ireg++) {
+        for (int ig = 0; ig < flux.extent(1); ig++) {
+            x[i++] = flux(ireg, ig);
+        }
+    }
+    return;
+}
+
+void copy_from(const mocc::VectorX &x, mocc::ArrayB2 &flux)
+{
+    int i = 0;
+    for (int ireg = 0; ireg < flux.extent(0); ireg++) {
+        for (int ig = 0; ig < flux.extent(1); ig++) {
+            flux(ireg, ig) = x[i++];
+        }
+    }
+    return;
+}
+}
+
+namespace mocc {
+int TransportGMRES::solve(ArrayB2 flux, const std::function<void()> &sweep,
+                          TransportSweeper &sweeper)
+{
+    int n = flux.size();
+
+    VectorX x0(n);
+    VectorX h0(n);
+    copy_to(flux, x0);
+
+    // Evaluate H at the initial guess, which provides the initial residual
+    sweeper.push_state();
+    sweep();
+    int n_sweep = 1;
+    copy_to(flux, h0);
+
+    VectorX r0 = h0 - x0;
+
+    // Apply (I - K) to v. Since H is affine, Kv = (H(x0 + sv) - H(x0))/s for
+    // any s; choose it to keep x0 + sv on the scale of x0.
+    real_t x0_norm     = x0.norm();
+    GMRES::Operator op = [&](const VectorX &v, VectorX &av) {
+        real_t s  = (x0_norm > 0.0 ? x0_norm : 1.0) / v.norm();
+        VectorX x = x0 + s * v;
+        copy_from(x, flux);
+        sweeper.restore_state();
+        sweep();
+        n_sweep++;
+        copy_to(flux, x);
+        av = v - (x - h0) / s;
+    };
+
+    VectorX dx = VectorX::Zero(n);
+    gmres_.solve(op, r0, dx);
+
+    copy_from(x0 + dx, flux);
+    sweeper.restore_state();
+    sweeper.pop_state();
+
+    return n_sweep;
+}
+
+UP_TransportGMRES_t InnerGMRESFactory(const pugi::xml_node &input)
+{
+    std::string solver = input.attribute("inner_solver").value();
+    sanitize(solver);
+    if (solver.empty() || (solver == "si")) {
+        return UP_TransportGMRES_t();
+    }
+    if (solver != "gmres") {
+        throw EXCEPT("Unrecognized inner solver: " + solver);
+    }
+
+    int krylov = input.attribute("inner_krylov").as_int(10);
+    real_t tol = input.attribute("inner_tol").as_float(1.0e-4);
+    if (krylov < 1) {
+        throw EXCEPT("Invalid inner Krylov subspace size.");
+    }
+    if (tol <= 0.0) {
+        throw EXCEPT("Invalid inner GMRES tolerance.");
+    }
+
+    LogFile << "Using GMRES within-group iterations, Krylov size " << krylov
+            << ", tolerance " << tol << std::endl;
+
+    return UP_TransportGMRES_t(new TransportGMRES(krylov, tol));
+}
+}
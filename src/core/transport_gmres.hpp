@@ -0,0 +1,101 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "util/blitz_typedefs.hpp"
+#include "util/global_config.hpp"
+#include "util/pugifwd.hpp"
+#include "gmres.hpp"
+#include "transport_sweeper.hpp"
+
+namespace mocc {
+/**
+ * \brief Krylov acceleration of source iteration over one or more groups of
+ * a \ref TransportSweeper.
+ *
+ * Source iteration over a set of groups converges the fixed point phi =
+ * H(phi), where H is a sweep of the groups, driven by a scattering source
+ * computed from phi. With the starting state of the sweeper (e.g. the incoming
+ * boundary flux) held fixed, H is affine in phi, H(phi) = K phi + c, so the
+ * fixed point may be found instead by solving (I - K) phi = c with GMRES,
+ * where each Krylov vector costs one application of H. The state of the
+ * sweeper is pushed before the first application and restored before each
+ * subsequent one.
+ *
+ * Within a single group, H is one sweep with the self-scatter source; for
+ * the thermal upscatter block, H is a Gauss-Seidel sweep over the groups in
+ * the block.
+ */
+class TransportGMRES {
+public:
+    /**
+     * \brief Construct a TransportGMRES
+     *
+     * \param max_krylov the maximum Krylov subspace dimension
+     * \param tol the GMRES tolerance, relative to the initial residual
+     * \param max_restarts the maximum number of GMRES restarts
+     */
+    TransportGMRES(int max_krylov, real_t tol, int max_restarts = 0)
+        : gmres_(max_krylov, tol, max_restarts)
+    {
+    }
+
+    /**
+     * \brief Converge the flux for a set of groups
+     *
+     * \param flux a view into the scalar flux of \p sweeper for the groups of
+     * interest. On input this is the initial guess, and on output it is the
+     * converged flux.
+     * \param sweep a function that applies H to the flux in \p flux, in place
+     * \param sweeper the \ref TransportSweeper, used to save and restore its
+     * iteration state. On return, its state is as it was on input, so the
+     * caller should follow up with a regular sweep to update boundary
+     * conditions, currents, etc.
+     *
+     * \returns the number of applications of H
+     */
+    int solve(ArrayB2 flux, const std::function<void()> &sweep,
+              TransportSweeper &sweeper);
+
+    /**
+     * \brief Return the relative residual at the end of the last solve
+     */
+    real_t error() const
+    {
+        return gmres_.error();
+    }
+
+private:
+    GMRES gmres_;
+};
+
+typedef std::unique_ptr<TransportGMRES> UP_TransportGMRES_t;
+
+/**
+ * \brief Create a \ref TransportGMRES for within-group iterations from the
+ * attributes of a \<sweeper\> tag.
+ *
+ * The \c inner_solver attribute selects between plain source iteration
+ * (\c "si", the default), in which case this returns a null pointer, and
+ * \c "gmres". The \c inner_krylov and \c inner_tol attributes set the
+ * maximum Krylov subspace dimension and the relative tolerance.
+ */
+UP_TransportGMRES_t InnerGMRESFactory(const pugi::xml_node &input);
+}
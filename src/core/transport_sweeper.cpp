@@ -17,7 +17,10 @@
 #include "transport_sweeper.hpp"
 
 #include "pugixml.hpp"
+#include "util/files.hpp"
+#include "cmfd.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -85,8 +88,14 @@ TransportSweeper::TransportSweeper(const pugi::xml_node &input,
       coarse_data_(nullptr),
       n_sweep_(0),
       n_sweep_inner_(0),
-      do_incoming_update_(input.attribute("update_incoming").as_bool(true))
+      do_incoming_update_(input.attribute("update_incoming").as_bool(true)),
+      cmfd_(nullptr),
+      inner_dsa_(input.attribute("inner_dsa").as_bool(false))
 {
+    if ((treatment == MeshTreatment::PLANE) ||
+        (treatment == MeshTreatment::PIN)) {
+        pin_projection_ = PinProjection(mesh, treatment, vol_);
+    }
     return;
 }
 
@@ -96,7 +105,9 @@ TransportSweeper::TransportSweeper(const pugi::xml_node &input)
       coarse_data_(nullptr),
       n_sweep_(0),
       n_sweep_inner_(0),
-      do_incoming_update_(input.attribute("update_incoming").as_bool(true))
+      do_incoming_update_(input.attribute("update_incoming").as_bool(true)),
+      cmfd_(nullptr),
+      inner_dsa_(input.attribute("inner_dsa").as_bool(false))
 {
     return;
 }
@@ -105,11 +116,20 @@ real_t TransportSweeper::total_fission(bool old) const
 {
     real_t tfis      = 0.0;
     const auto &flux = old ? flux_old_ : flux_;
-    for (auto &xsr : *xs_mesh_) {
-        for (int ig = 0; ig < n_group_; ig++) {
-            real_t xsnf = xsr.xsmacnf(ig);
-            for (auto &ireg : xsr.reg()) {
-                tfis += flux((int)ireg, (int)ig) * vol_[ireg] * xsnf;
+#pragma omp parallel default(shared) reduction(+ : tfis)
+    {
+        for (auto &xsr : *xs_mesh_) {
+            const auto &xsnf = xsr.xsmacnf();
+            const auto &reg  = xsr.reg();
+            const int n_reg  = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg = reg[i];
+                real_t f       = 0.0;
+                for (int ig = 0; ig < n_group_; ig++) {
+                    f += xsnf[ig] * flux(ireg, ig);
+                }
+                tfis += f * vol_[ireg];
             }
         }
     }
@@ -119,13 +139,45 @@ real_t TransportSweeper::total_fission(bool old) const
 void TransportSweeper::calc_fission_source(real_t k,
                                            ArrayB1 &fission_source) const
 {
-    real_t rkeff   = 1.0 / k;
-    fission_source = 0.0;
-    for (auto &xsr : *xs_mesh_) {
-        const auto &xsnf = xsr.xsmacnf();
-        for (int ig = 0; ig < (int)n_group_; ig++) {
-            for (auto &ireg : xsr.reg()) {
-                fission_source(ireg) += rkeff * xsnf[ig] * flux_(ireg, ig);
+    const real_t rkeff = 1.0 / k;
+    fission_source     = 0.0;
+#pragma omp parallel default(shared)
+    {
+        for (auto &xsr : *xs_mesh_) {
+            const auto &xsnf = xsr.xsmacnf();
+            const auto &reg  = xsr.reg();
+            const int n_reg  = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg = reg[i];
+                real_t f       = 0.0;
+                for (int ig = 0; ig < n_group_; ig++) {
+                    f += xsnf[ig] * flux_(ireg, ig);
+                }
+                fission_source(ireg) = rkeff * f;
+            }
+        }
+    }
+
+    return;
+}
+
+void TransportSweeper::add_fission_source_1g(int group, real_t scale,
+                                             ArrayB1 &fission_source) const
+{
+#pragma omp parallel default(shared)
+    {
+        for (auto &xsr : *xs_mesh_) {
+            const real_t xsnf = scale * xsr.xsmacnf(group);
+            if (xsnf == 0.0) {
+                continue;
+            }
+            const auto &reg = xsr.reg();
+            const int n_reg = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg = reg[i];
+                fission_source(ireg) += xsnf * flux_(ireg, group);
             }
         }
     }
@@ -133,6 +185,41 @@ void TransportSweeper::calc_fission_source(real_t k,
     return;
 }
 
+FissionTotals
+TransportSweeper::update_fission_source(ArrayB1 &fission_source) const
+{
+    real_t tfis     = 0.0;
+    real_t tfis_old = 0.0;
+    int n_pos       = 0;
+    real_t sum      = 0.0;
+    fission_source  = 0.0;
+#pragma omp parallel default(shared) reduction(+ : tfis, tfis_old, n_pos, sum)
+    {
+        for (auto &xsr : *xs_mesh_) {
+            const auto &xsnf = xsr.xsmacnf();
+            const auto &reg  = xsr.reg();
+            const int n_reg  = reg.size();
+#pragma omp for nowait
+            for (int i = 0; i < n_reg; i++) {
+                const int ireg = reg[i];
+                real_t f       = 0.0;
+                real_t f_old   = 0.0;
+                for (int ig = 0; ig < n_group_; ig++) {
+                    f += xsnf[ig] * flux_(ireg, ig);
+                    f_old += xsnf[ig] * flux_old_(ireg, ig);
+                }
+                fission_source(ireg) = f;
+                tfis += f * vol_[ireg];
+                tfis_old += f_old * vol_[ireg];
+                n_pos += (f > 0.0) ? 1 : 0;
+                sum += f;
+            }
+        }
+    }
+
+    return {tfis, tfis_old, n_pos, sum};
+}
+
 /**
  * \todo make this general for all mesh treatments. For now, since this is only
  * used for MoC, we wil just hard-code it to use PLANE treatment.
@@ -196,29 +283,241 @@ ArrayB2 TransportSweeper::get_pin_flux(MeshTreatment treatment) const
 {
     assert(core_mesh_);
     ArrayB2 flux(core_mesh_->n_reg(treatment), n_group_);
+    this->get_pin_flux(flux, treatment);
 
-    auto flux_it = flux.begin();
+    return flux;
+}
+
+void TransportSweeper::get_pin_flux(ArrayB2 &flux,
+                                    MeshTreatment treatment) const
+{
+    assert(flux.extent(1) == n_group_);
+
+    if (!pin_projection_.empty()) {
+        pin_projection_.homogenize(flux_, flux, treatment);
+        return;
+    }
 
     for (int ig = 0; ig < n_group_; ig++) {
         ArrayB1 flux_1g(flux(blitz::Range::all(), ig));
         this->get_pin_flux_1g(ig, flux_1g, treatment);
     }
 
-    return flux;
+    return;
+}
+
+void TransportSweeper::scale_inner_iterations(real_t fraction,
+                                              unsigned int n_input,
+                                              unsigned int &n_inner,
+                                              const std::string &method)
+{
+    unsigned int n = n_input;
+    if (n > 0) {
+        n = std::min(n_input,
+                     std::max(1u, (unsigned int)std::ceil(fraction * n_input)));
+    }
+    if (n != n_inner) {
+        LogFile << method << " inner iterations: " << n << std::endl;
+    }
+    n_inner = n;
+    return;
+}
+
+void TransportSweeper::store_inner_dsa_flux(int group)
+{
+    int n_cell = core_mesh_->n_reg(MeshTreatment::PIN_PLANE);
+    if ((int)inner_dsa_flux_old_.size() != n_cell) {
+        inner_dsa_flux_old_.resize(n_cell);
+    }
+    this->get_pin_flux_1g(group, inner_dsa_flux_old_,
+                          MeshTreatment::PIN_PLANE);
+    return;
+}
+
+real_t TransportSweeper::apply_inner_dsa(int group)
+{
+    assert(this->inner_dsa_active());
+
+    ArrayB1 flux(inner_dsa_flux_old_.size());
+    this->get_pin_flux_1g(group, flux, MeshTreatment::PIN_PLANE);
+    real_t e = cmfd_->solve_within_group(group, inner_dsa_flux_old_, flux);
+    this->set_pin_flux_1g(group, flux, MeshTreatment::PIN_PLANE);
+
+    return e;
+}
+
+ArrayB1 TransportSweeper::ihm_spectrum(real_t &k_inf) const
+{
+    // Homogenize the cross sections by volume. Chi is weighted by the
+    // production rate of a flat flux.
+    VectorX xstr    = VectorX::Zero(n_group_);
+    VectorX xsnf    = VectorX::Zero(n_group_);
+    VectorX chi     = VectorX::Zero(n_group_);
+    MatrixX scatter = MatrixX::Zero(n_group_, n_group_);
+    real_t vol_tot  = 0.0;
+    for (const auto &xsr : *xs_mesh_) {
+        real_t vol = 0.0;
+        for (const auto ireg : xsr.reg()) {
+            vol += vol_[ireg];
+        }
+        vol_tot += vol;
+
+        real_t production = 0.0;
+        for (int ig = 0; ig < n_group_; ig++) {
+            xstr(ig) += vol * xsr.xsmactr(ig);
+            xsnf(ig) += vol * xsr.xsmacnf(ig);
+            production += vol * xsr.xsmacnf(ig);
+        }
+        for (int ig = 0; ig < n_group_; ig++) {
+            chi(ig) += production * xsr.xsmacch(ig);
+            const auto &row = xsr.xsmacsc(ig);
+            for (int igg = row.min_g; igg <= row.max_g; igg++) {
+                scatter(ig, igg) += vol * row[igg];
+            }
+        }
+    }
+
+    ArrayB1 spectrum(n_group_);
+    spectrum = 1.0;
+    k_inf    = 1.0;
+    if ((vol_tot <= 0.0) || (chi.sum() <= 0.0)) {
+        return spectrum;
+    }
+    chi /= chi.sum();
+
+    // (diag(xstr) - S) phi = chi (xsnf . phi) / k. With a rank-one fission
+    // operator, the fundamental mode is the solution to the fixed-source
+    // problem with a source of chi, and k is its production.
+    MatrixX a = -scatter / vol_tot;
+    for (int ig = 0; ig < n_group_; ig++) {
+        a(ig, ig) += xstr(ig) / vol_tot;
+    }
+    VectorX phi = a.partialPivLu().solve(chi);
+    k_inf       = xsnf.dot(phi) / vol_tot;
+
+    real_t norm = phi.sum() / n_group_;
+    for (int ig = 0; ig < n_group_; ig++) {
+        spectrum(ig) = phi(ig) / norm;
+    }
+
+    return spectrum;
+}
+
+void TransportSweeper::initialize_spectrum(const ArrayB1 &spectrum)
+{
+    assert((int)spectrum.size() == n_group_);
+    for (int ireg = 0; ireg < n_reg_; ireg++) {
+        for (int ig = 0; ig < n_group_; ig++) {
+            flux_(ireg, ig) = spectrum(ig);
+        }
+    }
+    flux_old_ = flux_;
+    this->mark_flux_dirty();
+    return;
+}
+
+void TransportSweeper::warm_start(H5Node &node)
+{
+    if (dataset_matches(node, "flux", flux_)) {
+        node.read("flux", flux_);
+    } else {
+        ArrayB2 pin_flux;
+        node.read("pin_flux", pin_flux);
+        if ((pin_flux.extent(1) != n_group_) ||
+            (core_mesh_ && (pin_flux.extent(0) !=
+                            (int)core_mesh_->n_reg(MeshTreatment::PIN)))) {
+            throw EXCEPT("Previous solution is not on the same pin mesh and "
+                         "energy groups.");
+        }
+        LogFile << "Mapping the pin flux of a previous solution to the "
+                   "sweeper mesh"
+                << std::endl;
+        this->set_pin_flux(pin_flux, MeshTreatment::PIN);
+    }
+    flux_old_ = flux_;
+    this->mark_flux_dirty();
+    return;
+}
+
+ArrayB1 TransportSweeper::flux_spectrum() const
+{
+    ArrayB1 spectrum(n_group_);
+    spectrum       = 0.0;
+    real_t vol_tot = 0.0;
+    for (int ireg = 0; ireg < n_reg_; ireg++) {
+        for (int ig = 0; ig < n_group_; ig++) {
+            spectrum(ig) += vol_[ireg] * flux_(ireg, ig);
+        }
+        vol_tot += vol_[ireg];
+    }
+    for (int ig = 0; ig < n_group_; ig++) {
+        spectrum(ig) /= vol_tot;
+    }
+    return spectrum;
+}
+
+bool TransportSweeper::dataset_matches(H5Node &node, const std::string &path,
+                                       const VecI &extents)
+{
+    std::vector<hsize_t> dims;
+    try {
+        dims = node.dimensions(path);
+    } catch (...) {
+        return false;
+    }
+    if (dims.size() != extents.size()) {
+        return false;
+    }
+    for (int i = 0; i < (int)dims.size(); i++) {
+        if ((int)dims[i] != extents[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TransportSweeper::checkpoint(H5Node &node) const
+{
+    node.write("flux", flux_);
+    node.write("flux_old", flux_old_);
+    node.write("pin_flux", this->get_pin_flux(MeshTreatment::PIN));
+    return;
+}
+
+void TransportSweeper::restart(H5Node &node)
+{
+    node.read("flux", flux_);
+    node.read("flux_old", flux_old_);
+    this->mark_flux_dirty();
+    return;
 }
 
 real_t TransportSweeper::flux_residual() const
 {
-    real_t r    = 0.0;
-    auto it     = flux_.begin();
-    auto it_old = flux_old_.begin();
-    auto end    = flux_.end();
-    while (it != end) {
-        real_t e = *it - *it_old;
+    assert(flux_.isStorageContiguous());
+    assert(flux_old_.isStorageContiguous());
+    real_t r             = 0.0;
+    const real_t *flux   = flux_.data();
+    const real_t *flux_o = flux_old_.data();
+    const int n          = flux_.size();
+#pragma omp parallel for default(shared) reduction(+ : r)
+    for (int i = 0; i < n; i++) {
+        real_t e = flux[i] - flux_o[i];
         r += e * e;
-        ++it;
-        ++it_old;
     }
     return std::sqrt(r);
 }
+
+real_t TransportSweeper::flux_residual(int group) const
+{
+    real_t r    = 0.0;
+    real_t norm = 0.0;
+#pragma omp parallel for default(shared) reduction(+ : r, norm)
+    for (int i = 0; i < n_reg_; i++) {
+        real_t e = flux_(i, group) - flux_old_(i, group);
+        r += e * e;
+        norm += flux_(i, group) * flux_(i, group);
+    }
+    return norm > 0.0 ? std::sqrt(r / norm) : std::sqrt(r);
+}
 }
@@ -18,6 +18,7 @@
 
 #include <iosfwd>
 #include <memory>
+#include <string>
 #include <vector>
 #include "util/blitz_typedefs.hpp"
 #include "util/error.hpp"
@@ -27,6 +28,7 @@
 #include "core/coarse_data.hpp"
 #include "core/eigen_interface.hpp"
 #include "core/output_interface.hpp"
+#include "core/pin_projection.hpp"
 #include "core/source.hpp"
 #include "core/source_factory.hpp"
 #include "core/source_isotropic.hpp"
@@ -34,6 +36,21 @@
 #include "core/xs_mesh_homogenized.hpp"
 
 namespace mocc {
+class CMFD;
+
+/**
+ * \brief Total fission production of the current and previous-iteration
+ * flux, along with the number of positive entries in, and the sum of, the
+ * new fission source, as returned by \ref
+ * TransportSweeper::update_fission_source().
+ */
+struct FissionTotals {
+    real_t current;
+    real_t old;
+    int n_positive;
+    real_t sum;
+};
+
 /**
  * \todo clean up these constructors. Would be nice for the (input, mesh)
  * version to be able to call the (input) version.
@@ -54,6 +71,36 @@ public:
      */
     virtual void sweep(int group) = 0;
 
+    /**
+     * \brief Prepare the sweeper to sweep different groups concurrently.
+     *
+     * This allocates whatever per-group storage is needed by \ref
+     * sweep_concurrent(). The default implementation does nothing.
+     *
+     * \returns whether concurrent group sweeps are supported. If not, \ref
+     * sweep_concurrent() should not be called.
+     */
+    virtual bool prepare_concurrent_groups()
+    {
+        return false;
+    }
+
+    /**
+     * \brief Perform a transport sweep of the passed group, using the passed
+     * \ref Source rather than the one assigned to the sweeper.
+     *
+     * Following a successful call to \ref prepare_concurrent_groups(), this
+     * may be called concurrently for different groups from separate threads.
+     * Each thread forms its own team for the parallel regions inside the
+     * sweep, so nested parallelism should be enabled by the caller. Timers
+     * are not updated.
+     */
+    virtual void sweep_concurrent(int group, Source &source)
+    {
+        throw EXCEPT("Concurrent group sweeps are not supported by this "
+                     "sweeper");
+    }
+
     /**
      * \brief Initialize the solution variables (scalar, boundary flux,
      * etc.) to reasonable initial guesses.
@@ -85,6 +132,17 @@ public:
      */
     ArrayB2 get_pin_flux(MeshTreatment treatment = MeshTreatment::PIN) const;
 
+    /**
+     * \brief Store the pin-homogenized multi-group scalar flux in the passed
+     * array.
+     *
+     * The passed array must already be sized to the number of regions in the
+     * requested \ref MeshTreatment by the number of groups. Sweepers with a
+     * \ref PinProjection homogenize all groups in a single threaded pass;
+     * otherwise this falls back to \ref get_pin_flux_1g() for each group.
+     */
+    void get_pin_flux(ArrayB2 &flux, MeshTreatment treatment) const;
+
     /**
      * \brief Produce pin-homogenized scalar flux for the specified group
      * and store in the passed array.
@@ -143,18 +201,82 @@ public:
 
     /**
      * \brief Return a reference to the multi-group flux
+     *
+     * Callers that modify the flux through this reference must follow up
+     * with \ref mark_flux_dirty(), so that cross sections homogenized with
+     * the flux are refreshed.
      */
     ArrayB2 &flux()
     {
         return flux_;
     }
 
+    /**
+     * \brief Associate a homogenized XS mesh with the flux of this sweeper.
+     *
+     * The XS mesh is weighted by \ref flux(), and is told which groups need
+     * to be rehomogenized as the sweeper changes the flux.
+     */
+    void attach_homogenized_xsmesh(SP_XSMeshHomogenized_t xsm)
+    {
+        xsm->set_flux(flux_);
+        flux_xs_meshes_.push_back(xsm);
+    }
+
+    /**
+     * \brief Flag the flux in the passed group as having changed for all
+     * attached homogenized XS meshes.
+     *
+     * This may be called concurrently for different groups.
+     */
+    virtual void mark_flux_dirty(int group)
+    {
+        for (auto &xsm : flux_xs_meshes_) {
+            xsm->mark_dirty(group);
+        }
+    }
+
+    /**
+     * \brief Flag the flux in all groups as having changed for all attached
+     * homogenized XS meshes.
+     */
+    virtual void mark_flux_dirty()
+    {
+        for (auto &xsm : flux_xs_meshes_) {
+            xsm->mark_dirty();
+        }
+    }
+
     /**
      * \brief Given the current estimate of a system eigenvalue, calculate
      * the group-independent fission source and store in the passed array
      */
     virtual void calc_fission_source(real_t k, ArrayB1 &fission_source) const;
 
+    /**
+     * \brief Add the fission source from the flux of a single group, scaled
+     * by \p scale, to the passed group-independent fission source
+     *
+     * This allows a fission source to be kept current as groups are swept,
+     * without recomputing it from the whole multigroup flux.
+     */
+    virtual void add_fission_source_1g(int group, real_t scale,
+                                       ArrayB1 &fission_source) const;
+
+    /**
+     * \brief Calculate the fission source for a unit eigenvalue, along with
+     * the total fission production of the current and old flux, in a single
+     * pass over the flux.
+     *
+     * The returned totals are the same as those from \ref total_fission().
+     * Since the fission source is linear in \f$ 1/k \f$, the caller may scale
+     * the result once the new eigenvalue is known, rather than making
+     * separate passes over the multigroup flux for each quantity. The number
+     * of positive entries and the sum of the fission source are returned as
+     * well, so that it may be normalized without another pass.
+     */
+    virtual FissionTotals update_fission_source(ArrayB1 &fission_source) const;
+
     /**
      * \brief Construct and return a source object which conforms to the
      * sweeper.
@@ -188,6 +310,15 @@ public:
         return n_reg_;
     }
 
+    /**
+     * \brief Return the number of group sweeps performed over the lifetime
+     * of the sweeper
+     */
+    int n_sweep() const
+    {
+        return n_sweep_;
+    }
+
     /**
      * \brief Return the number of retions to use to represent the fission
      * source
@@ -254,6 +385,123 @@ public:
         coarse_data_ = cd;
     }
 
+    /**
+     * \brief Associate the sweeper with a \ref CMFD solver.
+     *
+     * The \ref CMFD solver is used for within-group acceleration of the inner
+     * iterations, if requested by the \c inner_dsa attribute. The sweeper
+     * should already be associated with the \ref CoarseData of the \ref
+     * CMFD solver.
+     */
+    void set_cmfd(CMFD *cmfd)
+    {
+        cmfd_ = cmfd;
+    }
+
+    /**
+     * \brief Save the iteration state of the sweeper, other than the scalar
+     * flux, onto a stack.
+     *
+     * This typically consists of the incoming boundary angular flux. Along
+     * with \ref restore_state(), this allows a solver to evaluate several
+     * sweeps from the same starting point. Since solvers may be nested (e.g.
+     * a Krylov inner iteration inside of a Newton outer iteration), saved
+     * states form a stack; each call should be matched with a call to \ref
+     * pop_state(). The default implementation does nothing.
+     */
+    virtual void push_state()
+    {
+        return;
+    }
+
+    /**
+     * \brief Restore the iteration state on the top of the stack, leaving it
+     * on the stack.
+     */
+    virtual void restore_state()
+    {
+        return;
+    }
+
+    /**
+     * \brief Discard the iteration state on the top of the stack.
+     */
+    virtual void pop_state()
+    {
+        return;
+    }
+
+    /**
+     * \brief Compute the infinite-homogeneous-medium (IHM) spectrum of the
+     * problem.
+     *
+     * The cross sections of all regions are homogenized by volume, and the
+     * eigenvalue problem for the resulting infinite medium is solved. Since
+     * the fission operator is rank-one, this takes a single dense solve.
+     *
+     * \param [out] k_inf the infinite-medium eigenvalue. One if there is no
+     * fissile material, in which case a flat spectrum is returned.
+     * \returns the scalar flux spectrum, normalized to an average of one.
+     */
+    ArrayB1 ihm_spectrum(real_t &k_inf) const;
+
+    /**
+     * \brief Initialize the scalar flux in every region to the passed
+     * spectrum.
+     *
+     * Sweepers with boundary angular flux should override this to also
+     * initialize it, isotropically. Overrides should call the base
+     * implementation.
+     */
+    virtual void initialize_spectrum(const ArrayB1 &spectrum);
+
+    /**
+     * \brief Initialize the solution from a checkpoint of a previous run on
+     * the same geometry, such as a prior depletion step or a parameter
+     * branch.
+     *
+     * \param node the HDF5 node to which \ref checkpoint() wrote the
+     * sweeper state
+     *
+     * If the region mesh is the same, the scalar flux is copied directly.
+     * Otherwise the pin-homogenized flux is mapped to the sweeper mesh.
+     * Overrides should copy the boundary angular flux when it is the same
+     * size, and otherwise initialize it from the spectrum of the scalar flux.
+     */
+    virtual void warm_start(H5Node &node);
+
+    /**
+     * \brief Write the iteration state of the sweeper to a checkpoint.
+     *
+     * The state consists of the scalar flux, the old scalar flux, and
+     * anything else that carries over from one outer iteration to the next
+     * (e.g. the incoming boundary angular flux), so that \ref restart() may
+     * continue the iteration exactly where it left off. Overrides should call
+     * the base implementation.
+     */
+    virtual void checkpoint(H5Node &node) const;
+
+    /**
+     * \brief Restore the iteration state of the sweeper from a checkpoint
+     * written by \ref checkpoint().
+     */
+    virtual void restart(H5Node &node);
+
+    /**
+     * \brief Set the number of inner iterations to perform on each group
+     * sweep, as a fraction of the number specified in the input.
+     *
+     * The resulting number of inner iterations is rounded up, and is at least
+     * one, unless the input specified none. This is used by adaptive solvers
+     * to perform inexact inner iterations early in the outer iteration
+     * process. Sweepers that combine several transport methods should apply
+     * the fraction to each of them. The default implementation does nothing.
+     */
+    virtual void set_inner_fraction(real_t fraction)
+    {
+        return;
+    }
+
     /**
      * \brief Associate the sweeper with a source.
      *
@@ -280,6 +528,12 @@ public:
      */
     virtual real_t flux_residual() const;
 
+    /**
+     * \brief Compute the flux residual for a single group, relative to the
+     * L-2 norm of the group's current flux.
+     */
+    virtual real_t flux_residual(int group) const;
+
     /**
      * \brief Compute the total fission source based on the current or previous
      * state of the flux
@@ -314,6 +568,67 @@ public:
     }
 
 protected:
+    /**
+     * \brief Return whether within-group CMFD acceleration should be applied
+     * to the inner iterations
+     */
+    bool inner_dsa_active() const
+    {
+        return inner_dsa_ && cmfd_ && coarse_data_;
+    }
+
+    /**
+     * \brief Return the volume-averaged spectrum of the current scalar flux
+     */
+    ArrayB1 flux_spectrum() const;
+
+    /**
+     * \brief Return whether the dataset at \p path in \p node exists and
+     * has the passed extents
+     */
+    static bool dataset_matches(H5Node &node, const std::string &path,
+                                const VecI &extents);
+
+    /**
+     * \brief Return whether the dataset at \p path in \p node exists and
+     * has the same shape as the passed Blitz array
+     */
+    template <class BlitzArray>
+    static bool dataset_matches(H5Node &node, const std::string &path,
+                                const BlitzArray &data)
+    {
+        VecI extents;
+        for (int i = 0; i < data.dimensions(); i++) {
+            extents.push_back(data.extent(i));
+        }
+        return dataset_matches(node, path, extents);
+    }
+
+    /**
+     * \brief Scale the number of inner iterations \p n_inner to the passed
+     * fraction of \p n_input, as described for \ref set_inner_fraction().
+     *
+     * Any change is logged, labeled with \p method.
+     */
+    static void scale_inner_iterations(real_t fraction, unsigned int n_input,
+                                       unsigned int &n_inner,
+                                       const std::string &method);
+
+    /**
+     * \brief Store the coarse-mesh flux for the passed group, prior to an
+     * inner iteration
+     */
+    void store_inner_dsa_flux(int group);
+
+    /**
+     * \brief Apply a within-group CMFD correction to the passed group,
+     * following an inner iteration that tallied currents to the \ref
+     * CoarseData.
+     *
+     * \returns the norm of the relative coarse-mesh flux correction
+     */
+    real_t apply_inner_dsa(int group);
+
     const CoreMesh *core_mesh_;
 
     SP_XSMesh_t xs_mesh_;
@@ -330,9 +645,17 @@ protected:
     // Previous value of the MG scalar flux
     ArrayB2 flux_old_;
 
+    // Homogenized XS meshes that are weighted by flux_. See
+    // attach_homogenized_xsmesh()
+    std::vector<SP_XSMeshHomogenized_t> flux_xs_meshes_;
+
     // Region volumes
     VecF vol_;
 
+    // Precomputed operators between the sweeper mesh and the pin meshes.
+    // Empty for sweepers that do not have a mesh of their own.
+    PinProjection pin_projection_;
+
     AngularQuadrature ang_quad_;
 
     // Reference to the CoarseData object that should be used to store
@@ -348,6 +671,15 @@ protected:
 
     // Do incoming flux updates?
     bool do_incoming_update_;
+
+    // CMFD solver used for within-group acceleration. May be null.
+    CMFD *cmfd_;
+
+    // Whether to apply within-group CMFD between inner iterations
+    bool inner_dsa_;
+
+    // Coarse-mesh flux prior to the current inner iteration
+    ArrayB1 inner_dsa_flux_old_;
 };
 
 typedef std::unique_ptr<TransportSweeper> UP_Sweeper_t;
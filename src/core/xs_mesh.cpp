@@ -16,10 +16,14 @@
 
 #include "xs_mesh.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
+#include <type_traits>
 #include "util/blitz_typedefs.hpp"
+#include "util/error.hpp"
 #include "util/files.hpp"
 #include "util/global_config.hpp"
 
@@ -116,4 +120,97 @@ XSMesh::XSMesh(const CoreMesh &mesh, MeshTreatment treatment) : state_(0)
 
     return;
 }
+
+ExpandedXS::ExpandedXS(const XSMesh *xs_mesh, bool compact, bool split)
+    : xs_mesh_(xs_mesh), state_(std::make_shared<std::pair<int, int>>(-1, -1))
+{
+    static_assert(std::is_same<CompactXS::Index_t, uint16_t>::value,
+                  "Compact view index type mismatch");
+    // Make sure that the table can never outgrow the index, even if every
+    // region is given its own split entry. Deciding this up front means that
+    // instances sharing the data never need to change representation.
+    const long max_index = std::numeric_limits<CompactXS::Index_t>::max();
+    long max_table       = xs_mesh->size();
+    if (split) {
+        max_table += xs_mesh->n_reg_expanded();
+    }
+    if (compact && (max_table > max_index)) {
+        Warn("Too many XS mesh regions for compact cross sections. Using "
+             "dense storage.");
+        compact = false;
+    }
+
+    if (!compact) {
+        xstr_.resize(xs_mesh->n_reg_expanded());
+        return;
+    }
+
+    compact_ = std::make_shared<CompactXS>();
+    compact_->index.resize(xs_mesh->n_reg_expanded());
+    int ixsr = 0;
+    for (const auto &xsr : *xs_mesh) {
+        for (const int ireg : xsr.reg()) {
+            compact_->index[ireg] = ixsr;
+        }
+        ixsr++;
+    }
+    compact_->table_array.resize(xs_mesh->size());
+    compact_->table       = compact_->table_array.data();
+    compact_->n_table     = xs_mesh->size();
+    compact_->allow_split = split;
+
+    return;
+}
+
+void ExpandedXS::expand_compact(int group)
+{
+    assert(compact_);
+    auto &c = *compact_;
+
+    for (const auto &reg : c.split_regions) {
+        c.index[reg.first] = reg.second;
+    }
+    c.split_regions.clear();
+
+    int ixsr = 0;
+    for (const auto &xsr : *xs_mesh_) {
+        c.table[ixsr] = xsr.xsmactr(group);
+        ixsr++;
+    }
+    c.n_table = ixsr;
+
+    return;
+}
+
+void ExpandedXS::expand_compact(int group, const ArrayB1 &split)
+{
+    assert(compact_);
+    if (!compact_->allow_split) {
+        throw EXCEPT("Compact cross sections were not set up for splitting");
+    }
+    this->expand_compact(group);
+    auto &c = *compact_;
+
+    const int max_index = std::numeric_limits<CompactXS::Index_t>::max();
+    const int n_reg     = c.index.size();
+    for (int ireg = 0; ireg < n_reg; ireg++) {
+        if (split(ireg) == 0.0) {
+            continue;
+        }
+        // Guaranteed by the constructor
+        assert(c.n_table <= max_index);
+        if (c.n_table == (int)c.table_array.size()) {
+            c.table_array.resizeAndPreserve(
+                std::min(std::max(2 * c.n_table, 1), max_index + 1));
+            c.table = c.table_array.data();
+        }
+        CompactXS::Index_t orig = c.index[ireg];
+        c.table[c.n_table]      = c.table[orig] + split(ireg);
+        c.split_regions.emplace_back(ireg, orig);
+        c.index[ireg] = c.n_table;
+        c.n_table++;
+    }
+
+    return;
+}
 }
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include "util/blitz_typedefs.hpp"
 #include "util/fp_utils.hpp"
@@ -197,6 +199,22 @@ typedef std::shared_ptr<XSMesh> SP_XSMesh_t;
  * \c shared_ptr for storing the other state allows for full instances of the
  * class (referring to the same data) to be used where a reference or pointer
  * would otherwise be used, removing a level of indirection.
+ *
+ * Optionally, the cross sections may be stored in "compact" form. Instead of
+ * a dense array of cross sections, a 16-bit index into the \ref XSMesh
+ * regions is stored for each region, along with a small table of the cross
+ * sections of each \ref XSMeshRegion for the current group. Expansion then
+ * only needs to fill the table, which is usually small enough to stay in L1,
+ * and the per-region storage is a quarter of the size. Transverse leakage
+ * splitting is applied as a sparse correction: each region with a non-zero
+ * splitting term is given its own entry at the end of the table. Whether the
+ * table could outgrow the index type is decided once, at construction, so
+ * that every instance sharing the data always agrees on its representation.
+ *
+ * Performance-critical loops should not go through the subscript operator,
+ * which has to check the representation on every access. Instead, they
+ * should be instantiated for each of the \ref Dense and \ref Compact views
+ * and dispatched once, based on \ref compact().
  */
 class ExpandedXS {
 public:
@@ -220,12 +238,82 @@ public:
         return;
     }
 
+    /**
+     * \brief Make a new object based on the passed \ref XSMesh, optionally
+     * using compact storage.
+     *
+     * If \p compact is requested but the \ref XSMesh has too many regions
+     * to be addressed by the compact index, a warning is issued and dense
+     * storage is used instead. If \p split is true, the object must also be
+     * able to hold a split entry for every region, since it may later be
+     * expanded with transverse leakage splitting.
+     */
+    ExpandedXS(const XSMesh *xs_mesh, bool compact, bool split = false);
+
+    /**
+     * \brief Lightweight view of dense cross sections
+     */
+    class Dense {
+    public:
+        Dense(const real_t *xs) : xs_(xs)
+        {
+            return;
+        }
+
+        real_t operator[](int i) const
+        {
+            return xs_[i];
+        }
+
+    private:
+        const real_t *xs_;
+    };
+
+    /**
+     * \brief Lightweight view of compact cross sections
+     *
+     * The view is only valid until the next expansion, which may reallocate
+     * the table.
+     */
+    class Compact {
+    public:
+        Compact(const uint16_t *index, const real_t *table)
+            : index_(index), table_(table)
+        {
+            return;
+        }
+
+        real_t operator[](int i) const
+        {
+            return table_[index_[i]];
+        }
+
+    private:
+        const uint16_t *index_;
+        const real_t *table_;
+    };
+
+    Dense dense_view() const
+    {
+        assert(!compact_);
+        return Dense(xstr_.data());
+    }
+
+    Compact compact_view() const
+    {
+        assert(compact_);
+        return Compact(compact_->index.data(), compact_->table);
+    }
+
     /**
      * \brief Reference the expanded data from an existing instance of \ref
      * ExpandedXS
      */
     ExpandedXS(ExpandedXS &other)
-        : xstr_(other.xstr_), xs_mesh_(other.xs_mesh_), state_(other.state_)
+        : xstr_(other.xstr_),
+          xs_mesh_(other.xs_mesh_),
+          state_(other.state_),
+          compact_(other.compact_)
     {
         return;
     }
@@ -243,6 +331,7 @@ public:
         xstr_.reference(other.xstr_);
         xs_mesh_ = other.xs_mesh_;
         state_   = other.state_;
+        compact_ = other.compact_;
 
         return *this;
     }
@@ -250,12 +339,23 @@ public:
     real_t operator[](int i) const
     {
         assert((i >= 0) && (i < this->size()));
+        if (compact_) {
+            return compact_->table[compact_->index[i]];
+        }
         return xstr_(i);
     }
 
     int size() const
     {
-        return xstr_.size();
+        return compact_ ? compact_->index.size() : xstr_.size();
+    }
+
+    /**
+     * \brief Return whether the cross sections are stored in compact form
+     */
+    bool compact() const
+    {
+        return (bool)compact_;
     }
 
     void expand(int group)
@@ -265,6 +365,10 @@ public:
         if ((group != state_->first) || (xs_mesh_->state() != state_->second)) {
             state_->first  = group;
             state_->second = xs_mesh_->state();
+            if (compact_) {
+                this->expand_compact(group);
+                return;
+            }
             for (const auto &xsr : *xs_mesh_) {
                 real_t xs = xsr.xsmactr(group);
                 for (const int ireg : xsr.reg()) {
@@ -285,6 +389,13 @@ public:
             // If we are doing splitting, skip the checks on group, etc. and
             // always expand
             assert((int)split.size() == xs_mesh_->n_reg_expanded());
+            // Make sure that a later, unsplit expansion of the same group
+            // does not reuse these cross sections
+            state_->first = -1;
+            if (compact_) {
+                this->expand_compact(group, split);
+                return;
+            }
             for (const auto &xsr : *xs_mesh_) {
                 real_t xs = xsr.xsmactr(group);
                 for (const int ireg : xsr.reg()) {
@@ -297,9 +408,16 @@ public:
         return;
     }
 
+    /**
+     * \brief Return the dense array of expanded cross sections.
+     *
+     * In compact mode, this is instead the table of cross sections for the
+     * current group, indexed by \ref XSMeshRegion, and possibly followed by
+     * the split entries.
+     */
     const ArrayB1 &xs() const
     {
-        return xstr_;
+        return compact_ ? compact_->table_array : xstr_;
     }
 
     auto begin() const
@@ -313,6 +431,37 @@ public:
     }
 
 private:
+    // Storage for the compact representation, shared by all instances that
+    // refer to the same data
+    struct CompactXS {
+        typedef uint16_t Index_t;
+        // Index into the table for each region
+        std::vector<Index_t> index;
+        // Cross sections for each XSMeshRegion, followed by those of the
+        // regions with non-zero splitting
+        ArrayB1 table_array;
+        real_t *table;
+        // Number of entries in the table that are in use
+        int n_table;
+        // Regions that have been given their own table entry for splitting,
+        // along with their original index
+        std::vector<std::pair<int, Index_t>> split_regions;
+        // Whether the table was sized to allow splitting of every region
+        bool allow_split;
+    };
+
+    /**
+     * \brief Fill the compact table for the passed group, reverting any
+     * previous splitting.
+     */
+    void expand_compact(int group);
+
+    /**
+     * \brief Fill the compact table for the passed group, adding a table
+     * entry for each region with non-zero splitting.
+     */
+    void expand_compact(int group, const ArrayB1 &split);
+
     ArrayB1 xstr_;
     const XSMesh *xs_mesh_;
 
@@ -321,5 +470,8 @@ private:
     // is stored in a shared pointer so that multiple instances of ExpandedXS
     // can share state.
     std::shared_ptr<std::pair<int, int>> state_;
+
+    // Compact storage. Null if using dense storage
+    std::shared_ptr<CompactXS> compact_;
 };
 }
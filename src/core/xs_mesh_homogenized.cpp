@@ -16,6 +16,7 @@
 
 #include "xs_mesh_homogenized.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <numeric>
@@ -32,6 +33,7 @@ XSMeshHomogenized::XSMeshHomogenized(const CoreMesh &mesh)
     // Set up the non-xs part of the xs mesh
     eubounds_ = mesh_.mat_lib().g_bounds();
     ng_       = eubounds_.size();
+    dirty_.assign(ng_, 1);
 
     int n_xsreg = std::accumulate(
         mesh_.macroplanes().begin(), mesh_.macroplanes().end(), 0,
@@ -182,16 +184,32 @@ void XSMeshHomogenized::update()
         // For now assume that the flux is coming from a PLANE-type sweeper
         assert(flux_->extent(0) == (int)mesh_.n_reg(MeshTreatment::PLANE));
     }
-    int first_reg = 0;
-    int ixsreg    = 0;
-    for (const auto &mplane : mesh_.macroplanes()) {
-        for (const auto &pin : mplane) {
-            this->homogenize_region_flux(ixsreg, first_reg, *pin,
-                                         regions_[ixsreg]);
-            first_reg += pin->n_reg();
-            ixsreg++;
+
+    if (first_reg_.empty()) {
+        first_reg_.reserve(regions_.size());
+        pins_.reserve(regions_.size());
+        int first_reg = 0;
+        for (const auto &mplane : mesh_.macroplanes()) {
+            for (const auto &pin : mplane) {
+                first_reg_.push_back(first_reg);
+                pins_.push_back(pin);
+                first_reg += pin->n_reg();
+            }
         }
     }
+
+    if (std::find(dirty_.begin(), dirty_.end(), 1) == dirty_.end()) {
+        return;
+    }
+
+    const int n_xsreg = first_reg_.size();
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int ixsreg = 0; ixsreg < n_xsreg; ixsreg++) {
+        this->homogenize_region_flux(ixsreg, first_reg_[ixsreg],
+                                     *pins_[ixsreg], regions_[ixsreg], dirty_);
+    }
+
+    std::fill(dirty_.begin(), dirty_.end(), 0);
     state_++;
     return;
 }
@@ -260,26 +278,34 @@ void XSMeshHomogenized::homogenize_region(int i, const Pin &pin,
 
 void XSMeshHomogenized::homogenize_region_flux(int i, int first_reg,
                                                const Pin &pin,
-                                               XSMeshRegion &xsr) const
+                                               XSMeshRegion &xsr,
+                                               const VecI &dirty) const
 {
     assert(flux_);
 
     // Extract a reference to the flux array.
-    const ArrayB2 flux = *flux_;
-
-    // Set the FSRs to be one element, representing the coarse mesh index to
-    // which this \ref XSMeshRegion belongs.
-    VecI fsrs(1, i);
-    VecF xstr(ng_, 0.0);
-    VecF xsnf(ng_, 0.0);
-    VecF xsf(ng_, 0.0);
+    const ArrayB2 &flux = *flux_;
+
+    // Start from the current cross sections. Only the dirty groups are
+    // replaced below. The scattering matrix is stored as (to, from), and
+    // column "from" only depends on the flux in group "from."
+    VecF xstr(xsr.xsmactr(), xsr.xsmactr() + ng_);
+    VecF xsnf(xsr.xsmacnf(), xsr.xsmacnf() + ng_);
+    VecF xsf(xsr.xsmacf(), xsr.xsmacf() + ng_);
     VecF xsch(ng_, 0.0);
 
     std::vector<VecF> scat(ng_, VecF(ng_, 0.0));
+    if (xsr.xsmacsc().n_group() == (int)ng_) {
+        VecF sc_dense = xsr.xsmacsc().as_vector();
+        for (int ig = 0; ig < (int)ng_; ig++) {
+            std::copy(&sc_dense[ng_ * ig], &sc_dense[ng_ * ig] + ng_,
+                      scat[ig].begin());
+        }
+    }
 
-    auto mat_lib   = mesh_.mat_lib();
-    auto &pin_mesh = pin.mesh();
-    auto areas     = pin_mesh.areas();
+    const auto &mat_lib  = mesh_.mat_lib();
+    const auto &pin_mesh = pin.mesh();
+    const auto &areas    = pin_mesh.areas();
 
     // Precompute the fission source in each region, since it is the
     // wieghting factor for chi
@@ -290,7 +316,7 @@ void XSMeshHomogenized::homogenize_region_flux(int i, int first_reg,
             int ireg_local = 0;
             int ixsreg     = 0;
             for (auto &mat_id : pin.mat_ids()) {
-                auto mat = mat_lib.get_material_by_id(mat_id);
+                const auto &mat = mat_lib.get_material_by_id(mat_id);
                 for (int i = 0; i < (int)pin_mesh.n_fsrs(ixsreg); i++) {
                     fs[ireg_local] +=
                         mat.xsnf(ig) * flux(ireg, ig) * areas[ireg_local];
@@ -308,16 +334,39 @@ void XSMeshHomogenized::homogenize_region_flux(int i, int first_reg,
     }
 
     for (size_t ig = 0; ig < ng_; ig++) {
+        {
+            int ireg_local = 0;
+            int ixsreg     = 0;
+            for (auto &mat_id : pin.mat_ids()) {
+                const auto &mat = mat_lib.get_material_by_id(mat_id);
+                for (size_t i = 0; i < pin_mesh.n_fsrs(ixsreg); i++) {
+                    xsch[ig] += fs[ireg_local] * mat.xsch(ig);
+                    ireg_local++;
+                }
+                ixsreg++;
+            }
+            if (fs_sum > 0.0) {
+                xsch[ig] /= fs_sum;
+            }
+        }
+
+        if (!dirty[ig]) {
+            continue;
+        }
+
         real_t fluxvolsum = 0.0;
-        VecF scatsum(ng_, 0.0);
+        xstr[ig]          = 0.0;
+        xsnf[ig]          = 0.0;
+        xsf[ig]           = 0.0;
+        for (size_t igg = 0; igg < ng_; igg++) {
+            scat[igg][ig] = 0.0;
+        }
+
         int ireg       = first_reg; // global region index
         int ireg_local = 0;         // pin-local refion index
         int ixsreg     = 0;
         for (auto &mat_id : pin.mat_ids()) {
-            auto mat                      = mat_lib.get_material_by_id(mat_id);
-            const ScatteringRow &scat_row = mat.xssc().to(ig);
-            size_t gmin                   = scat_row.min_g;
-            size_t gmax                   = scat_row.max_g;
+            const auto &mat = mat_lib.get_material_by_id(mat_id);
             for (size_t i = 0; i < pin_mesh.n_fsrs(ixsreg); i++) {
                 real_t v      = areas[ireg_local];
                 real_t flux_i = flux(ireg, (int)ig);
@@ -325,14 +374,15 @@ void XSMeshHomogenized::homogenize_region_flux(int i, int first_reg,
                 xstr[ig] += v * flux_i * mat.xstr(ig);
                 xsnf[ig] += v * flux_i * mat.xsnf(ig);
                 xsf[ig] += v * flux_i * mat.xsf(ig);
-                xsch[ig] += fs[ireg_local] * mat.xsch(ig);
 
+                // Scattering from this group to all others
                 for (size_t igg = 0; igg < ng_; igg++) {
-                    real_t fluxgg = flux(ireg, (int)igg);
-                    scatsum[igg] += fluxgg * v;
-                    if ((igg >= gmin) && (igg <= gmax)) {
-                        real_t scgg = scat_row.from[igg - gmin];
-                        scat[ig][igg] += scgg * v * fluxgg;
+                    const ScatteringRow &scat_row = mat.xssc().to(igg);
+                    size_t gmin                   = scat_row.min_g;
+                    size_t gmax                   = scat_row.max_g;
+                    if ((ig >= gmin) && (ig <= gmax)) {
+                        real_t scgg = scat_row.from[ig - gmin];
+                        scat[igg][ig] += scgg * v * flux_i;
                     }
                 }
                 ireg++;
@@ -342,17 +392,14 @@ void XSMeshHomogenized::homogenize_region_flux(int i, int first_reg,
         }
 
         for (size_t igg = 0; igg < ng_; igg++) {
-            if (scat[ig][igg] > 0.0) {
-                scat[ig][igg] /= scatsum[igg];
+            if (scat[igg][ig] > 0.0) {
+                scat[igg][ig] /= fluxvolsum;
             }
         }
 
         xstr[ig] /= fluxvolsum;
         xsnf[ig] /= fluxvolsum;
         xsf[ig] /= fluxvolsum;
-        if (fs_sum > 0.0) {
-            xsch[ig] /= fs_sum;
-        }
     }
 
     ScatteringMatrix scat_mat(scat);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 
 #include "util/blitz_typedefs.hpp"
@@ -68,6 +69,17 @@ public:
      *
      * Update homogenized cross sections using the internally-stored
      * reference to the scalar flux.
+     *
+     * Only the groups whose flux has changed since the previous update are
+     * rehomogenized. The owner of the flux is responsible for reporting
+     * changes through \ref mark_dirty(); nothing is inferred from the flux
+     * itself. The transport,
+     * fission and scattering-from cross sections of a group only depend on
+     * the flux in that group, so clean groups keep their current values;
+     * \f$\chi\f$ is weighted by the fission source and is recomputed
+     * whenever any group is dirty. If nothing has changed, the state of the
+     * \ref XSMesh is left alone, so that consumers do not needlessly
+     * re-expand their cross sections.
      */
     void update();
 
@@ -79,13 +91,36 @@ public:
      * array for use in the \ref XSMeshHomogenized::update() method. If no
      * flux has been associated when \ref update() is called, the update is
      * skipped, preserving the volume-weighted cross sections, which are
-     * calculated at construction time.
+     * calculated at construction time. Associating a flux marks all groups
+     * as dirty, so the next call to \ref update() rehomogenizes everything.
      */
     void set_flux(const ArrayB2 &flux)
     {
         // Make the assumption that the provided flux is using a PLANE treatment
         assert(flux.extent(0) == (int)mesh_.n_reg(MeshTreatment::PLANE));
         flux_ = &flux;
+        this->mark_dirty();
+    }
+
+    /**
+     * \brief Flag the flux in the passed group as having changed since the
+     * last call to \ref update().
+     *
+     * This may be called concurrently for different groups.
+     */
+    void mark_dirty(int group)
+    {
+        assert((group >= 0) && (group < (int)dirty_.size()));
+        dirty_[group] = 1;
+    }
+
+    /**
+     * \brief Flag the flux in all groups as having changed since the last call
+     * to \ref update().
+     */
+    void mark_dirty()
+    {
+        std::fill(dirty_.begin(), dirty_.end(), 1);
     }
 
     /**
@@ -99,6 +134,17 @@ private:
     // Possibly-associated flux for homogenization.
     const ArrayB2 *flux_;
 
+    // Flags for each group indicating whether the flux has changed since the
+    // last call to update(). Stored as int rather than bool so that distinct
+    // groups may be flagged concurrently.
+    VecI dirty_;
+
+    // Offset into the flux array of the first FSR of each XS mesh region,
+    // along with the pin that the region homogenizes. Populated on the first
+    // call to update().
+    VecI first_reg_;
+    std::vector<const Pin *> pins_;
+
     /**
     * \brief Populate the passed XSMeshRegion with homogenized cross sections
     * from a pin cell. No flux wieghting is performed, only volume weighting.
@@ -124,12 +170,16 @@ private:
     * \param xsr A reference to the \ref XSMeshRegion into which the cross
     * sections should be homogenized.
     *
+    * \param dirty flags for each group indicating whether its cross
+    * sections should be rehomogenized. The cross sections for clean groups
+    * are taken from the current state of \p xsr.
+    *
     * This routine performs a flux-weighted homogenization of the cross
     * sections in the passed \ref Pin object and returns an \ref
     * XSMeshRegion object containing the homogenized cross sections.
     */
     void homogenize_region_flux(int i, int first_reg, const Pin &pin,
-                                XSMeshRegion &xsr) const;
+                                XSMeshRegion &xsr, const VecI &dirty) const;
 
     void read_data_single(const pugi::xml_node &data);
 
@@ -31,6 +31,8 @@
 #include "util/omp_guard.h"
 #include "util/timers.hpp"
 #include "core/core_mesh.hpp"
+#include "core/globals.hpp"
+#include "core/parallel_environment.hpp"
 #include "core/solver.hpp"
 #include "core/transport_sweeper.hpp"
 #include "git_SHA1.hpp"
@@ -50,6 +52,11 @@ std::unique_ptr<InputProcessor> input_proc;
 // Generate output from the solver
 void generate_output()
 {
+    // Only the root process writes output
+    if (!ParEnv.comm().is_root()) {
+        return;
+    }
+
     std::string out_name = input_proc->case_name();
     out_name.append(".h5");
     H5Node outfile(out_name, H5Access::WRITE);
@@ -89,9 +96,18 @@ void generate_output()
 // Print the MOCC banner. Pretty!
 void print_banner();
 
-// Signal handler for SIGINT. Calls output() and quits
+// Signal handler for SIGINT. If the solver can write a checkpoint, ask it to
+// do so at the end of its current iteration. Otherwise, or if interrupted a
+// second time, calls output() and quits
 void int_handler(int p)
 {
+    if (!global::interrupted && solver && solver->handles_interrupt()) {
+        global::interrupted = 1;
+        std::cout << "Caught SIGINT. Writing a checkpoint after the current "
+                     "iteration. Interrupt again to bail immediately."
+                  << std::endl;
+        return;
+    }
     std::cout << "Caught SIGINT. Bailing." << std::endl;
     generate_output();
     std::exit(EXIT_FAILURE);
@@ -117,7 +133,9 @@ int run(const std::vector<std::string> &args)
 {
     std::signal(SIGINT, int_handler);
 
-    print_banner();
+    if (ParEnv.comm().is_root()) {
+        print_banner();
+    }
 
     try {
         RootTimer.tic();
@@ -126,8 +144,12 @@ int run(const std::vector<std::string> &args)
         input_proc.reset(new InputProcessor(args));
 
         // Spin up the log file. We do this after we peek at the input
-        // processor for a case_name tag
-        StartLogFile(input_proc->case_name());
+        // processor for a case_name tag. Only the root process logs.
+        if (ParEnv.comm().is_root()) {
+            StartLogFile(input_proc->case_name());
+        } else {
+            LogScreen.reset(NullStream, NullStream);
+        }
 
         LogScreen << "Running case: " << input_proc->case_name() << std::endl;
         LogScreen << "Using MOCC executable built with GIT SHA1: " << g_GIT_SHA1
@@ -137,6 +159,10 @@ int run(const std::vector<std::string> &args)
             time(&t);
             LogScreen << "Local time: " << ctime(&t);
         }
+        if (ParEnv.comm().size() > 1) {
+            LogScreen << "Running with " << ParEnv.comm().size()
+                      << " processes" << std::endl;
+        }
         LogScreen << std::endl << std::endl;
 
         // Actually process the XML input. We waited until now to do this,
@@ -169,6 +195,10 @@ int run(const std::vector<std::string> &args)
         RootTimer.print(LogFile);
 
         StopLogFile();
+
+        if (global::interrupted) {
+            return 1;
+        }
     }
 
     catch (Exception e) {
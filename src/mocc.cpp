@@ -16,8 +16,12 @@
 
 #include "driver.hpp"
 #include "util/error.hpp"
+#include "core/parallel_environment.hpp"
 
 int main(int argc, char *argv[])
 {
-    return run(argc, argv);
+    mocc::ParEnv.start(argc, argv);
+    int result = run(argc, argv);
+    mocc::ParEnv.stop();
+    return result;
 }
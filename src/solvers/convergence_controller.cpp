@@ -0,0 +1,191 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "convergence_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include "pugixml.hpp"
+#include "util/error.hpp"
+#include "util/files.hpp"
+#include "util/fp_utils.hpp"
+#include "util/validate_input.hpp"
+
+namespace {
+const std::vector<std::string> recognized_attributes = {
+    "inner", "tol_factor", "tol_floor", "stall", "cmfd_min_iter"};
+}
+
+namespace mocc {
+ConvergenceController::ConvergenceController(const pugi::xml_node &input,
+                                             real_t tolerance_k,
+                                             real_t tolerance_psi,
+                                             TransportSweeper *sweeper,
+                                             CMFD *cmfd)
+    : sweeper_(sweeper),
+      cmfd_(cmfd),
+      tolerance_k_(tolerance_k),
+      tolerance_psi_(tolerance_psi),
+      cmfd_max_iter_(cmfd ? cmfd->max_iter() : 0)
+{
+    assert(sweeper);
+
+    validate_input(input, recognized_attributes);
+
+    control_inner_ = input.attribute("inner").as_bool(true);
+    tol_factor_    = input.attribute("tol_factor").as_float(1.0e-3);
+    tol_floor_     = input.attribute("tol_floor").as_float(0.1);
+    stall_         = input.attribute("stall").as_float(0.8);
+    cmfd_min_iter_ = input.attribute("cmfd_min_iter").as_int(10);
+
+    if ((tol_factor_ <= 0.0) || (tol_factor_ > 1.0)) {
+        throw EXCEPT("Adaptive CMFD tolerance factor must be in (0, 1].");
+    }
+    if ((tol_floor_ <= 0.0) || (tol_floor_ > 1.0)) {
+        throw EXCEPT("Adaptive CMFD tolerance floor must be in (0, 1].");
+    }
+    if ((stall_ <= 0.0) || (stall_ > 1.0)) {
+        throw EXCEPT("Adaptive stall ratio must be in (0, 1].");
+    }
+    if (cmfd_min_iter_ < 1) {
+        throw EXCEPT("Invalid minimum number of CMFD iterations.");
+    }
+    cmfd_min_iter_ = std::min(cmfd_min_iter_, std::max(cmfd_max_iter_, 1));
+
+    LogFile << "Adaptive convergence control enabled" << std::endl;
+
+    this->initialize();
+
+    return;
+}
+
+void ConvergenceController::initialize()
+{
+    n_update_       = 0;
+    error_k_        = tolerance_k_;
+    error_psi_      = tolerance_psi_;
+    r0_             = 1.0;
+    r_prev_         = 1.0;
+    progress_       = 0.0;
+    inner_fraction_ = 0.0;
+
+    if (control_inner_) {
+        sweeper_->set_inner_fraction(inner_fraction_);
+    }
+    if (cmfd_) {
+        cmfd_->set_max_iter(cmfd_max_iter_);
+    }
+
+    return;
+}
+
+void ConvergenceController::update(real_t error_k, real_t error_psi)
+{
+    error_k_   = error_k;
+    error_psi_ = error_psi;
+
+    real_t r = std::max(error_k / tolerance_k_, error_psi / tolerance_psi_);
+    if (n_update_ == 0) {
+        r0_ = r;
+    }
+    n_update_++;
+
+    if (r0_ > 1.0) {
+        progress_ = std::log(r0_ / std::max(r, REAL_FUZZ)) / std::log(r0_);
+        progress_ = std::min((real_t)1.0, std::max((real_t)0.0, progress_));
+    } else {
+        progress_ = 1.0;
+    }
+
+    bool stalled = (n_update_ > 1) && (r > stall_ * r_prev_);
+    r_prev_      = r;
+
+    LogFile << "Adaptive convergence: progress " << std::setprecision(4)
+            << progress_ << (stalled ? " (stalled)" : "") << std::endl;
+
+    if (control_inner_) {
+        inner_fraction_ = std::max(inner_fraction_, progress_);
+        if (stalled) {
+            inner_fraction_ = std::min((real_t)1.0, 2 * inner_fraction_);
+        }
+        LogFile << "Adaptive convergence: inner iteration fraction "
+                << inner_fraction_ << std::endl;
+        sweeper_->set_inner_fraction(inner_fraction_);
+    }
+
+    if (cmfd_) {
+        int max_iter = std::max(
+            cmfd_min_iter_, (int)std::ceil(progress_ * cmfd_max_iter_));
+        if (!cmfd_->converged()) {
+            max_iter = std::max(
+                max_iter, std::min(cmfd_max_iter_, 2 * cmfd_->max_iter()));
+        }
+        cmfd_->set_max_iter(max_iter);
+    }
+
+    return;
+}
+
+void ConvergenceController::checkpoint(H5Node &node) const
+{
+    node.write("n_update", n_update_);
+    node.write("state", VecF({error_k_, error_psi_, r0_, r_prev_, progress_,
+                              inner_fraction_}));
+    return;
+}
+
+void ConvergenceController::restart(H5Node &node)
+{
+    std::vector<double> state;
+    node.read("n_update", n_update_);
+    node.read("state", state);
+    if (state.size() != 6) {
+        throw EXCEPT("Incorrect adaptive convergence state in checkpoint.");
+    }
+    error_k_        = state[0];
+    error_psi_      = state[1];
+    r0_             = state[2];
+    r_prev_         = state[3];
+    progress_       = state[4];
+    inner_fraction_ = state[5];
+
+    if (control_inner_) {
+        sweeper_->set_inner_fraction(inner_fraction_);
+    }
+    return;
+}
+
+void ConvergenceController::apply_cmfd_criteria()
+{
+    assert(cmfd_);
+
+    real_t k_tol =
+        std::max(error_k_ * tol_factor_, tolerance_k_ * tol_floor_);
+    real_t psi_tol =
+        std::max(error_psi_ * tol_factor_, tolerance_psi_ * tol_floor_);
+    cmfd_->set_k_tolerance(k_tol);
+    cmfd_->set_psi_tolerance(psi_tol);
+
+    auto flags = LogFile.flags();
+    LogFile << "Adaptive convergence: CMFD k_tol " << std::scientific << k_tol
+            << " psi_tol " << psi_tol << " max_iter " << cmfd_->max_iter()
+            << std::endl;
+    LogFile.flags(flags);
+
+    return;
+}
+}
@@ -0,0 +1,137 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <memory>
+#include "util/global_config.hpp"
+#include "util/h5file.hpp"
+#include "util/pugifwd.hpp"
+#include "core/cmfd.hpp"
+#include "core/transport_sweeper.hpp"
+
+namespace mocc {
+/**
+ * \brief Adaptive control of the inexact iterations nested within the outer
+ * iterations of an \ref EigenSolver.
+ *
+ * Early in the outer iteration process there is little to be gained from
+ * converging the CMFD eigenvalue problem or the within-group transport
+ * problems tightly, since the sources that drive them are still far from
+ * converged. The controller measures the progress of the outer iteration as
+ *
+ * \f[
+ *   p = \frac{\log(r_0 / r)}{\log r_0},
+ * \f]
+ *
+ * where \f$ r \f$ is the larger of the eigenvalue and fission source errors,
+ * each relative to its convergence tolerance, and \f$ r_0 \f$ is the value of
+ * \f$ r \f$ after the first outer iteration. \f$ p \f$ goes from zero after
+ * the first outer iteration to one at convergence. From this:
+ *  - The CMFD eigenvalue and fission source tolerances follow the current
+ *    outer errors, scaled by a constant factor, but no looser than a fraction
+ *    of the outer tolerances. This is the \ref CMFDConvergence::FLOAT mode.
+ *  - The CMFD iteration limit is \f$ p \f$ times the limit specified in the
+ *    input, but no fewer than a minimum. If the last CMFD solve failed to
+ *    converge, the limit is at least doubled.
+ *  - The number of inner iterations performed by the sweeper is \f$ p \f$
+ *    times the number specified in the input (see \ref
+ *    TransportSweeper::set_inner_fraction()). The fraction never decreases,
+ *    and is doubled whenever the outer iteration stalls, since the stall may
+ *    be caused by under-converged inner iterations.
+ *
+ * Before the first outer iteration, the CMFD solve uses the input iteration
+ * limit, and the sweeper performs a single inner iteration.
+ */
+class ConvergenceController {
+public:
+    /**
+     * \brief Construct a ConvergenceController
+     *
+     * \param input the \c \<adaptive\> XML node. May be empty, in which case
+     * defaults are used.
+     * \param tolerance_k the outer eigenvalue tolerance
+     * \param tolerance_psi the outer fission source tolerance
+     * \param sweeper the sweeper, the inner iterations of which to control
+     * \param cmfd the CMFD solver to control. May be null.
+     */
+    ConvergenceController(const pugi::xml_node &input, real_t tolerance_k,
+                          real_t tolerance_psi, TransportSweeper *sweeper,
+                          CMFD *cmfd);
+
+    /**
+     * \brief Reset the controller for a new eigenvalue solve.
+     */
+    void initialize();
+
+    /**
+     * \brief Update the controlled parameters from the errors of the last
+     * outer iteration.
+     */
+    void update(real_t error_k, real_t error_psi);
+
+    /**
+     * \brief Set the convergence criteria for the next CMFD solve.
+     */
+    void apply_cmfd_criteria();
+
+    /**
+     * \brief Write the state of the controller to a checkpoint.
+     */
+    void checkpoint(H5Node &node) const;
+
+    /**
+     * \brief Restore the state written by \ref checkpoint(), reapplying the
+     * inner iteration fraction to the sweeper. The CMFD state is restored by
+     * the CMFD solver itself.
+     */
+    void restart(H5Node &node);
+
+    /**
+     * \brief Return the current progress of the outer iteration, in [0, 1].
+     */
+    real_t progress() const
+    {
+        return progress_;
+    }
+
+private:
+    TransportSweeper *sweeper_;
+    CMFD *cmfd_;
+
+    real_t tolerance_k_;
+    real_t tolerance_psi_;
+
+    // Options
+    bool control_inner_;
+    real_t tol_factor_;
+    real_t tol_floor_;
+    real_t stall_;
+    int cmfd_min_iter_;
+    int cmfd_max_iter_;
+
+    // State
+    int n_update_;
+    real_t error_k_;
+    real_t error_psi_;
+    real_t r0_;
+    real_t r_prev_;
+    real_t progress_;
+    real_t inner_fraction_;
+};
+
+typedef std::unique_ptr<ConvergenceController> UP_ConvergenceController_t;
+}
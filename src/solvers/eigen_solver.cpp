@@ -16,6 +16,8 @@
 
 #include "eigen_solver.hpp"
 
+#include <algorithm>
+#include <cstdio>
 #include <iomanip>
 #include "pugixml.hpp"
 #include "util/error.hpp"
@@ -24,12 +26,27 @@
 #include "util/utils.hpp"
 #include "util/validate_input.hpp"
 #include "core/globals.hpp"
+#include "core/parallel_environment.hpp"
 
 const static int out_w = 14;
 
 namespace {
 const std::vector<std::string> recognized_attributes = {
-    "type", "cmfd", "k_tol", "psi_tol", "max_iter", "min_iter"};
+    "type",    "cmfd",     "anderson", "chebyshev",  "wielandt",
+    "k_tol",   "psi_tol",  "max_iter", "min_iter",   "adaptive",
+    "restart", "checkpoint"};
+
+const std::vector<std::string> recognized_attributes_initial_guess = {
+    "type", "file"};
+
+const std::vector<std::string> recognized_attributes_anderson = {
+    "depth", "damping", "growth"};
+
+const std::vector<std::string> recognized_attributes_chebyshev = {"order",
+                                                                  "delay"};
+
+const std::vector<std::string> recognized_attributes_wielandt = {
+    "shift", "adaptive", "min_shift"};
 }
 
 namespace mocc {
@@ -37,7 +54,16 @@ EigenSolver::EigenSolver(const pugi::xml_node &input, const CoreMesh &mesh)
     : fss_(input, mesh),
       fission_source_(fss_.sweeper()->n_reg_fission()),
       fission_source_prev_(fss_.sweeper()->n_reg_fission()),
-      min_iterations_(0)
+      fs_n_positive_(0),
+      fs_prev_n_positive_(0),
+      fs_sum_(0.0),
+      fs_prev_sum_(0.0),
+      min_iterations_(0),
+      wielandt_(false),
+      k_shift_(0.0),
+      checkpoint_interval_(0),
+      time_offset_(0.0),
+      initial_guess_(InitialGuess::FLAT)
 {
     LogFile << "Initializing Eigenvalue solver..." << std::endl;
 
@@ -81,6 +107,39 @@ EigenSolver::EigenSolver(const pugi::xml_node &input, const CoreMesh &mesh)
         min_iterations_ = in_int;
     }
 
+    // Checkpoint interval
+    if (!input.attribute("checkpoint").empty()) {
+        in_int = input.attribute("checkpoint").as_int(-1);
+        if (in_int < 0) {
+            throw EXCEPT("Invalid checkpoint interval.");
+        }
+        checkpoint_interval_ = in_int;
+    }
+
+    // Restart file
+    restart_file_ = input.attribute("restart").value();
+
+    // Initial guess
+    if (!input.child("initial_guess").empty()) {
+        auto guess_input = input.child("initial_guess");
+        validate_input(guess_input, recognized_attributes_initial_guess);
+        std::string type = guess_input.attribute("type").value();
+        sanitize(type);
+        if ((type == "flat") || type.empty()) {
+            initial_guess_ = InitialGuess::FLAT;
+        } else if (type == "ihm") {
+            initial_guess_ = InitialGuess::IHM;
+        } else if (type == "file") {
+            initial_guess_      = InitialGuess::FILE;
+            initial_guess_file_ = guess_input.attribute("file").value();
+            if (initial_guess_file_.empty()) {
+                throw EXCEPT("No file specified for initial guess.");
+            }
+        } else {
+            throw EXCEPT("Unrecognized initial guess type: " + type);
+        }
+    }
+
     // Read in dump iterations if present
     if (!input.child("dump_iterations").empty()) {
         dump_iterations_ =
@@ -118,6 +177,70 @@ EigenSolver::EigenSolver(const pugi::xml_node &input, const CoreMesh &mesh)
         // Associate the sweeper with the coarse data from the CMFD solver
         CoarseData *const cd = cmfd_->get_data();
         fss_.sweeper()->set_coarse_data(cd);
+        fss_.sweeper()->set_cmfd(cmfd_.get());
+    }
+
+    // Anderson acceleration
+    if (input.attribute("anderson").as_bool(false)) {
+        auto anderson_input = input.child("anderson");
+        validate_input(anderson_input, recognized_attributes_anderson);
+        int depth      = anderson_input.attribute("depth").as_int(3);
+        real_t damping = anderson_input.attribute("damping").as_float(1.0);
+        real_t growth  = anderson_input.attribute("growth").as_float(2.0);
+        anderson_.reset(new AndersonMixer(depth, damping, growth));
+        LogFile << "Anderson acceleration enabled with depth " << depth
+                << std::endl;
+    }
+
+    // Chebyshev extrapolation
+    if (input.attribute("chebyshev").as_bool(false)) {
+        if (cmfd_ || anderson_) {
+            throw EXCEPT("Chebyshev extrapolation may not be combined with "
+                         "CMFD or Anderson acceleration.");
+        }
+        auto cheb_input = input.child("chebyshev");
+        validate_input(cheb_input, recognized_attributes_chebyshev);
+        int order = cheb_input.attribute("order").as_int(6);
+        int delay = cheb_input.attribute("delay").as_int(5);
+        chebyshev_.reset(new ChebyshevAccelerator(order, delay));
+        LogFile << "Chebyshev extrapolation enabled with order " << order
+                << std::endl;
+    }
+
+    // Wielandt shift
+    if (input.attribute("wielandt").as_bool(false)) {
+        auto wielandt_input = input.child("wielandt");
+        validate_input(wielandt_input, recognized_attributes_wielandt);
+        wielandt_          = true;
+        wielandt_shift_    = wielandt_input.attribute("shift").as_float(0.5);
+        wielandt_adaptive_ =
+            wielandt_input.attribute("adaptive").as_bool(false);
+        wielandt_min_shift_ = wielandt_input.attribute("min_shift").as_float(
+            0.1 * wielandt_shift_);
+        if (wielandt_shift_ <= 0.0) {
+            throw EXCEPT("Wielandt shift must be positive.");
+        }
+        if ((wielandt_min_shift_ <= 0.0) ||
+            (wielandt_min_shift_ > wielandt_shift_)) {
+            throw EXCEPT("Invalid minimum Wielandt shift.");
+        }
+        wielandt_delta_ = wielandt_shift_;
+        LogFile << "Wielandt shift enabled: " << wielandt_shift_ << std::endl;
+    }
+
+    // Adaptive convergence control
+    if (input.attribute("adaptive").as_bool(false)) {
+        CMFD *cmfd = (cmfd_ && cmfd_->is_enabled()) ? cmfd_.get() : nullptr;
+        controller_.reset(new ConvergenceController(
+            input.child("adaptive"), tolerance_k_, tolerance_psi_,
+            fss_.sweeper(), cmfd));
+    }
+
+    if ((anderson_ || chebyshev_) &&
+        ((checkpoint_interval_ > 0) || !restart_file_.empty())) {
+        Warn("Anderson and Chebyshev histories are not checkpointed. A "
+             "restarted solve will rebuild them, and will not reproduce the "
+             "uninterrupted iteration exactly.");
     }
 
     LogFile << "Done initializing Eigenvalue solver." << std::endl;
@@ -151,42 +274,50 @@ void EigenSolver::solve()
     error_k_   = tolerance_k_;   // K residual
     error_psi_ = tolerance_psi_; // L-2 norm of the fission source residual
 
+    // A restart supersedes the initial guess
+    if (restart_file_.empty()) {
+        this->apply_initial_guess();
+    }
+
     fss_.sweeper()->calc_fission_source(keff_, fission_source_);
 
+    if (controller_) {
+        controller_->initialize();
+    }
+
+    size_t n_start = 0;
+    if (!restart_file_.empty()) {
+        n_start = this->read_checkpoint();
+        LogScreen << "Restarting from " << restart_file_ << " after "
+                  << n_start << " iterations" << std::endl;
+    }
+
     LogScreen << std::setw(out_w) << "Time" << std::setw(out_w) << "Iter."
               << std::setw(out_w) << "k" << std::setw(out_w) << "k error"
               << std::setw(out_w) << "psi error" << std::endl;
 
-    auto dump_it       = dump_iterations_.begin();
+    auto dump_it = std::upper_bound(dump_iterations_.begin(),
+                                    dump_iterations_.end(), (int)n_start);
     unsigned next_dump = std::numeric_limits<unsigned>::max();
     if (dump_it != dump_iterations_.end()) {
         next_dump = *dump_it;
     }
 
-    for (size_t n_iterations = 0; n_iterations < max_iterations_;
+    for (size_t n_iterations = n_start; n_iterations < max_iterations_;
          n_iterations++) {
         this->step();
 
         // Check for convergence
-        error_k_ = fabs(keff_ - keff_prev_);
+        this->update_errors();
 
-        const auto &vol = fss_.sweeper()->volumes();
-        //assert(vol.size() == fission_source_.size());
-        Normalize(fission_source_.begin(), fission_source_.end());
-        Normalize(fission_source_prev_.begin(),
-                        fission_source_prev_.end());
-
-        real_t efis = 0.0;
-        for (int i = 0; i < (int)fss_.sweeper()->n_reg(); i++) {
-            real_t e = (fission_source_(i) - fission_source_prev_(i));
-            efis += e * e;
+        if (controller_) {
+            controller_->update(error_k_, error_psi_);
         }
-        error_psi_ = std::sqrt(efis / n_fissile_regions_);
 
         convergence_.push_back(
             ConvergenceCriteria(keff_, error_k_, error_psi_));
 
-        iteration_times_.push_back(RootTimer.time());
+        iteration_times_.push_back(time_offset_ + RootTimer.time());
 
         this->print(n_iterations + 1, convergence_.back());
 
@@ -212,13 +343,33 @@ void EigenSolver::solve()
                 << (n_iterations >= min_iterations_) << std::endl;
         if ((error_k_ < tolerance_k_) && (error_psi_ < tolerance_psi_) &&
             (n_iterations >= min_iterations_)) {
-            LogScreen << "Convergence criteria satisfied!" << std::endl;
-            break;
+            // Groups that were skipped by selective sweeps may be hiding a
+            // residual, so make sure that the last step swept all of them
+            if (fss_.full_sweep()) {
+                LogScreen << "Convergence criteria satisfied!" << std::endl;
+                break;
+            }
+            LogFile << "Forcing a full sweep before declaring convergence"
+                    << std::endl;
+            fss_.force_full_sweep();
         }
 
         if (n_iterations == (max_iterations_ - 1)) {
             LogScreen << "Maximum number of iterations reached!" << std::endl;
         }
+
+        // Write a checkpoint periodically, or if interrupted, in which case
+        // bail
+        bool interrupted = global::interrupted;
+        if (interrupted || ((checkpoint_interval_ > 0) &&
+                            ((n_iterations + 1) % checkpoint_interval_ == 0))) {
+            this->write_checkpoint(n_iterations + 1);
+        }
+        if (interrupted) {
+            LogScreen << "Interrupted. Solve may be resumed with restart=\""
+                      << this->checkpoint_file() << "\"" << std::endl;
+            break;
+        }
     }
 } // solve()
 
@@ -229,29 +380,276 @@ void EigenSolver::step()
         this->do_cmfd();
     }
 
-    // Perform a group sweep with the FSS
-    // We are recalculating the fission source perhaps more than necessary.
-    // Make if we want to remove redundant calculations, make sure that it will
-    // jive with the normalization that is being done for the convergence
-    // criterion.
+    // The fission source left by the last step has been normalized in place
+    // by update_errors(), and CMFD may have just changed the flux, so rebuild
+    // it from the current flux and eigenvalue
     fss_.sweeper()->calc_fission_source(keff_, fission_source_);
-    fission_source_prev_ = fission_source_;
+    if (anderson_) {
+        this->do_anderson();
+    }
+    if (chebyshev_) {
+        this->do_chebyshev();
+    }
+    if (wielandt_) {
+        this->apply_wielandt_shift();
+    }
+
+    // Keep the previous fission source, counting and summing it for the
+    // normalization in update_errors() along the way
+    {
+        const int n      = fission_source_.size();
+        const real_t *fs = fission_source_.data();
+        real_t *fs_prev  = fission_source_prev_.data();
+        int n_pos        = 0;
+        real_t sum       = 0.0;
+        assert(fission_source_.isStorageContiguous());
+        assert(fission_source_prev_.isStorageContiguous());
+        assert((int)fission_source_prev_.size() == n);
+#pragma omp parallel for default(shared) reduction(+ : n_pos, sum)
+        for (int i = 0; i < n; i++) {
+            fs_prev[i] = fs[i];
+            n_pos += (fs[i] > 0.0) ? 1 : 0;
+            sum += fs[i];
+        }
+        fs_prev_n_positive_ = n_pos;
+        fs_prev_sum_        = sum;
+    }
     fss_.step();
 
-    // Get the total fission sources
-    real_t tfis1 = fss_.sweeper()->total_fission(false);
-    real_t tfis2 = fss_.sweeper()->total_fission(true);
+    // Get the total fission sources, along with the unscaled fission source
+    // of the new flux and what is needed to normalize it
+    auto totals  = fss_.sweeper()->update_fission_source(fission_source_);
+    real_t tfis1 = totals.current;
+    real_t tfis2 = totals.old;
 
     // update estimate for k
     keff_prev_ = keff_;
-    keff_      = keff_ * tfis1 / tfis2;
+    if (wielandt_) {
+        // Only the explicit part of the fission source is scaled by the
+        // eigenvalue update
+        keff_ = 1.0 / (1.0 / k_shift_ +
+                       (1.0 / keff_ - 1.0 / k_shift_) * tfis2 / tfis1);
+    } else {
+        keff_ = keff_ * tfis1 / tfis2;
+    }
 
     // update the fission source
-    fss_.sweeper()->calc_fission_source(keff_, fission_source_);
+    fission_source_ *= 1.0 / keff_;
+    fs_n_positive_ = totals.n_positive;
+    fs_sum_        = totals.sum / keff_;
+
+    return;
+}
+
+void EigenSolver::update_errors()
+{
+    error_k_ = fabs(keff_ - keff_prev_);
+
+    // Normalize both fission sources as Normalize() would, so that each sums
+    // to its number of positive entries, and compute the residual. The
+    // counts and sums were accumulated by step() as the sources were formed,
+    // leaving a single pass. The residual can't be folded into those passes,
+    // since it needs the normalization of the new source, which is only
+    // known once it is complete.
+    const int n    = fission_source_.size();
+    const int n_r  = fss_.sweeper()->n_reg();
+    real_t *fs     = fission_source_.data();
+    real_t *fs_old = fission_source_prev_.data();
+    assert(fission_source_.isStorageContiguous());
+    assert(fission_source_prev_.isStorageContiguous());
+    assert((int)fission_source_prev_.size() == n);
+
+    const real_t f     = (real_t)fs_n_positive_ / fs_sum_;
+    const real_t f_old = (real_t)fs_prev_n_positive_ / fs_prev_sum_;
+    real_t efis        = 0.0;
+#pragma omp parallel for default(shared) reduction(+ : efis)
+    for (int i = 0; i < n; i++) {
+        fs[i] *= f;
+        fs_old[i] *= f_old;
+        if (i < n_r) {
+            real_t e = fs[i] - fs_old[i];
+            efis += e * e;
+        }
+    }
+    error_psi_ = std::sqrt(efis / n_fissile_regions_);
 
     return;
 }
 
+std::string EigenSolver::checkpoint_file() const
+{
+    return global::case_name + "_checkpoint.h5";
+}
+
+void EigenSolver::write_checkpoint(int n_iterations) const
+{
+    if (!ParEnv.comm().is_root()) {
+        return;
+    }
+
+    std::string fname = this->checkpoint_file();
+    std::string tmp   = fname + ".tmp";
+    {
+        H5Node h5f(tmp, H5Access::WRITE);
+
+        h5f.write("iterations", n_iterations);
+        h5f.write("state",
+                  VecF({keff_, keff_prev_, error_k_, error_psi_,
+                        wielandt_ ? wielandt_delta_ : 0.0, k_shift_,
+                        iteration_times_.empty() ? 0.0
+                                                 : iteration_times_.back()}));
+        h5f.write("fission_source", fission_source_);
+        h5f.write("fission_source_prev", fission_source_prev_);
+
+        {
+            VecF k;
+            VecF error_k;
+            VecF error_psi;
+            for (auto &c : convergence_) {
+                k.push_back(c.k);
+                error_k.push_back(c.error_k);
+                error_psi.push_back(c.error_psi);
+            }
+            auto g = h5f.create_group("convergence");
+            g.write("k", k);
+            g.write("error_k", error_k);
+            g.write("error_psi", error_psi);
+            g.write("iteration_time", iteration_times_);
+        }
+
+        {
+            auto g = h5f.create_group("fss");
+            fss_.checkpoint(g);
+        }
+        if (cmfd_) {
+            auto g = h5f.create_group("cmfd");
+            cmfd_->checkpoint(g);
+        }
+        if (controller_) {
+            auto g = h5f.create_group("adaptive");
+            controller_->checkpoint(g);
+        }
+    }
+
+    if (std::rename(tmp.c_str(), fname.c_str()) != 0) {
+        throw EXCEPT("Failed to move checkpoint into place.");
+    }
+    LogFile << "Wrote checkpoint after " << n_iterations << " iterations to "
+            << fname << std::endl;
+
+    return;
+}
+
+void EigenSolver::apply_initial_guess()
+{
+    switch (initial_guess_) {
+    case InitialGuess::FLAT:
+        break;
+
+    case InitialGuess::IHM: {
+        real_t k_inf     = 1.0;
+        ArrayB1 spectrum = fss_.sweeper()->ihm_spectrum(k_inf);
+        fss_.sweeper()->initialize_spectrum(spectrum);
+        keff_      = k_inf;
+        keff_prev_ = k_inf;
+        LogScreen << "Initial guess from infinite medium spectrum, k-inf = "
+                  << k_inf << std::endl;
+    } break;
+
+    case InitialGuess::FILE: {
+        H5Node h5f(initial_guess_file_, H5Access::READ);
+        {
+            auto g = h5f["fss/sweeper"];
+            fss_.sweeper()->warm_start(g);
+        }
+
+        std::vector<double> state;
+        h5f.read("state", state);
+        if (state.empty() || (state[0] <= 0.0)) {
+            throw EXCEPT("Invalid eigenvalue in initial guess file.");
+        }
+        keff_      = state[0];
+        keff_prev_ = state[0];
+
+        // The coarse currents (and thereby the CMFD coupling coefficients)
+        // are only reusable if the coarse mesh is the same
+        if (cmfd_) {
+            if (cmfd_->get_data()->compatible(h5f, "cmfd/coarse_data")) {
+                auto g = h5f["cmfd/coarse_data"];
+                cmfd_->get_data()->restart(g);
+            } else {
+                LogFile << "Coarse data in " << initial_guess_file_
+                        << " not compatible; not used for initial guess."
+                        << std::endl;
+            }
+        }
+        LogScreen << "Initial guess from " << initial_guess_file_
+                  << ", k = " << keff_ << std::endl;
+    } break;
+    }
+
+    return;
+}
+
+int EigenSolver::read_checkpoint()
+{
+    H5Node h5f(restart_file_, H5Access::READ);
+
+    int n_iterations = 0;
+    h5f.read("iterations", n_iterations);
+
+    std::vector<double> state;
+    h5f.read("state", state);
+    if (state.size() != 7) {
+        throw EXCEPT("Invalid eigenvalue state in checkpoint.");
+    }
+    keff_      = state[0];
+    keff_prev_ = state[1];
+    error_k_   = state[2];
+    error_psi_ = state[3];
+    if (wielandt_) {
+        wielandt_delta_ = state[4];
+    }
+    k_shift_     = state[5];
+    time_offset_ = state[6];
+
+    h5f.read("fission_source", fission_source_);
+    h5f.read("fission_source_prev", fission_source_prev_);
+
+    {
+        auto g = h5f["convergence"];
+        std::vector<double> k;
+        std::vector<double> error_k;
+        std::vector<double> error_psi;
+        std::vector<double> times;
+        g.read("k", k);
+        g.read("error_k", error_k);
+        g.read("error_psi", error_psi);
+        g.read("iteration_time", times);
+        convergence_.clear();
+        for (unsigned i = 0; i < k.size(); i++) {
+            convergence_.push_back(
+                ConvergenceCriteria(k[i], error_k[i], error_psi[i]));
+        }
+        iteration_times_.assign(times.begin(), times.end());
+    }
+
+    {
+        auto g = h5f["fss"];
+        fss_.restart(g);
+    }
+    if (cmfd_) {
+        auto g = h5f["cmfd"];
+        cmfd_->restart(g);
+    }
+    if (controller_) {
+        auto g = h5f["adaptive"];
+        controller_->restart(g);
+    }
+
+    return n_iterations;
+}
+
 void EigenSolver::print(int iter, ConvergenceCriteria conv)
 {
     LogScreen << std::setw(out_w) << std::fixed << std::setprecision(5)
@@ -266,22 +664,19 @@ void EigenSolver::do_cmfd()
     assert(cmfd_->is_enabled());
     // push homogenized flux onto the coarse mesh, solve, and pull it
     // back.
-    cmfd_->coarse_data().flux =
-        fss_.sweeper()->get_pin_flux(MeshTreatment::PIN_PLANE);
-
-    // Set the convergence criteria for this solve, there are a few ways we
-    // can do this. This needs some work. Should probably be converging the
-    // CMFD-transport sweeper residual, rather than the actual CMFD solution.
-    CMFDConvergence conv = CMFDConvergence::FIXED;
+    fss_.sweeper()->get_pin_flux(cmfd_->coarse_data().flux,
+                                 MeshTreatment::PIN_PLANE);
+
+    // Set the convergence criteria for this solve. Unless adaptive
+    // convergence control is enabled, use those from the input. Otherwise,
+    // let the controller float them with the outer iteration errors.
+    CMFDConvergence conv =
+        controller_ ? CMFDConvergence::FLOAT : CMFDConvergence::FIXED;
     switch (conv) {
     case CMFDConvergence::FIXED:
         break;
     case CMFDConvergence::FLOAT:
-        real_t k_tol = std::max(error_k_ / 1000.0, tolerance_k_ / 10.0);
-        cmfd_->set_k_tolerance(k_tol);
-
-        real_t psi_tol = std::max(error_psi_ / 1000.0, tolerance_psi_ / 10.0);
-        cmfd_->set_psi_tolerance(psi_tol);
+        controller_->apply_cmfd_criteria();
         break;
     }
     cmfd_->solve(keff_);
@@ -290,6 +685,140 @@ void EigenSolver::do_cmfd()
     return;
 }
 
+/**
+ * The fixed-point map that is accelerated takes the fission source shape and
+ * eigenvalue that are fed to a transport sweep to those that are fed to the
+ * next one, including the effects of CMFD if it is enabled. The shape is
+ * scaled so that its residual is comparable to that of the eigenvalue.
+ */
+void EigenSolver::do_anderson()
+{
+    assert(anderson_);
+    int n        = fission_source_.size();
+    real_t scale = 1.0 / std::sqrt((real_t)n_fissile_regions_);
+
+    real_t production = this->fission_production();
+    ArrayB1 shape     = this->fission_shape();
+
+    VectorX g(n + 1);
+    for (int i = 0; i < n; i++) {
+        g[i] = shape(i) * scale;
+    }
+    g[n] = keff_;
+
+    VectorX x = anderson_->mix(g);
+
+    // Fall back to the unmixed iterate if the mixing produced something
+    // unphysical.
+    if (!(x[n] > 0.0)) {
+        LogFile << "Anderson produced a non-positive eigenvalue. Restarting."
+                << std::endl;
+        anderson_->reset();
+        x = anderson_->mix(g);
+    }
+
+    real_t k = x[n];
+    for (int i = 0; i < n; i++) {
+        shape(i) = x[i];
+    }
+    if (this->set_fission_shape(shape, production, k)) {
+        keff_ = k;
+    }
+
+    return;
+}
+
+/**
+ * The dominance ratio is estimated from the ratio of successive fission
+ * source residuals in the convergence history.
+ */
+void EigenSolver::do_chebyshev()
+{
+    assert(chebyshev_);
+    int n = fission_source_.size();
+
+    real_t production = this->fission_production();
+    ArrayB1 shape     = this->fission_shape();
+
+    VectorX g(n);
+    for (int i = 0; i < n; i++) {
+        g[i] = shape(i);
+    }
+
+    real_t residual =
+        convergence_.empty() ? 0.0 : convergence_.back().error_psi;
+    VectorX x = chebyshev_->extrapolate(g, residual);
+
+    for (int i = 0; i < n; i++) {
+        shape(i) = x[i];
+    }
+    this->set_fission_shape(shape, production, keff_);
+
+    return;
+}
+
+/**
+ * In adaptive mode, the shift is halved (down to the minimum) after each
+ * iteration that reduces the fission source residual, and doubled (up to the
+ * initial shift) after each iteration that increases it.
+ */
+void EigenSolver::apply_wielandt_shift()
+{
+    int n_conv = convergence_.size();
+    if (wielandt_adaptive_ && (n_conv > 1)) {
+        if (convergence_[n_conv - 1].error_psi <
+            convergence_[n_conv - 2].error_psi) {
+            wielandt_delta_ =
+                std::max(wielandt_min_shift_, 0.5 * wielandt_delta_);
+        } else {
+            wielandt_delta_ = std::min(wielandt_shift_, 2.0 * wielandt_delta_);
+        }
+    }
+
+    k_shift_ = keff_ + wielandt_delta_;
+
+    // Only the part of the fission source that is not treated implicitly
+    // remains in the explicit source
+    fission_source_ *= 1.0 - keff_ / k_shift_;
+    fss_.set_fission_shift(k_shift_);
+
+    return;
+}
+
+real_t EigenSolver::fission_production() const
+{
+    const auto &vol   = fss_.sweeper()->volumes();
+    real_t production = 0.0;
+    for (int i = 0; i < (int)fission_source_.size(); i++) {
+        production += fission_source_(i) * vol[i];
+    }
+    return production * keff_;
+}
+
+ArrayB1 EigenSolver::fission_shape() const
+{
+    ArrayB1 shape(fission_source_.copy());
+    Normalize(shape.begin(), shape.end());
+    return shape;
+}
+
+bool EigenSolver::set_fission_shape(ArrayB1 &shape, real_t production,
+                                    real_t k)
+{
+    const auto &vol = fss_.sweeper()->volumes();
+    real_t total    = 0.0;
+    for (int i = 0; i < (int)shape.size(); i++) {
+        shape(i) = std::max(shape(i), (real_t)0.0);
+        total += shape(i) * vol[i];
+    }
+    if (!(total > 0.0)) {
+        return false;
+    }
+
+    fission_source_ = shape * (production / (k * total));
+    return true;
+}
+
 void EigenSolver::output(H5Node &file) const
 {
     VecF k;
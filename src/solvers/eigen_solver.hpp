@@ -17,19 +17,29 @@
 #pragma once
 
 #include <iosfwd>
+#include <memory>
 #include "util/h5file.hpp"
 #include "util/pugifwd.hpp"
+#include "core/anderson_mixer.hpp"
+#include "core/chebyshev_accelerator.hpp"
 #include "core/cmfd.hpp"
 #include "core/core_mesh.hpp"
 #include "core/eigen_interface.hpp"
 #include "core/transport_sweeper.hpp"
+#include "convergence_controller.hpp"
 #include "fixed_source_solver.hpp"
 #include "solver.hpp"
 
 namespace mocc {
 enum class CMFDConvergence {
     FIXED, // Converge the cmfd to a fixed set of convergence criteria
-    FLOAT
+    FLOAT  // Float the criteria with the outer errors (ConvergenceController)
+};
+
+enum class InitialGuess {
+    FLAT, // Flat scalar flux and unit eigenvalue
+    IHM,  // Spectrum and eigenvalue of the infinite homogeneous medium
+    FILE  // Flux and eigenvalue from a previous run's checkpoint file
 };
 
 struct ConvergenceCriteria {
@@ -48,18 +58,51 @@ struct ConvergenceCriteria {
 class EigenSolver : public Solver {
 public:
     EigenSolver(const pugi::xml_node &input, const CoreMesh &mesh);
-    void solve();
-    void step();
+    void solve() override;
+    void step() override;
 
     const TransportSweeper *sweeper() const
     {
         return fss_.sweeper();
     }
 
+    /**
+     * \brief Return a pointer to the \ref TransportSweeper. Use with care.
+     */
+    TransportSweeper *sweeper()
+    {
+        return fss_.sweeper();
+    }
+
+    /**
+     * \brief Return the current estimate of the eigenvalue
+     */
+    real_t keff() const
+    {
+        return keff_;
+    }
+
+    /**
+     * \brief Return the convergence criteria of each outer iteration so far
+     */
+    const std::vector<ConvergenceCriteria> &convergence() const
+    {
+        return convergence_;
+    }
+
     // Implement the output interface
     void output(H5Node &file) const;
 
-private:
+    /**
+     * \brief The eigenvalue solver writes a checkpoint and returns when
+     * interrupted.
+     */
+    bool handles_interrupt() const override
+    {
+        return true;
+    }
+
+protected:
     // Data
     FixedSourceSolver fss_;
 
@@ -67,6 +110,14 @@ private:
     ArrayB1 fission_source_;
     ArrayB1 fission_source_prev_;
 
+    // Number of positive entries in, and sum of, the fission source and the
+    // previous iterate, as of the last call to step(). Used to normalize them
+    // in update_errors().
+    int fs_n_positive_;
+    int fs_prev_n_positive_;
+    real_t fs_sum_;
+    real_t fs_prev_sum_;
+
     // Current guess for k
     real_t keff_;
 
@@ -97,6 +148,27 @@ private:
     // CMFD accelerator
     UP_CMFD_t cmfd_;
 
+    // Anderson mixing of the fission source and eigenvalue. Null if not
+    // enabled.
+    std::unique_ptr<AndersonMixer> anderson_;
+
+    // Chebyshev extrapolation of the fission source. Null if not enabled.
+    std::unique_ptr<ChebyshevAccelerator> chebyshev_;
+
+    // Adaptive control of the CMFD convergence criteria and inner
+    // iterations. Null if not enabled.
+    UP_ConvergenceController_t controller_;
+
+    // Wielandt shift parameters. The shifted eigenvalue is keff_ plus
+    // wielandt_delta_, which is fixed at wielandt_shift_ unless the shift is
+    // adaptive.
+    bool wielandt_;
+    bool wielandt_adaptive_;
+    real_t wielandt_shift_;
+    real_t wielandt_min_shift_;
+    real_t wielandt_delta_;
+    real_t k_shift_;
+
     // Vector in indices after which to dump the state of the solver
     VecI dump_iterations_;
 
@@ -104,13 +176,104 @@ private:
     // at. Make useful absiccae for convergence plots and the like
     VecF iteration_times_;
 
+    // Number of outer iterations between checkpoints. Zero to only write
+    // checkpoints when interrupted.
+    int checkpoint_interval_;
+
+    // Checkpoint file from which to resume the solve. Empty for a fresh
+    // start.
+    std::string restart_file_;
+
+    // Run time accumulated before a restart, added to iteration_times_
+    real_t time_offset_;
+
+    // Source of the initial flux and eigenvalue guess, and the file to use
+    // for InitialGuess::FILE
+    InitialGuess initial_guess_;
+    std::string initial_guess_file_;
+
     // Methods
     // Print the current state of the eigenvalue solver
     void print(int iter, ConvergenceCriteria conv);
 
+    /**
+     * \brief Compute the eigenvalue and fission source errors from the last
+     * call to \ref step().
+     *
+     * \note This normalizes the current and previous fission sources, using
+     * the counts and sums gathered by \ref step().
+     */
+    void update_errors();
+
+    /**
+     * \brief Return the name of the checkpoint file for this case.
+     */
+    std::string checkpoint_file() const;
+
+    /**
+     * \brief Write the complete iteration state of the solver to the
+     * checkpoint file, after the given number of outer iterations.
+     *
+     * The file is written under a temporary name and then moved into place,
+     * so that an existing checkpoint is never left half-written. Only the
+     * root process writes.
+     */
+    void write_checkpoint(int n_iterations) const;
+
+    /**
+     * \brief Restore the iteration state from \ref restart_file_, returning
+     * the number of outer iterations that had been performed.
+     */
+    int read_checkpoint();
+
+    /**
+     * \brief Replace the flat initial flux and eigenvalue with the guess
+     * specified by \ref initial_guess_.
+     */
+    void apply_initial_guess();
+
     /**
      * \brief Perform a CMFD accelerator solve
      */
     void do_cmfd();
+
+    /**
+     * \brief Apply Anderson mixing to the fission source and eigenvalue
+     * that are about to be used for a transport sweep.
+     */
+    void do_anderson();
+
+    /**
+     * \brief Apply Chebyshev extrapolation to the fission source that is
+     * about to be used for a transport sweep.
+     */
+    void do_chebyshev();
+
+    /**
+     * \brief Update the Wielandt shift, remove the implicit part from the
+     * fission source, and pass the shift to the \ref FixedSourceSolver.
+     */
+    void apply_wielandt_shift();
+
+    /**
+     * \brief Return the total fission production implied by the current
+     * fission source, without the 1/k factor.
+     */
+    real_t fission_production() const;
+
+    /**
+     * \brief Return the current fission source, normalized for comparison
+     * between iterations.
+     */
+    ArrayB1 fission_shape() const;
+
+    /**
+     * \brief Replace the fission source with the passed shape, scaled to the
+     * passed total production and eigenvalue.
+     *
+     * Negative values in \p shape are set to zero. Returns false, leaving the
+     * fission source unaltered, if the shape is not positive.
+     */
+    bool set_fission_shape(ArrayB1 &shape, real_t production, real_t k);
 };
 }
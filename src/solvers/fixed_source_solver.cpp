@@ -16,11 +16,16 @@
 
 #include "fixed_source_solver.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include "pugixml.hpp"
 #include "util/error.hpp"
 #include "util/files.hpp"
 #include "util/h5file.hpp"
+#include "util/omp_guard.h"
+#include "util/string_utils.hpp"
 #include "transport_sweeper_factory.hpp"
 
 namespace mocc {
@@ -30,6 +35,19 @@ FixedSourceSolver::FixedSourceSolver(const pugi::xml_node &input,
       source_(sweeper_->create_source(input.child("source"))),
       fs_(nullptr),
       ng_(sweeper_->n_group()),
+      k_shift_(0.0),
+      upscatter_begin_(ng_),
+      upscatter_max_iter_(1),
+      upscatter_tol_(1.0e-4),
+      jacobi_(false),
+      concurrent_(false),
+      n_teams_(ng_),
+      selective_(false),
+      selective_tol_(1.0e-6),
+      selective_period_(5),
+      selective_source_tol_(1.0e-4),
+      full_sweep_(true),
+      force_full_sweep_(false),
       fixed_source_(false) {
     LogFile << "Initializing Fixed-Source solver..." << std::endl;
 
@@ -68,6 +86,121 @@ FixedSourceSolver::FixedSourceSolver(const pugi::xml_node &input,
 
     sweeper_->assign_source(source_.get());
 
+    // CMFD acceleration. Only for a standalone FSS; otherwise this is handled
+    // by the solver that drives the FSS.
+    if (fixed_source_ && input.attribute("cmfd").as_bool(false)) {
+        cmfd_.reset(new CMFD(input.child("cmfd"), &mesh,
+                             sweeper_->get_homogenized_xsmesh()));
+        sweeper_->set_coarse_data(cmfd_->get_data());
+        sweeper_->set_cmfd(cmfd_.get());
+        this->homogenize_external_source(mesh);
+        LogFile << "Using fixed-source CMFD acceleration" << std::endl;
+    }
+
+    // Upscatter block treatment
+    upscatter_begin_ = this->find_upscatter_block();
+    if (!input.child("upscatter").empty()) {
+        auto up_input = input.child("upscatter");
+        std::string method = up_input.attribute("method").value();
+        sanitize(method);
+        if (method == "gmres") {
+            int krylov = up_input.attribute("krylov").as_int(10);
+            real_t tol = up_input.attribute("tol").as_float(1.0e-4);
+            if ((krylov < 1) || (tol <= 0.0)) {
+                throw EXCEPT("Invalid upscatter GMRES parameters.");
+            }
+            if (upscatter_begin_ < (int)ng_) {
+                upscatter_gmres_.reset(new TransportGMRES(krylov, tol));
+            }
+        } else if (method.empty() || (method == "gs")) {
+            upscatter_max_iter_ = up_input.attribute("max_iter").as_int(1);
+            upscatter_tol_      = up_input.attribute("tol").as_float(1.0e-4);
+            if ((upscatter_max_iter_ < 1) || (upscatter_tol_ <= 0.0)) {
+                throw EXCEPT("Invalid upscatter iteration parameters.");
+            }
+        } else {
+            throw EXCEPT("Unrecognized upscatter method: " + method);
+        }
+    }
+    LogFile << "Upscatter block starts at group " << upscatter_begin_;
+    if (upscatter_gmres_) {
+        LogFile << ", solved with GMRES";
+    } else if (upscatter_max_iter_ > 1) {
+        LogFile << ", iterated up to " << upscatter_max_iter_
+                << " times to a tolerance of " << upscatter_tol_;
+    }
+    LogFile << std::endl;
+
+    // Energy sweep treatment
+    if (!input.child("energy_sweep").empty()) {
+        auto energy_input = input.child("energy_sweep");
+        std::string method = energy_input.attribute("method").value();
+        sanitize(method);
+        if (method == "jacobi") {
+            jacobi_ = true;
+        } else if (!method.empty() && (method != "gs")) {
+            throw EXCEPT("Unrecognized energy sweep method: " + method);
+        }
+        n_teams_ = energy_input.attribute("teams").as_int(ng_);
+        if (n_teams_ < 1) {
+            throw EXCEPT("Invalid number of thread teams.");
+        }
+    }
+    if (jacobi_) {
+        if (upscatter_gmres_ || (upscatter_max_iter_ > 1)) {
+            throw EXCEPT("Jacobi energy sweeps are not compatible with an "
+                         "upscatter block treatment.");
+        }
+
+        group_sources_.reserve(ng_);
+        for (int ig = 0; ig < (int)ng_; ig++) {
+            group_sources_.push_back(
+                sweeper_->create_source(input.child("source")));
+            if (fixed_source_) {
+                group_sources_.back()->add_external(input.child("source"));
+            }
+        }
+
+        concurrent_ = sweeper_->prepare_concurrent_groups();
+        if (concurrent_) {
+            n_teams_ = std::min(n_teams_, (int)ng_);
+            LogFile << "Using Jacobi energy sweeps, with " << n_teams_
+                    << " concurrent thread teams" << std::endl;
+        } else {
+            Warn("Sweeper does not support concurrent group sweeps. Groups "
+                 "will be swept in sequence.");
+            LogFile << "Using Jacobi energy sweeps" << std::endl;
+        }
+    }
+
+    // Selective group sweeps
+    if (!input.child("selective").empty()) {
+        auto sel_input = input.child("selective");
+        selective_     = sel_input.attribute("enabled").as_bool(true);
+        selective_tol_ = sel_input.attribute("tol").as_float(selective_tol_);
+        selective_period_ =
+            sel_input.attribute("period").as_int(selective_period_);
+        selective_source_tol_ = sel_input.attribute("source_tol")
+                                    .as_float(selective_source_tol_);
+        if ((selective_tol_ <= 0.0) || (selective_period_ < 1) ||
+            (selective_source_tol_ <= 0.0)) {
+            throw EXCEPT("Invalid selective group sweep parameters.");
+        }
+        if (selective_ && jacobi_) {
+            throw EXCEPT("Selective group sweeps are not compatible with "
+                         "Jacobi energy sweeps.");
+        }
+    }
+    if (selective_) {
+        group_resid_.resize(ng_, std::numeric_limits<real_t>::max());
+        n_skipped_.resize(ng_, 0);
+        last_source_.resize(ng_);
+        LogFile << "Skipping sweeps of groups with relative flux residual "
+                   "below "
+                << selective_tol_ << ", sweeping them at least every "
+                << selective_period_ << " steps" << std::endl;
+    }
+
     LogFile << "Done initializing Fixed-Source solver." << std::endl;
 
     return;
@@ -83,10 +216,19 @@ void FixedSourceSolver::solve()
     for (size_t iouter = 0; iouter < max_iter_; iouter++) {
         this->step();
 
+        if (cmfd_ && cmfd_->is_enabled()) {
+            this->do_cmfd();
+        }
+
         resid = sweeper_->flux_residual();
         LogScreen << iouter << " " << std::setprecision(15) << resid << std::endl;
 
         if (resid < flux_tol_) {
+            // Skipped groups do not contribute to the residual
+            if (!full_sweep_) {
+                this->force_full_sweep();
+                continue;
+            }
             break;
         }
     }
@@ -103,17 +245,222 @@ void FixedSourceSolver::step()
 {
     // Tell the sweeper to stash its old flux
     sweeper_->store_old_flux();
-    for (size_t ig = 0; ig < ng_; ig++) {
-        // Set up the source
-        source_->initialize_group(ig);
-        if (fs_) {
-            source_->fission(*fs_, ig);
+
+    if (jacobi_) {
+        this->step_jacobi();
+        return;
+    }
+
+    bool block = (upscatter_begin_ < (int)ng_) &&
+                 (upscatter_gmres_ || (upscatter_max_iter_ > 1));
+    int ng_gs = block ? upscatter_begin_ : ng_;
+    full_sweep_ = true;
+    // The shifted fission source is updated incrementally as groups are
+    // swept, starting from the flux of the last step
+    this->calc_shifted_fission_source();
+    for (int ig = 0; ig < ng_gs; ig++) {
+        this->sweep_group(ig, selective_);
+    }
+    force_full_sweep_ = false;
+
+    if (block && !upscatter_gmres_) {
+        // Iterate on the upscatter block alone, until its flux stops
+        // changing. The fast groups are not swept again.
+        ArrayB2 block_flux = sweeper_->flux()(
+            blitz::Range::all(), blitz::Range(upscatter_begin_, ng_ - 1));
+        ArrayB2 block_flux_old(block_flux.shape());
+        for (int iter = 0; iter < upscatter_max_iter_; iter++) {
+            block_flux_old = block_flux;
+            for (int ig = upscatter_begin_; ig < (int)ng_; ig++) {
+                this->sweep_group(ig);
+            }
+            real_t norm = 0.0;
+            real_t diff = 0.0;
+            auto it_old = block_flux_old.begin();
+            for (auto v : block_flux) {
+                real_t e = v - *it_old;
+                diff += e * e;
+                norm += v * v;
+                ++it_old;
+            }
+            if (std::sqrt(diff) <= upscatter_tol_ * std::sqrt(norm)) {
+                break;
+            }
         }
+    }
 
-        source_->in_scatter(ig);
+    if (upscatter_gmres_) {
+        // Converge the upscatter block as a single multigroup system, then
+        // sweep it once more from the converged flux to update boundary
+        // conditions, currents, etc. GMRES sets the block flux between
+        // sweeps, so the shifted fission source has to be rebuilt from it.
+        auto sweep_block = [&]() {
+            this->calc_shifted_fission_source();
+            for (int ig = upscatter_begin_; ig < (int)ng_; ig++) {
+                this->sweep_group(ig);
+            }
+        };
+        upscatter_gmres_->solve(
+            sweeper_->flux()(blitz::Range::all(),
+                             blitz::Range(upscatter_begin_, ng_ - 1)),
+            sweep_block, *sweeper_);
+        sweep_block();
+    }
+}
+
+void FixedSourceSolver::step_jacobi()
+{
+    // The fission source is the same for all groups, including the implicit
+    // part from a Wielandt shift
+    const ArrayB1 *fs = fs_;
+    if (fs_ && (k_shift_ > 0.0)) {
+        this->calc_shifted_fission_source();
+        fs = &fs_shifted_;
+    }
+
+    // Set up all of the group sources before sweeping any groups
+    for (int ig = 0; ig < (int)ng_; ig++) {
+        group_sources_[ig]->group_source(ig, fs);
+    }
+
+    if (concurrent_) {
+        // Split the threads into teams, and enable nested parallelism so that
+        // each team may use its threads within its group sweeps
+        int team_size = std::max(1, omp_get_max_threads() / n_teams_);
+        int levels    = omp_get_max_active_levels();
+        omp_set_max_active_levels(std::max(levels, 2));
+
+#pragma omp parallel for num_threads(n_teams_) schedule(dynamic, 1)
+        for (int ig = 0; ig < (int)ng_; ig++) {
+            omp_set_num_threads(team_size);
+            sweeper_->sweep_concurrent(ig, *group_sources_[ig]);
+        }
 
-        sweeper_->sweep(ig);
+        omp_set_max_active_levels(levels);
+    } else {
+        for (int ig = 0; ig < (int)ng_; ig++) {
+            sweeper_->assign_source(group_sources_[ig].get());
+            sweeper_->sweep(ig);
+        }
+        sweeper_->assign_source(source_.get());
     }
+
+    return;
+}
+
+void FixedSourceSolver::sweep_group(int ig, bool allow_skip)
+{
+    // Set up the source. The shifted fission source is kept current with the
+    // flux of the groups swept so far.
+    bool shift        = fs_ && (k_shift_ > 0.0);
+    const ArrayB1 *fs = shift ? &fs_shifted_ : fs_;
+    source_->group_source(ig, fs);
+
+    if (allow_skip) {
+        if (!this->needs_sweep(ig)) {
+            n_skipped_[ig]++;
+            full_sweep_ = false;
+            return;
+        }
+        last_source_[ig] = source_->get();
+        n_skipped_[ig]   = 0;
+    }
+
+    // Replace the contribution of this group to the shifted fission source
+    // with that of its new flux
+    if (shift) {
+        sweeper_->add_fission_source_1g(ig, -1.0 / k_shift_, fs_shifted_);
+    }
+    sweeper_->sweep(ig);
+    if (shift) {
+        sweeper_->add_fission_source_1g(ig, 1.0 / k_shift_, fs_shifted_);
+    }
+
+    if (allow_skip) {
+        group_resid_[ig] = sweeper_->flux_residual(ig);
+    }
+}
+
+void FixedSourceSolver::calc_shifted_fission_source()
+{
+    if (fs_ && (k_shift_ > 0.0)) {
+        sweeper_->calc_fission_source(k_shift_, fs_shifted_);
+        fs_shifted_ += *fs_;
+    }
+    return;
+}
+
+bool FixedSourceSolver::needs_sweep(int ig) const
+{
+    if (force_full_sweep_ || (group_resid_[ig] >= selective_tol_) ||
+        (n_skipped_[ig] + 1 >= selective_period_)) {
+        return true;
+    }
+
+    // Sweep anyway if the source has changed appreciably
+    const VectorX &source = source_->get();
+    real_t norm           = last_source_[ig].norm();
+    return (source - last_source_[ig]).norm() > selective_source_tol_ * norm;
+}
+
+int FixedSourceSolver::find_upscatter_block() const
+{
+    int begin = ng_;
+    for (const auto &xsr : sweeper_->xs_mesh()) {
+        for (int ig = 0; ig < begin; ig++) {
+            if (xsr.xsmacsc().to(ig).max_g > ig) {
+                begin = ig;
+                break;
+            }
+        }
+    }
+    return begin;
+}
+
+void FixedSourceSolver::homogenize_external_source(const CoreMesh &mesh)
+{
+    MeshTreatment treatment;
+    if (sweeper_->n_reg() == (int)mesh.n_reg(MeshTreatment::PIN)) {
+        treatment = MeshTreatment::PIN;
+    } else if (sweeper_->n_reg() == (int)mesh.n_reg(MeshTreatment::PLANE)) {
+        treatment = MeshTreatment::PLANE;
+    } else {
+        throw EXCEPT("Fixed-source CMFD is not supported for this sweeper.");
+    }
+
+    VecI cell        = mesh.coarse_cell_map(treatment);
+    const VecF &vol  = sweeper_->volumes();
+    const int n_cell = mesh.n_reg(MeshTreatment::PIN_PLANE);
+    VecF cell_vol(n_cell, 0.0);
+    for (int ireg = 0; ireg < (int)cell.size(); ireg++) {
+        cell_vol[cell[ireg]] += vol[ireg];
+    }
+
+    cmfd_source_.resize(n_cell, ng_);
+    cmfd_source_ = 0.0;
+    for (int ig = 0; ig < (int)ng_; ig++) {
+        // The Source starts each group from the external source
+        source_->initialize_group(ig);
+        const VectorX &q = source_->get();
+        for (int ireg = 0; ireg < (int)cell.size(); ireg++) {
+            cmfd_source_(cell[ireg], ig) += q[ireg] * vol[ireg];
+        }
+        for (int i = 0; i < n_cell; i++) {
+            cmfd_source_(i, ig) /= cell_vol[i];
+        }
+    }
+
+    return;
+}
+
+void FixedSourceSolver::do_cmfd()
+{
+    assert(cmfd_);
+    sweeper_->get_pin_flux(cmfd_->coarse_data().flux,
+                           MeshTreatment::PIN_PLANE);
+    cmfd_->solve_fixed_source(cmfd_source_);
+    sweeper_->set_pin_flux(cmfd_->flux(), MeshTreatment::PIN_PLANE);
+    return;
 }
 
 void FixedSourceSolver::output(H5Node &node) const
@@ -125,6 +472,63 @@ void FixedSourceSolver::output(H5Node &node) const
     node.write("eubounds", sweeper_->xs_mesh().eubounds(), VecI(1, ng_));
     
     sweeper_->output(node);                  
+
+    if (cmfd_) {
+        cmfd_->output(node);
+    }
+    return;
+}
+
+void FixedSourceSolver::checkpoint(H5Node &node) const
+{
+    {
+        auto g = node.create_group("sweeper");
+        sweeper_->checkpoint(g);
+    }
+
+    if (selective_) {
+        auto g = node.create_group("selective");
+        g.write("group_residual", group_resid_);
+        g.write("n_skipped", VecF(n_skipped_.begin(), n_skipped_.end()));
+        g.write("full_sweep", (int)full_sweep_);
+        g.write("force_full_sweep", (int)force_full_sweep_);
+        for (int ig = 0; ig < (int)ng_; ig++) {
+            const auto &q = last_source_[ig];
+            g.write(std::to_string(ig), q.data(), q.data() + q.size(),
+                    VecI(1, q.size()));
+        }
+    }
+    return;
+}
+
+void FixedSourceSolver::restart(H5Node &node)
+{
+    {
+        auto g = node["sweeper"];
+        sweeper_->restart(g);
+    }
+
+    if (selective_) {
+        auto g = node["selective"];
+        std::vector<double> v;
+        g.read("group_residual", v);
+        group_resid_.assign(v.begin(), v.end());
+        g.read("n_skipped", v);
+        n_skipped_.assign(v.begin(), v.end());
+        if (((int)group_resid_.size() != (int)ng_) ||
+            ((int)n_skipped_.size() != (int)ng_)) {
+            throw EXCEPT("Incorrect number of groups in checkpoint.");
+        }
+        int flag = 0;
+        g.read("full_sweep", flag);
+        full_sweep_ = flag;
+        g.read("force_full_sweep", flag);
+        force_full_sweep_ = flag;
+        for (int ig = 0; ig < (int)ng_; ig++) {
+            g.read(std::to_string(ig), v);
+            last_source_[ig] = Eigen::Map<VectorX>(v.data(), v.size());
+        }
+    }
     return;
 }
 }
@@ -16,10 +16,13 @@
 
 #pragma once
 
+#include <vector>
 #include "core/core_mesh.hpp"
 #include "util/h5file.hpp"
 #include "util/pugifwd.hpp"
+#include "core/cmfd.hpp"
 #include "core/source.hpp"
+#include "core/transport_gmres.hpp"
 #include "core/transport_sweeper.hpp"
 #include "solver.hpp"
 
@@ -77,6 +80,60 @@ public:
         fs_ = fs;
     }
 
+    /**
+     * \brief Set the eigenvalue shift to use for a Wielandt-shifted
+     * iteration.
+     *
+     * When the shift is positive, the fission source from the current flux,
+     * divided by \p k_shift, is added to the group-independent fission source.
+     * With Gauss-Seidel iteration in energy, this is updated after each group
+     * is swept, so that the flux in groups that have already been swept
+     * contributes implicitly. A value of zero disables the shift.
+     *
+     * \note Most of the fission spectrum lies in the fast groups, which are
+     * swept before the thermal groups that produce most of the fission
+     * source. The implicit part of a single Gauss-Seidel pass therefore
+     * mostly lags an outer iteration, and the shift is most effective with
+     * an iterated upscatter block or Jacobi sweeps, where the shifted source
+     * is reconstructed from the latest flux.
+     */
+    void set_fission_shift(real_t k_shift)
+    {
+        k_shift_ = k_shift;
+        if ((k_shift_ > 0.0) &&
+            ((int)fs_shifted_.size() != sweeper()->n_reg_fission())) {
+            fs_shifted_.resize(sweeper()->n_reg_fission());
+        }
+    }
+
+    /**
+     * \brief Return whether every group was swept during the last step.
+     *
+     * With selective group sweeps, this should be checked before declaring
+     * convergence.
+     */
+    bool full_sweep() const
+    {
+        return full_sweep_;
+    }
+
+    /**
+     * \brief Make sure that every group is swept during the next step.
+     */
+    void force_full_sweep()
+    {
+        force_full_sweep_ = true;
+    }
+
+    /**
+     * \brief Turn off selective group sweeps, for solvers that need every
+     * step to apply the same operator.
+     */
+    void disable_selective()
+    {
+        selective_ = false;
+    }
+
     /**
      * Return the number of mesh regions.
      */
@@ -108,7 +165,67 @@ public:
 
     void output(H5Node &node) const;
 
+    /**
+     * \brief Write the state of the sweeper and of the selective group
+     * sweeps to a checkpoint.
+     */
+    void checkpoint(H5Node &node) const;
+
+    /**
+     * \brief Restore the state written by \ref checkpoint()
+     */
+    void restart(H5Node &node);
+
 private:
+    /**
+     * \brief Set up the source for a single group and sweep it
+     *
+     * \param ig the group to sweep
+     * \param allow_skip whether the sweep may be skipped, if selective group
+     * sweeps are enabled and the group is deemed converged
+     */
+    void sweep_group(int ig, bool allow_skip = false);
+
+    /**
+     * \brief Compute the Wielandt-shifted fission source from the current
+     * flux, if a shift is in effect.
+     */
+    void calc_shifted_fission_source();
+
+    /**
+     * \brief Return whether the group needs to be swept, given its current
+     * source.
+     */
+    bool needs_sweep(int ig) const;
+
+    /**
+     * \brief Sweep all groups with Jacobi iteration in energy
+     *
+     * The sources for all groups are set up from the flux of the previous
+     * outer iteration before any group is swept, so that the group sweeps are
+     * independent. If the sweeper supports it, groups are swept concurrently
+     * by separate thread teams.
+     */
+    void step_jacobi();
+
+    /**
+     * \brief Return the first group of the thermal upscatter block, or the
+     * number of groups if there is no upscatter.
+     */
+    int find_upscatter_block() const;
+
+    /**
+     * \brief Volume-average the external source onto the CMFD mesh and store
+     * in \ref cmfd_source_.
+     */
+    void homogenize_external_source(const CoreMesh &mesh);
+
+    /**
+     * \brief Perform a fixed-source CMFD solve, using the currents tallied
+     * during the last step, and project the result to the sweeper.
+     */
+    void do_cmfd();
+
     UP_Sweeper_t sweeper_;
     UP_Source_t source_;
     // Pointer to the group-independent fission source. Usually comes from an
@@ -116,9 +233,49 @@ private:
     const ArrayB1 *fs_;
     size_t ng_;
 
+    // Wielandt shift, and storage for the shifted fission source
+    real_t k_shift_;
+    ArrayB1 fs_shifted_;
+
+    // First group of the upscatter block, and the GMRES solver to use for
+    // the block. Null if the block is swept with Gauss-Seidel.
+    int upscatter_begin_;
+    UP_TransportGMRES_t upscatter_gmres_;
+
+    // Maximum number of Gauss-Seidel iterations on the upscatter block per
+    // step, and the relative flux tolerance at which to stop
+    int upscatter_max_iter_;
+    real_t upscatter_tol_;
+
+    // Jacobi iteration in energy. Each group gets its own Source, so that the
+    // in-scatter sources can all be formed from the previous outer iteration
+    bool jacobi_;
+    bool concurrent_;
+    int n_teams_;
+    std::vector<UP_Source_t> group_sources_;
+
+    // Selective group sweeps. Groups with a relative flux residual below
+    // selective_tol_ are only swept every selective_period_ steps, or when
+    // their source has changed by more than selective_source_tol_ since they
+    // were last swept.
+    bool selective_;
+    real_t selective_tol_;
+    int selective_period_;
+    real_t selective_source_tol_;
+    VecF group_resid_;
+    VecI n_skipped_;
+    std::vector<VectorX> last_source_;
+    bool full_sweep_;
+    bool force_full_sweep_;
+
     // Stuff that we should only need if we are doing a standalone FS solve
     bool fixed_source_;
     size_t max_iter_;
     real_t flux_tol_;
+
+    // CMFD accelerator for a standalone FS solve, and the external source on
+    // the CMFD mesh
+    UP_CMFD_t cmfd_;
+    ArrayB2 cmfd_source_;
 };
 }
@@ -0,0 +1,308 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "jfnk_solver.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include "pugixml.hpp"
+#include "util/error.hpp"
+#include "util/files.hpp"
+#include "util/validate_input.hpp"
+
+const static int out_w = 14;
+
+namespace {
+const std::vector<std::string> recognized_attributes_jfnk = {
+    "n_power", "krylov", "forcing", "epsilon", "max_backtrack"};
+}
+
+namespace mocc {
+JFNKSolver::JFNKSolver(const pugi::xml_node &input, const CoreMesh &mesh)
+    : EigenSolver(input, mesh),
+      n_power_(3),
+      max_krylov_(20),
+      forcing_(1.0e-2),
+      epsilon_(1.0e-7),
+      max_backtrack_(3),
+      flux_scale_(1.0),
+      production_(1.0),
+      n_sweep_(0),
+      state_saved_(false)
+{
+    LogFile << "Initializing JFNK solver..." << std::endl;
+
+    if (anderson_ || chebyshev_) {
+        throw EXCEPT("Anderson and Chebyshev acceleration are not supported "
+                     "by the JFNK solver.");
+    }
+    if (controller_) {
+        throw EXCEPT("Adaptive convergence control is not supported by the "
+                     "JFNK solver.");
+    }
+    if (wielandt_) {
+        // The shift follows the eigenvalue from step to step, which would
+        // change the residual function between evaluations
+        throw EXCEPT("Wielandt shifts are not supported by the JFNK solver.");
+    }
+    if ((checkpoint_interval_ > 0) || !restart_file_.empty()) {
+        throw EXCEPT("Checkpoints are not supported by the JFNK solver.");
+    }
+
+    // The residual function needs every step to apply the same operator
+    fss_.disable_selective();
+
+    auto jfnk_input = input.child("jfnk");
+    validate_input(jfnk_input, recognized_attributes_jfnk);
+
+    n_power_       = jfnk_input.attribute("n_power").as_int(n_power_);
+    max_krylov_    = jfnk_input.attribute("krylov").as_int(max_krylov_);
+    forcing_       = jfnk_input.attribute("forcing").as_float(forcing_);
+    epsilon_       = jfnk_input.attribute("epsilon").as_float(epsilon_);
+    max_backtrack_ =
+        jfnk_input.attribute("max_backtrack").as_int(max_backtrack_);
+
+    if (n_power_ < 1) {
+        throw EXCEPT("JFNK needs at least one initial power iteration.");
+    }
+    if (max_krylov_ < 1) {
+        throw EXCEPT("Invalid Krylov subspace size.");
+    }
+    if ((forcing_ <= 0.0) || (forcing_ >= 1.0)) {
+        throw EXCEPT("JFNK forcing term must be in (0, 1).");
+    }
+    if (epsilon_ <= 0.0) {
+        throw EXCEPT("Invalid JFNK perturbation size.");
+    }
+    if (max_backtrack_ < 0) {
+        throw EXCEPT("Invalid number of JFNK line search steps.");
+    }
+
+    LogFile << "Done initializing JFNK solver." << std::endl;
+
+    return;
+}
+
+void JFNKSolver::solve()
+{
+    LogScreen << "Converging to: \n"
+                 "\t Eigenvalue: "
+              << tolerance_k_ << "\n"
+              << "\t Fission Source (L-2 norm): " << tolerance_psi_ << "\n"
+              << "\t Max Newton Iterations: " << max_iterations_ << "\n\n";
+
+    keff_      = 1.0;
+    keff_prev_ = 1.0;
+
+    fss_.initialize();
+    fss_.set_fission_source(&fission_source_);
+    fss_.sweeper()->calc_fission_source(keff_, fission_source_);
+
+    LogScreen << std::setw(out_w) << "Time" << std::setw(out_w) << "Iter."
+              << std::setw(out_w) << "k" << std::setw(out_w) << "k error"
+              << std::setw(out_w) << "psi error" << std::setw(out_w)
+              << "Sweeps" << std::endl;
+
+    auto record = [&](int iter) {
+        convergence_.push_back(
+            ConvergenceCriteria(keff_, error_k_, error_psi_));
+        iteration_times_.push_back(RootTimer.time());
+        LogScreen << std::setw(out_w) << std::fixed << std::setprecision(5)
+                  << RootTimer.time() << std::setw(out_w) << iter
+                  << convergence_.back() << std::setw(out_w) << n_sweep_
+                  << std::endl;
+    };
+
+    auto converged = [&](int iter) {
+        return (error_k_ < tolerance_k_) && (error_psi_ < tolerance_psi_) &&
+               (iter >= (int)min_iterations_);
+    };
+
+    // Power iterations to get into the neighborhood of the solution
+    int iter = 0;
+    for (int i = 0; i < n_power_; i++) {
+        this->step();
+        n_sweep_++;
+        this->update_errors();
+        record(++iter);
+    }
+
+    // Set up the scaling of the unknowns
+    const auto &flux = fss_.sweeper()->flux();
+    production_      = fss_.sweeper()->total_fission(false);
+    flux_scale_ = std::sqrt((real_t)flux.size()) /
+                  std::sqrt(blitz::sum(flux * flux));
+
+    VectorX x = this->pack();
+    VectorX f(x.size());
+
+    this->save_state();
+    this->residual(x, f);
+    real_t fnorm = f.norm();
+    this->update_errors();
+    record(++iter);
+
+    GMRES gmres(max_krylov_, forcing_);
+
+    for (int inewton = 0; inewton < (int)max_iterations_; inewton++) {
+        if (keff_ != keff_) {
+            throw EXCEPT("Eigenvalue is not a number. Giving up.");
+        }
+
+        if (converged(iter)) {
+            LogScreen << "Convergence criteria satisfied!" << std::endl;
+            break;
+        }
+
+        // Newton step. The operator approximates the Jacobian-vector product
+        // by a forward difference about x, restoring the saved state for
+        // each evaluation.
+        VectorX fp(x.size());
+        GMRES::Operator jacobian = [&](const VectorX &v, VectorX &jv) {
+            real_t vnorm = v.norm();
+            if (vnorm == 0.0) {
+                jv = VectorX::Zero(v.size());
+                return;
+            }
+            real_t eps = epsilon_ * (1.0 + x.norm()) / vnorm;
+            this->restore_state();
+            this->residual(x + eps * v, fp);
+            jv = (fp - f) / eps;
+        };
+
+        VectorX dx = VectorX::Zero(x.size());
+        gmres.solve(jacobian, -f, dx);
+
+        // Backtracking line search on the residual norm
+        real_t lambda = 1.0;
+        VectorX x_new = x + dx;
+        for (int i = 0; i <= max_backtrack_; i++) {
+            this->restore_state();
+            this->residual(x_new, fp);
+            if ((fp.norm() < fnorm) || (i == max_backtrack_)) {
+                break;
+            }
+            lambda *= 0.5;
+            x_new = x + lambda * dx;
+            LogFile << "JFNK line search: lambda = " << lambda << std::endl;
+        }
+        x = x_new;
+
+        // Evaluate the residual at the new iterate, starting from the state
+        // left by the line search. This also provides the convergence
+        // metrics for the iteration.
+        this->save_state();
+        this->residual(x, f);
+        fnorm = f.norm();
+        this->update_errors();
+        record(++iter);
+
+        if (inewton == ((int)max_iterations_ - 1)) {
+            LogScreen << "Maximum number of iterations reached!" << std::endl;
+        }
+    }
+
+    if (state_saved_) {
+        fss_.sweeper()->pop_state();
+        state_saved_ = false;
+    }
+
+    LogScreen << "Total transport sweeps: " << n_sweep_ << std::endl;
+
+    return;
+}
+
+void JFNKSolver::residual(const VectorX &x, VectorX &f)
+{
+    this->unpack(x);
+    this->step();
+    n_sweep_++;
+
+    // Normalize the new flux to the reference production
+    real_t scale = production_ / fss_.sweeper()->total_fission(false);
+    fss_.sweeper()->flux() *= scale;
+    fss_.sweeper()->mark_flux_dirty();
+
+    f = x - this->pack();
+
+    return;
+}
+
+VectorX JFNKSolver::pack() const
+{
+    const auto &flux = fss_.sweeper()->flux();
+    int n_reg        = flux.extent(0);
+    int n_group      = flux.extent(1);
+
+    VectorX x(n_reg * n_group + 1);
+    int i = 0;
+    for (int ireg = 0; ireg < n_reg; ireg++) {
+        for (int ig = 0; ig < n_group; ig++) {
+            x[i++] = flux(ireg, ig) * flux_scale_;
+        }
+    }
+    x[i] = keff_;
+
+    return x;
+}
+
+void JFNKSolver::unpack(const VectorX &x)
+{
+    auto &flux  = fss_.sweeper()->flux();
+    int n_reg   = flux.extent(0);
+    int n_group = flux.extent(1);
+    assert(x.size() == n_reg * n_group + 1);
+
+    int i = 0;
+    for (int ireg = 0; ireg < n_reg; ireg++) {
+        for (int ig = 0; ig < n_group; ig++) {
+            flux(ireg, ig) = x[i++] / flux_scale_;
+        }
+    }
+    fss_.sweeper()->mark_flux_dirty();
+    keff_ = x[i];
+
+    return;
+}
+
+void JFNKSolver::save_state()
+{
+    if (state_saved_) {
+        fss_.sweeper()->pop_state();
+    }
+    fss_.sweeper()->push_state();
+    state_saved_ = true;
+    if (cmfd_) {
+        const auto &cd = cmfd_->coarse_data();
+        cd_current_.reference(cd.current.copy());
+        cd_surface_flux_.reference(cd.surface_flux.copy());
+        cd_partial_current_.reference(cd.partial_current.copy());
+    }
+    return;
+}
+
+void JFNKSolver::restore_state()
+{
+    fss_.sweeper()->restore_state();
+    if (cmfd_) {
+        auto &cd           = cmfd_->coarse_data();
+        cd.current         = cd_current_;
+        cd.surface_flux    = cd_surface_flux_;
+        cd.partial_current = cd_partial_current_;
+    }
+    return;
+}
+}
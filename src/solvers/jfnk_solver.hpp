@@ -0,0 +1,117 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "util/pugifwd.hpp"
+#include "core/core_mesh.hpp"
+#include "core/eigen_interface.hpp"
+#include "core/gmres.hpp"
+#include "eigen_solver.hpp"
+
+namespace mocc {
+/**
+ * \brief Jacobian-free Newton-Krylov eigenvalue solver.
+ *
+ * The scalar flux and eigenvalue are treated together as the unknowns, x, of
+ * the nonlinear system F(x) = x - G(x) = 0, where G is a single outer
+ * iteration of the \ref EigenSolver: a CMFD solve (if enabled), a group
+ * sweep and an update of k, followed by normalization of the flux to a fixed
+ * total fission production. Since G contains the CMFD solve, CMFD acts as a
+ * nonlinear preconditioner for the Newton iteration.
+ *
+ * Each Newton step solves J dx = -F(x) with \ref GMRES, where the action of
+ * the Jacobian on a Krylov vector is approximated by a finite difference,
+ * costing one evaluation of G (and therefore one transport sweep) per Krylov
+ * vector. Since each sweep also updates the boundary angular flux and the
+ * coarse-mesh currents, this state is saved after each Newton step and
+ * restored before every evaluation of G within it, so that all evaluations
+ * in a Newton step see the same state.
+ */
+class JFNKSolver : public EigenSolver {
+public:
+    JFNKSolver(const pugi::xml_node &input, const CoreMesh &mesh);
+
+    void solve() override;
+
+    /**
+     * \brief JFNK does not support checkpoints, so interrupts bail
+     * immediately.
+     */
+    bool handles_interrupt() const override
+    {
+        return false;
+    }
+
+private:
+    /**
+     * \brief Save the sweeper and coarse data state, replacing any state
+     * previously saved by this solver
+     */
+    void save_state();
+
+    /**
+     * \brief Restore the sweeper and coarse data state
+     */
+    void restore_state();
+
+    /**
+     * \brief Evaluate the residual, F(x) = x - G(x)
+     */
+    void residual(const VectorX &x, VectorX &f);
+
+    /**
+     * \brief Pack the current flux and eigenvalue into a vector
+     */
+    VectorX pack() const;
+
+    /**
+     * \brief Unpack a vector into the flux and eigenvalue
+     */
+    void unpack(const VectorX &x);
+
+    // Number of power iterations to perform before starting Newton
+    int n_power_;
+
+    // Maximum Krylov subspace dimension for each Newton step
+    int max_krylov_;
+
+    // Relative tolerance for the GMRES solves
+    real_t forcing_;
+
+    // Relative size of the finite difference perturbation
+    real_t epsilon_;
+
+    // Maximum number of step halvings in the line search
+    int max_backtrack_;
+
+    // Scaling applied to the flux in the Newton unknowns, and the total
+    // fission production to which the flux is normalized
+    real_t flux_scale_;
+    real_t production_;
+
+    // Number of transport sweeps performed
+    int n_sweep_;
+
+    // Whether there is a state on the sweeper's stack from save_state()
+    bool state_saved_;
+
+    // Saved coarse data
+    ArrayB2 cd_current_;
+    ArrayB2 cd_surface_flux_;
+    blitz::Array<std::array<real_t, 2>, 2> cd_partial_current_;
+};
+}
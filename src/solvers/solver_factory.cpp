@@ -22,6 +22,7 @@
 #include "util/files.hpp"
 #include "eigen_solver.hpp"
 #include "fixed_source_solver.hpp"
+#include "jfnk_solver.hpp"
 #include "monte_carlo_eigenvalue_solver.hpp"
 
 namespace mocc {
@@ -41,6 +42,9 @@ SP_Solver_t SolverFactory(const pugi::xml_node &input, const CoreMesh &mesh)
     else if (type == "fixed_source") {
         solver = std::make_shared<FixedSourceSolver>(input, mesh);
     }
+    else if (type == "jfnk") {
+        solver = std::make_shared<JFNKSolver>(input, mesh);
+    }
     else if (type == "eigenvalue_mc") {
         solver = std::make_shared<mc::MonteCarloEigenvalueSolver>(input, mesh);
     }
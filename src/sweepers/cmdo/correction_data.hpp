@@ -74,6 +74,15 @@ public:
         return alpha_.size();
     }
 
+    /**
+     * \brief Return the extents of the alpha correction factors, as written
+     * by \ref checkpoint()
+     */
+    VecI extents() const
+    {
+        return {ngroup_, nang_, nreg_, 2};
+    }
+
     int n_cell() const
     {
         return nreg_;
@@ -99,6 +108,33 @@ public:
         return beta_(group, ang, reg);
     }
 
+    /**
+     * \brief Copy all correction factors from another \ref CorrectionData
+     * of the same dimensions
+     */
+    void copy(const CorrectionData &other)
+    {
+        assert(other.size() == this->size());
+        alpha_ = other.alpha_;
+        beta_  = other.beta_;
+        return;
+    }
+
+    /**
+     * \brief Copy the correction factors for a single group from another
+     * \ref CorrectionData of the same dimensions
+     */
+    void copy_group(const CorrectionData &other, int group)
+    {
+        assert(other.size() == this->size());
+        assert((0 <= group) && (group < ngroup_));
+        auto all = blitz::Range::all();
+
+        alpha_(group, all, all, all) = other.alpha_(group, all, all, all);
+        beta_(group, all, all)       = other.beta_(group, all, all);
+        return;
+    }
+
     /**
      * \brief Read correction factors from one or more HDF5 files, as
      * specified by \<data /\> tags
@@ -107,6 +143,27 @@ public:
 
     void output(H5Node &file) const;
 
+    /**
+     * \brief Write the correction factors to a checkpoint
+     */
+    void checkpoint(H5Node &node) const
+    {
+        node.write("alpha", alpha_);
+        node.write("beta", beta_);
+        return;
+    }
+
+    /**
+     * \brief Read the correction factors from a checkpoint written by \ref
+     * checkpoint()
+     */
+    void restart(H5Node &node)
+    {
+        node.read("alpha", alpha_);
+        node.read("beta", beta_);
+        return;
+    }
+
 private:
     // Private methods to facilitate reading data from HDF5 files
     /**
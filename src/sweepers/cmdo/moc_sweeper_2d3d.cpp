@@ -33,10 +33,11 @@ MoCSweeper_2D3D::MoCSweeper_2D3D(const pugi::xml_node &input,
       xstr_true_(),
       sn_xs_mesh_(nullptr),
       internal_coupling_(false),
+      update_sn_xs_(true),
       correction_residuals_(n_group_)
 {
     if (allow_splitting_) {
-        xstr_true_ = ExpandedXS(xs_mesh_.get());
+        xstr_true_ = ExpandedXS(xs_mesh_.get(), xstr_.compact());
     } else {
         xstr_true_ = ExpandedXS(xstr_);
     }
@@ -74,17 +75,33 @@ void MoCSweeper_2D3D::sweep(int group)
 
     flux_1g_.reference(flux_(all, group));
 
+    // Converge the within-group problem with GMRES, if enabled, then finish
+    // with a single regular sweep
+    unsigned int n_inner = n_inner_;
+    if (inner_gmres_) {
+        n_sweep_inner_ += inner_gmres_->solve(
+            flux_(all, blitz::Range(group, group)),
+            [&]() {
+                source_->self_scatter(group, xstr_.xs());
+                this->sweep1g(group, ncw);
+            },
+            *this);
+        n_inner = 1;
+    }
+
     // Perform inner iterations
-    for (unsigned int inner = 0; inner < n_inner_; inner++) {
+    for (unsigned int inner = 0; inner < n_inner; inner++) {
         n_sweep_inner_++;
         // update the self-scattering source
         source_->self_scatter(group, xstr_.xs());
 
         // Perform the stock sweep unless we are on the last outer and have
         // a CoarseData object.
-        if (inner == n_inner_ - 1 && coarse_data_) {
+        if (inner == n_inner - 1 && coarse_data_) {
             coarse_data_->zero_data_radial(group);
-            sn_xs_mesh_->update();
+            if (update_sn_xs_) {
+                sn_xs_mesh_->update();
+            }
             this->sweep1g(group, ccw);
             coarse_data_->set_has_radial_data(true);
             correction_residuals_[group].push_back(ccw.residual());
@@ -47,6 +47,20 @@ public:
         xstr_sn_     = xstr;
     }
 
+    /**
+     * \brief Specify whether the sweeper should homogenize the Sn cross
+     * sections with its own flux before calculating correction factors.
+     *
+     * This is on by default. When the Sn sweeper runs at the same time as
+     * this one, the owner should turn this off and update the cross sections
+     * before starting either sweeper, since the Sn sweeper would be reading
+     * them while they are being updated.
+     */
+    void set_update_sn_xs(bool update)
+    {
+        update_sn_xs_ = update;
+    }
+
     /**
      * \brief Allocate space internally to store coupling coefficients and
      * cross sections. Mainly useful for one-way coupling.
@@ -57,7 +71,6 @@ public:
         corrections_       = std::shared_ptr<CorrectionData>(new CorrectionData(
             mesh_, ang_quad_.ndir() / 2, xs_mesh_->n_group()));
         sn_xs_mesh_ = this->get_homogenized_xsmesh();
-        sn_xs_mesh_->set_flux(flux_);
         xstr_sn_ = ExpandedXS(sn_xs_mesh_.get());
     }
 
@@ -84,6 +97,9 @@ private:
 
     bool internal_coupling_;
 
+    // Whether to update sn_xs_mesh_ before the final inner iteration
+    bool update_sn_xs_;
+
     std::vector<std::vector<std::array<real_t, 3>>> correction_residuals_;
 };
 }
@@ -16,11 +16,15 @@
 
 #include "plane_sweeper_2d3d.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include "util/error.hpp"
+#include "util/omp_guard.h"
 #include "util/range.hpp"
 #include "util/validate_input.hpp"
 #include "sn_sweeper_factory_cdd.hpp"
@@ -39,7 +43,9 @@ const std::vector<std::string> recognized_attributes = {
     "discrepant_flux_update",
     "dump_corrections",
     "update_incoming",
-    "cycle"};
+    "cycle",
+    "concurrent",
+    "moc_plane_tol"};
 }
 
 namespace mocc {
@@ -69,6 +75,13 @@ PlaneSweeper_2D3D::PlaneSweeper_2D3D(const pugi::xml_node &input,
       sn_resid_(sn_sweeper_->n_group(), mesh_.n_pin()),
       prev_moc_flux_(sn_sweeper_->n_group(),
                      mesh_.n_reg(MeshTreatment::PIN_PLANE)),
+      sn_flux_(mesh_.n_reg(MeshTreatment::PIN_PLANE)),
+      moc_cost_(sn_sweeper_->n_group(), 0.0),
+      sn_cost_(sn_sweeper_->n_group(), 0.0),
+      plane_resid_(sn_sweeper_->n_group(), mesh_.macroplanes().size()),
+      plane_tl_change_(sn_sweeper_->n_group(), mesh_.macroplanes().size()),
+      tl_change_(n_pin_moc_),
+      n_plane_skip_(0),
       i_outer_(-1)
 {
     validate_input(input, recognized_attributes);
@@ -85,17 +98,64 @@ PlaneSweeper_2D3D::PlaneSweeper_2D3D(const pugi::xml_node &input,
 
     auto sn_xs_mesh = sn_sweeper_->get_homogenized_xsmesh();
     assert(corrections_);
-    moc_sweeper_.set_coupling(corrections_, sn_xs_mesh,
-                              sn_sweeper_->expanded_xs());
+    if (concurrent_) {
+        // Give the MoC sweeper its own correction factors and expanded Sn
+        // cross sections to write to, since the Sn sweeper will be reading
+        // the shared ones at the same time. Neither sweeper may update the
+        // homogenized Sn cross sections, since they are computed from the MoC
+        // flux; this sweeper does it instead. See sweep_concurrent().
+        moc_corrections_ = std::make_shared<CorrectionData>(
+            mesh_, sn_sweeper_->ang_quad().ndir() / 2, n_group_);
+        moc_corrections_->copy(*corrections_);
+        ExpandedXS xstr_sn(sn_xs_mesh.get());
+        moc_sweeper_.set_coupling(moc_corrections_, sn_xs_mesh, xstr_sn);
+        moc_sweeper_.set_update_sn_xs(false);
+        sn_sweeper_->set_update_xs(false);
+    } else {
+        moc_sweeper_.set_coupling(corrections_, sn_xs_mesh,
+                                  sn_sweeper_->expanded_xs());
+    }
 
     if (!keep_sn_quad_) {
         sn_sweeper_->set_ang_quad(ang_quad_);
     }
 
-    sn_sweeper_->get_homogenized_xsmesh()->set_flux(moc_sweeper_.flux());
+    moc_sweeper_.attach_homogenized_xsmesh(sn_xs_mesh);
 
     tl_ = 0.0;
 
+    // Make sure that every macroplane gets swept the first time around
+    plane_resid_     = std::numeric_limits<real_t>::max();
+    plane_tl_change_ = 0.0;
+    tl_change_       = 0.0;
+
+    // Precompute the coarse cell and axial surfaces of each MoC pin for the
+    // transverse leakage calculation. Pins are stored in the same order as
+    // tl_, so add_tl() can be a flat loop.
+    tl_cell_.reserve(n_pin_moc_);
+    tl_surf_down_.reserve(n_pin_moc_);
+    tl_surf_up_.reserve(n_pin_moc_);
+    tl_dz_.reserve(n_pin_moc_);
+    {
+        int iplane = 0;
+        for (const auto &mplane : mesh_.macroplanes()) {
+            for (int ipin = 0; ipin < mplane.plane->n_pin(); ipin++) {
+                Position pos = mesh_.pin_position(ipin);
+                pos.z        = mplane.iz_min;
+                tl_surf_down_.push_back(mesh_.coarse_surf(
+                    mesh_.coarse_cell(pos), Surface::BOTTOM));
+                pos.z = mplane.iz_max;
+                tl_surf_up_.push_back(
+                    mesh_.coarse_surf(mesh_.coarse_cell(pos), Surface::TOP));
+                pos.z = iplane;
+                tl_cell_.push_back(mesh_.coarse_cell(pos));
+                tl_dz_.push_back(mplane.height);
+            }
+            iplane++;
+        }
+    }
+    assert((int)tl_cell_.size() == n_pin_moc_);
+
     coarse_data_ = nullptr;
 
     return;
@@ -112,6 +172,7 @@ void PlaneSweeper_2D3D::sweep(int group)
     if (group == 0) {
         i_outer_++;
     }
+    n_sweep_++;
 
     // Calculate transverse leakage source
     if (do_tl_) {
@@ -120,17 +181,21 @@ void PlaneSweeper_2D3D::sweep(int group)
 
     // Do an early Sn sweep if V-cycle is enabled
     if (v_cycle_) {
+        if (concurrent_) {
+            sn_sweeper_->get_homogenized_xsmesh()->update();
+        }
         sn_sweeper_->sweep(group);
 
-        ArrayB1 sn_flux(mesh_.n_reg(MeshTreatment::PIN_PLANE));
-        sn_sweeper_->get_pin_flux_1g(group, sn_flux, MeshTreatment::PIN_PLANE);
+        sn_sweeper_->get_pin_flux_1g(group, sn_flux_, MeshTreatment::PIN_PLANE);
 
         // Check for negative fluxes on the Sn mesh
         int n_neg = 0;
-        for (auto &v : sn_flux) {
-            if (v < 0.0) {
+        const int n_cell = sn_flux_.size();
+#pragma omp parallel for reduction(+ : n_neg)
+        for (int i = 0; i < n_cell; i++) {
+            if (sn_flux_(i) < 0.0) {
                 n_neg++;
-                v = 0.0;
+                sn_flux_(i) = 0.0;
             }
         }
         if (n_neg > 0) {
@@ -138,75 +203,86 @@ void PlaneSweeper_2D3D::sweep(int group)
                       << " negative fluxes in Sn projection"
                       << "\n";
         }
-        moc_sweeper_.set_pin_flux_1g(group, sn_flux, MeshTreatment::PIN_PLANE);
+        moc_sweeper_.set_pin_flux_1g(group, sn_flux_,
+                                     MeshTreatment::PIN_PLANE);
     }
 
     // MoC Sweeper
     bool do_moc =
         ((i_outer_ + 1) > n_inactive_moc_) && ((i_outer_ % moc_modulo_) == 0);
-    if (do_moc) {
-        moc_sweeper_.sweep(group);
-
-        int n_negative  = 0;
-        int n_NaN       = 0;
-        const auto flux = moc_sweeper_.flux()(blitz::Range::all(), group);
-        for (const auto &v : flux) {
-            if (v < 0.0) {
-                n_negative++;
-            }
-            if (v != v) {
-                n_NaN++;
-            }
+    if (do_moc && (moc_plane_tol_ > 0.0)) {
+        do_moc = this->select_moc_planes(group) > 0;
+    }
+    ArrayB1 prev_moc_flux = prev_moc_flux_(group, blitz::Range::all());
+
+    if (concurrent_ && do_moc) {
+        // The Sn sweeper can only start from the MoC flux of the previous
+        // sweep of this group
+        if (do_mocproject_) {
+            sn_sweeper_->set_pin_flux_1g(group, prev_moc_flux);
         }
-        if (n_negative > 0) {
-            LogScreen << n_negative << " negative MoC fluxes in group " << group
-                      << "\n";
+
+        this->sweep_concurrent(group);
+        this->check_moc_flux(group);
+
+        moc_sweeper_.get_pin_flux_1g(group, prev_moc_flux,
+                                     MeshTreatment::PIN_PLANE);
+    } else {
+        if (do_moc) {
+            moc_sweeper_.sweep(group);
+            this->check_moc_flux(group);
         }
-        if (n_NaN > 0) {
-            LogScreen << n_NaN << " NaN MoC fluxes in group " << group << "\n";
+
+        moc_sweeper_.get_pin_flux_1g(group, prev_moc_flux,
+                                     MeshTreatment::PIN_PLANE);
+
+        if (do_mocproject_) {
+            sn_sweeper_->set_pin_flux_1g(group, prev_moc_flux);
         }
+
+        // Sn sweeper
+        if (concurrent_) {
+            sn_sweeper_->get_homogenized_xsmesh()->update();
+        }
+        sn_sweeper_->sweep(group);
     }
 
-    ArrayB1 prev_moc_flux = prev_moc_flux_(group, blitz::Range::all());
-    moc_sweeper_.get_pin_flux_1g(group, prev_moc_flux,
-                                 MeshTreatment::PIN_PLANE);
+    sn_sweeper_->get_pin_flux_1g(group, sn_flux_, MeshTreatment::PIN_PLANE);
 
-    if (do_mocproject_) {
-        sn_sweeper_->set_pin_flux_1g(group, prev_moc_flux);
+    // Fix up negative Sn fluxes (if they are to be projected) and compute the
+    // Sn-MoC residual in a single pass
+    real_t residual  = 0.0;
+    int n_neg        = 0;
+    const int n_cell = sn_flux_.size();
+    const bool fixup = do_snproject_;
+#pragma omp parallel for reduction(+ : residual, n_neg)
+    for (int i = 0; i < n_cell; i++) {
+        if (fixup && (sn_flux_(i) < 0.0)) {
+            n_neg++;
+            sn_flux_(i) = 0.0;
+        }
+        real_t diff = prev_moc_flux(i) - sn_flux_(i);
+        residual += diff * diff;
+        sn_resid_(group, i) = diff;
     }
+    residual = sqrt(residual) / mesh_.n_pin();
 
-    // Sn sweeper
-    sn_sweeper_->sweep(group);
-
-    ArrayB1 sn_flux(mesh_.n_reg(MeshTreatment::PIN_PLANE));
-    sn_sweeper_->get_pin_flux_1g(group, sn_flux, MeshTreatment::PIN_PLANE);
+    if (moc_plane_tol_ > 0.0) {
+        ArrayB1 resid       = sn_resid_(group, blitz::Range(0, n_cell - 1));
+        ArrayB1 plane_resid = plane_resid_(group, blitz::Range::all());
+        this->plane_norms(resid, prev_moc_flux, plane_resid);
+    }
 
     if (do_snproject_) {
-        // Check for negative fluxes on the Sn mesh
-        int n_neg = 0;
-        for (auto &v : sn_flux) {
-            if (v < 0.0) {
-                n_neg++;
-                v = 0.0;
-            }
-        }
         if (n_neg > 0) {
             LogScreen << "Corrected " << n_neg
                       << " negative fluxes in Sn projection"
                       << "\n";
         }
-        moc_sweeper_.set_pin_flux_1g(group, sn_flux, MeshTreatment::PIN_PLANE);
+        moc_sweeper_.set_pin_flux_1g(group, sn_flux_,
+                                     MeshTreatment::PIN_PLANE);
     }
 
-    // Compute Sn-MoC residual
-    real_t residual = 0.0;
-    for (int i = 0; i < (int)prev_moc_flux.size(); i++) {
-        real_t diff = prev_moc_flux(i) - sn_flux(i);
-        residual += diff * diff;
-        sn_resid_(group, i) = diff;
-    }
-    residual = sqrt(residual) / mesh_.n_pin();
-
     LogScreen << "MoC/Sn residual: " << residual;
     if (sn_resid_norm_[group].size() > 0) {
         LogScreen << "   \t" << residual / sn_resid_norm_[group].back();
@@ -216,11 +292,269 @@ void PlaneSweeper_2D3D::sweep(int group)
     sn_resid_norm_[group].push_back(residual);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void PlaneSweeper_2D3D::check_moc_flux(int group) const
+{
+    int n_negative   = 0;
+    int n_NaN        = 0;
+    const auto &flux = moc_sweeper_.flux();
+    const int n_reg  = moc_sweeper_.n_reg();
+#pragma omp parallel for reduction(+ : n_negative, n_NaN)
+    for (int i = 0; i < n_reg; i++) {
+        const real_t v = flux(i, group);
+        if (v < 0.0) {
+            n_negative++;
+        }
+        if (v != v) {
+            n_NaN++;
+        }
+    }
+    if (n_negative > 0) {
+        LogScreen << n_negative << " negative MoC fluxes in group " << group
+                  << "\n";
+    }
+    if (n_NaN > 0) {
+        LogScreen << n_NaN << " NaN MoC fluxes in group " << group << "\n";
+    }
+    return;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * The MoC sweep of a group produces the correction factors and Sn cross
+ * sections that the Sn sweep of the same group consumes. To run them at the
+ * same time, the Sn sweeper uses the correction factors from the previous MoC
+ * sweep of the group (the same factors that a restart would provide), and the
+ * Sn cross sections are homogenized with the current MoC flux before either
+ * sweeper starts, rather than by the sweepers themselves, since both would
+ * read the MoC flux while it is being swept. The new correction factors are
+ * handed over once both sweepers are done. The transverse leakage is computed
+ * from the CMFD currents before either sweep, as usual.
+ *
+ * The threads are divided between the two sweepers in proportion to the cost
+ * of their previous concurrent sweeps of the group, so that they finish at
+ * roughly the same time. The first sweep of each group splits them evenly.
+ */
+void PlaneSweeper_2D3D::sweep_concurrent(int group)
+{
+    assert(moc_corrections_);
+
+    sn_sweeper_->get_homogenized_xsmesh()->update();
+
+    int n_thread = omp_get_max_threads();
+    real_t cost  = moc_cost_[group] + sn_cost_[group];
+    int n_moc    = n_thread / 2;
+    if (cost > 0.0) {
+        n_moc = std::lround(n_thread * moc_cost_[group] / cost);
+    }
+    n_moc    = std::max(1, std::min(n_thread - 1, n_moc));
+    int n_sn = std::max(1, n_thread - n_moc);
+
+    // Each sweeper opens its own parallel regions, which need to be allowed
+    // to nest inside the one below
+    int max_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(max_levels, 2));
+
+    real_t moc_time = 0.0;
+    real_t sn_time  = 0.0;
+    std::exception_ptr moc_error;
+    std::exception_ptr sn_error;
+#pragma omp parallel sections num_threads(2)
+    {
+#pragma omp section
+        {
+            omp_set_num_threads(n_moc);
+            real_t start = omp_get_wtime();
+            try {
+                moc_sweeper_.sweep(group);
+            } catch (...) {
+                moc_error = std::current_exception();
+            }
+            moc_time = omp_get_wtime() - start;
+        }
+#pragma omp section
+        {
+            omp_set_num_threads(n_sn);
+            real_t start = omp_get_wtime();
+            try {
+                sn_sweeper_->sweep(group);
+            } catch (...) {
+                sn_error = std::current_exception();
+            }
+            sn_time = omp_get_wtime() - start;
+        }
+    }
+
+    omp_set_max_active_levels(max_levels);
+
+    if (moc_error) {
+        std::rethrow_exception(moc_error);
+    }
+    if (sn_error) {
+        std::rethrow_exception(sn_error);
+    }
+
+    moc_cost_[group] = moc_time * n_moc;
+    sn_cost_[group]  = sn_time * n_sn;
+
+    // Make the new correction factors available to the next Sn sweep
+    corrections_->copy_group(*moc_corrections_, group);
+
+    return;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PlaneSweeper_2D3D::plane_norms(const ArrayB1 &a, const ArrayB1 &b,
+                                    ArrayB1 &norms) const
+{
+    const int n_plane      = norms.size();
+    const int n_cell_plane = mesh_.nx() * mesh_.ny();
+    assert((int)a.size() == n_plane * n_cell_plane);
+    assert((int)b.size() == n_plane * n_cell_plane);
+
+#pragma omp parallel for
+    for (int iplane = 0; iplane < n_plane; iplane++) {
+        real_t num = 0.0;
+        real_t den = 0.0;
+        for (int i = iplane * n_cell_plane; i < (iplane + 1) * n_cell_plane;
+             i++) {
+            num += a(i) * a(i);
+            den += b(i) * b(i);
+        }
+        if (den > 0.0) {
+            norms(iplane) = std::sqrt(num / den);
+        } else {
+            norms(iplane) =
+                (num > 0.0) ? std::numeric_limits<real_t>::max() : 0.0;
+        }
+    }
+    return;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * A macroplane is swept if either its MoC/Sn residual from the last sweep of
+ * the group, or the change in its transverse leakage since then, exceeds
+ * moc_plane_tol_. Skipped planes keep their MoC flux and correction factors.
+ * Since the Sn sweeper still sweeps the whole core, a skipped plane whose
+ * solution drifts shows up in its residual, and is swept again.
+ */
+int PlaneSweeper_2D3D::select_moc_planes(int group)
+{
+    const int n_plane = plane_resid_.extent(1);
+    std::vector<bool> active(n_plane);
+    int n_active = 0;
+    for (int iplane = 0; iplane < n_plane; iplane++) {
+        active[iplane] = (plane_resid_(group, iplane) > moc_plane_tol_) ||
+                         (plane_tl_change_(group, iplane) > moc_plane_tol_);
+        if (active[iplane]) {
+            n_active++;
+        }
+    }
+
+    n_plane_skip_ += n_plane - n_active;
+    if (n_active > 0) {
+        moc_sweeper_.set_active_planes(active);
+    }
+
+    return n_active;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PlaneSweeper_2D3D::checkpoint(H5Node &node) const
+{
+    {
+        auto g = node.create_group("moc");
+        moc_sweeper_.checkpoint(g);
+    }
+    {
+        auto g = node.create_group("sn");
+        sn_sweeper_->checkpoint(g);
+    }
+    {
+        auto g = node.create_group("corrections");
+        corrections_->checkpoint(g);
+    }
+    node.write("prev_moc_flux", prev_moc_flux_);
+    node.write("transverse_leakage", tl_);
+    node.write("i_outer", i_outer_);
+
+    // Macroplane skipping state
+    node.write("plane_residual", plane_resid_);
+    node.write("plane_tl_change", plane_tl_change_);
+    node.write("n_plane_skip", n_plane_skip_);
+    const auto &active = moc_sweeper_.active_planes();
+    node.write("moc_active_planes", VecF(active.begin(), active.end()));
+    return;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PlaneSweeper_2D3D::restart(H5Node &node)
+{
+    {
+        auto g = node["moc"];
+        moc_sweeper_.restart(g);
+    }
+    {
+        auto g = node["sn"];
+        sn_sweeper_->restart(g);
+    }
+    {
+        auto g = node["corrections"];
+        corrections_->restart(g);
+        if (moc_corrections_) {
+            moc_corrections_->copy(*corrections_);
+        }
+    }
+    node.read("prev_moc_flux", prev_moc_flux_);
+    node.read("transverse_leakage", tl_);
+    node.read("i_outer", i_outer_);
+
+    node.read("plane_residual", plane_resid_);
+    node.read("plane_tl_change", plane_tl_change_);
+    node.read("n_plane_skip", n_plane_skip_);
+    VecF active;
+    node.read("moc_active_planes", active);
+    if (active.size() != moc_sweeper_.active_planes().size()) {
+        throw EXCEPT("Wrong number of macroplanes in checkpoint.");
+    }
+    moc_sweeper_.set_active_planes(
+        std::vector<bool>(active.begin(), active.end()));
+    return;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PlaneSweeper_2D3D::warm_start(H5Node &node)
+{
+    {
+        auto g = node["moc"];
+        moc_sweeper_.warm_start(g);
+    }
+    {
+        auto g = node["sn"];
+        sn_sweeper_->warm_start(g);
+    }
+    if (dataset_matches(node, "corrections/alpha", corrections_->extents())) {
+        auto g = node["corrections"];
+        corrections_->restart(g);
+        if (moc_corrections_) {
+            moc_corrections_->copy(*corrections_);
+        }
+    }
+    if (dataset_matches(node, "prev_moc_flux", prev_moc_flux_)) {
+        node.read("prev_moc_flux", prev_moc_flux_);
+    }
+    return;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void PlaneSweeper_2D3D::initialize()
 {
     sn_sweeper_->initialize();
     moc_sweeper_.initialize();
+    if (moc_coarse_data_) {
+        coarse_data_->flux = moc_coarse_data_->flux;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -241,42 +575,27 @@ void PlaneSweeper_2D3D::get_pin_flux_1g(int ig, ArrayB1 &flux,
 void PlaneSweeper_2D3D::add_tl(int group)
 {
     assert(coarse_data_);
-    ArrayB1 tl_fsr(n_reg_);
 
     blitz::Array<real_t, 1> tl_g = tl_(group, blitz::Range::all());
 
-    int iplane   = 0;
-    int ireg_pin = 0;
-    int ipin     = 0;
-    for (const auto &mplane : mesh_.macroplanes()) {
-        real_t dz = mplane.height;
-        for (const auto &mpin : mplane) {
-            Position pos  = mesh_.pin_position(ipin);
-            pos.z         = mplane.iz_min;
-            size_t icell  = mesh_.coarse_cell(pos);
-            int surf_down = mesh_.coarse_surf(icell, Surface::BOTTOM);
-            pos.z         = mplane.iz_max;
-            icell         = mesh_.coarse_cell(pos);
-            int surf_up   = mesh_.coarse_surf(icell, Surface::TOP);
-            // Get index for storing in tl_ array
-            pos.z       = iplane;
-            int icoarse = mesh_.coarse_cell(pos);
-
-            real_t j_up   = coarse_data_->current(surf_up, group);
-            real_t j_down = coarse_data_->current(surf_down, group);
-            tl_g(icoarse) =
-                tl_g(icoarse) * (1.0 - relax_) + relax_ * (j_down - j_up) / dz;
-            for (int ir = 0; ir < mpin->n_reg(); ir++) {
-                tl_fsr(ireg_pin) = tl_g(icoarse);
-                ireg_pin++;
-            }
-            ipin++;
-        }
-        iplane++;
+#pragma omp parallel for
+    for (int ipin = 0; ipin < n_pin_moc_; ipin++) {
+        real_t j_up   = coarse_data_->current(tl_surf_up_[ipin], group);
+        real_t j_down = coarse_data_->current(tl_surf_down_[ipin], group);
+        int icoarse = tl_cell_[ipin];
+        real_t tl   = tl_g(icoarse) * (1.0 - relax_) +
+                      relax_ * (j_down - j_up) / tl_dz_[ipin];
+        tl_change_(icoarse) = tl - tl_g(icoarse);
+        tl_g(icoarse)       = tl;
+    }
+
+    if (moc_plane_tol_ > 0.0) {
+        ArrayB1 plane_change = plane_tl_change_(group, blitz::Range::all());
+        this->plane_norms(tl_change_, tl_g, plane_change);
     }
 
     // Hand the transverse leakage to the MoC sweeper.
-    moc_sweeper_.apply_transverse_leakage(group, tl_fsr);
+    moc_sweeper_.apply_transverse_leakage(group, tl_g);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -314,6 +633,10 @@ void PlaneSweeper_2D3D::output(H5Node &file) const
     dims.push_back(mesh_.ny());
     dims.push_back(mesh_.nx());
 
+    if (moc_plane_tol_ > 0.0) {
+        LogFile << "MoC macroplane sweeps skipped: " << n_plane_skip_ << "\n";
+    }
+
     // Write out the Sn-MoC residual convergence
     file.create_group("/SnResid");
     for (int g = 0; g < n_group_; g++) {
@@ -372,6 +695,8 @@ void PlaneSweeper_2D3D::parse_options(const pugi::xml_node &input)
     discrepant_flux_update_ = false;
     dump_corrections_       = false;
     v_cycle_                = false;
+    concurrent_             = false;
+    moc_plane_tol_          = 0.0;
 
     // Override with entries in the input node
     if (!input.attribute("expose_sn").empty()) {
@@ -415,6 +740,15 @@ void PlaneSweeper_2D3D::parse_options(const pugi::xml_node &input)
         }
     }
 
+    concurrent_ = input.attribute("concurrent").as_bool(false);
+
+    if (!input.attribute("moc_plane_tol").empty()) {
+        moc_plane_tol_ = input.attribute("moc_plane_tol").as_double(0.0);
+        if (moc_plane_tol_ < 0.0) {
+            throw EXCEPT("moc_plane_tol must be non-negative");
+        }
+    }
+
     // Make sure that sn project is on if we are exposing sn
     if (expose_sn_ && !do_snproject_) {
         Warn(
@@ -449,6 +783,8 @@ void PlaneSweeper_2D3D::parse_options(const pugi::xml_node &input)
         LogFile << "Sawtooth"
                 << "\n";
     }
+    LogFile << "    Concurrent MoC/Sn sweeps: " << concurrent_ << "\n";
+    LogFile << "    MoC macroplane tolerance: " << moc_plane_tol_ << "\n";
 }
 }
 } // Namespace mocc::cmdo
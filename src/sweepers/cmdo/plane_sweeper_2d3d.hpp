@@ -16,10 +16,12 @@
 
 #pragma once
 
+#include <memory>
 #include <blitz/array.h>
 #include "util/global_config.hpp"
 #include "util/pugifwd.hpp"
 #include "core/angular_quadrature.hpp"
+#include "core/coarse_data.hpp"
 #include "core/output_interface.hpp"
 #include "sn/sn_sweeper_variant.hpp"
 #include "correction_data.hpp"
@@ -132,6 +134,8 @@ public:
         std::cout << "creating 2d3d source" << std::endl;
 
         auto source = UP_Source_t(new Source_2D3D(moc_sweeper_, *sn_sweeper_));
+        source->set_check_negative(
+            input.attribute("check_negative").as_bool(false));
         return source;
     }
 
@@ -184,6 +188,55 @@ public:
         return;
     }
 
+    /**
+     * \brief \copybrief TransportSweeper::add_fission_source_1g()
+     *
+     * The fission source is laid out as in \ref calc_fission_source().
+     */
+    void add_fission_source_1g(int group, real_t scale,
+                               ArrayB1 &fission_source) const override final
+    {
+        assert((int)fission_source.size() ==
+               moc_sweeper_.n_reg() + sn_sweeper_->n_reg());
+
+        ArrayB1 sn_fission_source(
+            fission_source(blitz::Range(0, sn_sweeper_->n_reg() - 1)));
+        ArrayB1 moc_fission_source(
+            fission_source(blitz::Range(sn_sweeper_->n_reg(), blitz::toEnd)));
+        sn_sweeper_->add_fission_source_1g(group, scale, sn_fission_source);
+        moc_sweeper_.add_fission_source_1g(group, scale, moc_fission_source);
+
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::update_fission_source()
+     *
+     * Store the fission sources of the two sub-sweepers as in \ref
+     * calc_fission_source(), returning the totals of the same sub-sweeper as
+     * \ref total_fission(). The number of positive entries and the sum cover
+     * the whole fission source.
+     */
+    FissionTotals
+    update_fission_source(ArrayB1 &fission_source) const override final
+    {
+        assert((int)fission_source.size() ==
+               moc_sweeper_.n_reg() + sn_sweeper_->n_reg());
+
+        ArrayB1 sn_fission_source(
+            fission_source(blitz::Range(0, sn_sweeper_->n_reg() - 1)));
+        ArrayB1 moc_fission_source(
+            fission_source(blitz::Range(sn_sweeper_->n_reg(), blitz::toEnd)));
+        auto sn_totals = sn_sweeper_->update_fission_source(sn_fission_source);
+        auto moc_totals =
+            moc_sweeper_.update_fission_source(moc_fission_source);
+
+        FissionTotals totals = expose_sn_ ? sn_totals : moc_totals;
+        totals.n_positive    = sn_totals.n_positive + moc_totals.n_positive;
+        totals.sum           = sn_totals.sum + moc_totals.sum;
+        return totals;
+    }
+
     /**
      * \brief \copybrief TransportSweeper::total_fission()
      *
@@ -212,6 +265,136 @@ public:
         return;
     }
 
+    /**
+     * \brief \copybrief TransportSweeper::flux_residual(int)
+     *
+     * Defer to the MoC sweeper, which owns the flux.
+     */
+    using TransportSweeper::flux_residual;
+    real_t flux_residual(int group) const override final
+    {
+        return moc_sweeper_.flux_residual(group);
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::push_state()
+     *
+     * Defer to the MoC and Sn sweepers.
+     */
+    void push_state() override final
+    {
+        moc_sweeper_.push_state();
+        sn_sweeper_->push_state();
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::restore_state()
+     *
+     * Defer to the MoC and Sn sweepers.
+     */
+    void restore_state() override final
+    {
+        moc_sweeper_.restore_state();
+        sn_sweeper_->restore_state();
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::pop_state()
+     *
+     * Defer to the MoC and Sn sweepers.
+     */
+    void pop_state() override final
+    {
+        moc_sweeper_.pop_state();
+        sn_sweeper_->pop_state();
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::mark_flux_dirty(int)
+     *
+     * The flux is that of the MoC sweeper, so defer to it.
+     */
+    void mark_flux_dirty(int group) override final
+    {
+        moc_sweeper_.mark_flux_dirty(group);
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::mark_flux_dirty()
+     *
+     * The flux is that of the MoC sweeper, so defer to it.
+     */
+    void mark_flux_dirty() override final
+    {
+        moc_sweeper_.mark_flux_dirty();
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::checkpoint()
+     *
+     * Defer to the MoC and Sn sweepers, adding the correction factors and
+     * the coupling state.
+     */
+    void checkpoint(H5Node &node) const override final;
+
+    /**
+     * \brief \copybrief TransportSweeper::restart()
+     */
+    void restart(H5Node &node) override final;
+
+    /**
+     * \brief \copybrief TransportSweeper::initialize_spectrum()
+     *
+     * Defer to the MoC and Sn sweepers.
+     */
+    void initialize_spectrum(const ArrayB1 &spectrum) override final
+    {
+        moc_sweeper_.initialize_spectrum(spectrum);
+        sn_sweeper_->initialize_spectrum(spectrum);
+        return;
+    }
+
+    /**
+     * \brief \copybrief TransportSweeper::warm_start()
+     *
+     * Defer to the MoC and Sn sweepers, reusing the correction factors if
+     * they are the same size.
+     */
+    void warm_start(H5Node &node) override final;
+
+    /**
+     * \brief \copybrief TransportSweeper::set_inner_fraction()
+     *
+     * Defer to the MoC and Sn sweepers.
+     */
+    void set_inner_fraction(real_t fraction) override final
+    {
+        moc_sweeper_.set_inner_fraction(fraction);
+        sn_sweeper_->set_inner_fraction(fraction);
+        return;
+    }
+
+    /**
+     * \brief Return the subordinate MoC sweeper
+     */
+    const MoCSweeper_2D3D &moc_sweeper() const
+    {
+        return moc_sweeper_;
+    }
+
+    /**
+     * \brief Return the 2D3D correction factors
+     */
+    const CorrectionData &corrections() const
+    {
+        return *corrections_;
+    }
+
     /**
      * \brief \copybrief TransportSweeper::set_coarse_data()
      *
@@ -220,7 +403,16 @@ public:
     void set_coarse_data(CoarseData *cd) override final
     {
         coarse_data_ = cd;
-        moc_sweeper_.set_coarse_data(cd);
+        if (concurrent_ && cd) {
+            // Both sweepers tally currents, so they can't share the same
+            // CoarseData when running at the same time. The Sn currents are
+            // the ones that matter.
+            moc_coarse_data_.reset(new CoarseData(mesh_, n_group_));
+            moc_sweeper_.set_coarse_data(moc_coarse_data_.get());
+        } else {
+            moc_coarse_data_.reset();
+            moc_sweeper_.set_coarse_data(cd);
+        }
         sn_sweeper_->set_coarse_data(cd);
     }
 
@@ -235,6 +427,17 @@ private:
     // Calculate transverse leakage based on the state of the coarse_data_
     // and apply to the MoC sweeper's source.
     void add_tl(int group);
+    // Look for negative and NaN values in the MoC flux of the passed group
+    void check_moc_flux(int group) const;
+    // Sweep the MoC and Sn sweepers at the same time, each with a share of
+    // the available threads
+    void sweep_concurrent(int group);
+    // Calculate the L-2 norm of a relative to b within each macroplane of the
+    // PIN_PLANE mesh
+    void plane_norms(const ArrayB1 &a, const ArrayB1 &b, ArrayB1 &norms) const;
+    // Tell the MoC sweeper which macroplanes to sweep for the passed group,
+    // based on their residuals. Returns the number of active macroplanes
+    int select_moc_planes(int group);
 
     const CoreMesh &mesh_;
 
@@ -260,6 +463,42 @@ private:
     // residual
     ArrayB2 prev_moc_flux_;
 
+    // Workspace for the PIN_PLANE-homogenized Sn flux of the current group
+    ArrayB1 sn_flux_;
+
+    // For each MoC pin, the index of its coarse cell in tl_, the coarse
+    // surfaces at the bottom and top of its macroplane, and the macroplane
+    // height
+    VecI tl_cell_;
+    VecI tl_surf_down_;
+    VecI tl_surf_up_;
+    VecF tl_dz_;
+
+    // Correction factors that the MoC sweeper writes to when sweeping
+    // concurrently with the Sn sweeper. Copied to corrections_ once both
+    // sweepers are done with a group, so that the Sn sweeper always sees the
+    // factors from the previous MoC sweep of that group.
+    std::shared_ptr<CorrectionData> moc_corrections_;
+
+    // Coarse data for the MoC sweeper to tally to when sweeping concurrently
+    std::unique_ptr<CoarseData> moc_coarse_data_;
+
+    // Measured cost, in thread-seconds, of the last concurrent MoC and Sn
+    // sweeps of each group. Used to divide threads between the sweepers.
+    VecF moc_cost_;
+    VecF sn_cost_;
+
+    // Relative MoC/Sn flux residual and relative change in transverse leakage
+    // of each macroplane, by group, from the most recent sweep
+    ArrayB2 plane_resid_;
+    ArrayB2 plane_tl_change_;
+
+    // Change in the transverse leakage of each pin from the last add_tl()
+    ArrayB1 tl_change_;
+
+    // Number of macroplane MoC sweeps skipped due to convergence
+    int n_plane_skip_;
+
     // Outer iteration index. Starts at -1 and is incremented whenever group
     // 0 is swept. This is kind of brittle.
     int i_outer_;
@@ -290,6 +529,11 @@ private:
     bool dump_corrections_;
     // Whether to use a sawtooth or V cycle in the sweep
     bool v_cycle_;
+    // Whether to run the MoC and Sn sweeps of a group concurrently
+    bool concurrent_;
+    // Macroplane residual and transverse leakage change below which MoC
+    // sweeps of that plane are skipped. Zero sweeps all planes.
+    real_t moc_plane_tol_;
 };
 }
 } // Namespace mocc::cmdo
@@ -95,6 +95,39 @@ public:
         sn_source_.in_scatter(ig);
     }
 
+    /**
+     * Form the group sources for both the MoC and Sn sweepers, splitting the
+     * fission source as in \ref fission().
+     */
+    void group_source(int ig, const ArrayB1 *fs)
+    {
+        if (fs) {
+            assert((int)fs->size() == (n_reg_ + sn_source_.n_reg()));
+            ArrayB1 sn_fission_source(
+                (*fs)(blitz::Range(0, sn_source_.n_reg() - 1)));
+            ArrayB1 moc_fission_source(
+                (*fs)(blitz::Range(sn_source_.n_reg(), blitz::toEnd)));
+
+            sn_source_.group_source(ig, &sn_fission_source);
+            Source::group_source(ig, &moc_fission_source);
+        } else {
+            sn_source_.group_source(ig, nullptr);
+            Source::group_source(ig, nullptr);
+        }
+        return;
+    }
+
+    /**
+     * Set whether to check for negative transport sources, for both the MoC
+     * and Sn sources.
+     */
+    void set_check_negative(bool check)
+    {
+        Source::set_check_negative(check);
+        sn_source_.set_check_negative(check);
+        return;
+    }
+
     Source *get_sn_source()
     {
         return &sn_source_;
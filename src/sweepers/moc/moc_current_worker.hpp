@@ -273,44 +273,52 @@ public:
     {
 #pragma omp single
         {
-            // Check to see if we need to expand the currents across the mesh.
-            if ((int)mesh_->nz() - 1 != (mesh_->macroplane_index().back())) {
-                // In the presence of subplaning, the currents coming from the
-                // sweeper are stored by macroplane, packed towards the bottom
-                // of the mesh.  To safely perform an in-place expansion, we
-                // will expand the currents in reverse, filling from the top
-                // down. This prevents over-writing of the source currents from
-                // the MoC sweep before having a chance to expand them, as would
-                // happen if the expansion went from the bottom up.
-                int iz = mesh_->nz() - 1;
-                for (auto mplane_it = mesh_->macroplane_index().crbegin();
-                     mplane_it != mesh_->macroplane_index().crend();
-                     ++mplane_it) {
-                    int stt_out = mesh_->plane_surf_xy_begin(iz);
-                    int stp_out = mesh_->plane_surf_end(iz);
-                    int ip      = *mplane_it;
-                    int stt_in  = mesh_->plane_surf_xy_begin(ip);
-                    int stp_in  = mesh_->plane_surf_end(ip);
-
-                    coarse_data_->current(blitz::Range(stt_out, stp_out),
-                                          group_) =
-                        coarse_data_->current(blitz::Range(stt_in, stp_in),
-                                              group_);
-
-                    iz--;
+            // Blitz slicing of the shared coarse data is not thread safe, and
+            // other groups may be swept concurrently by other thread teams
+#pragma omp critical
+            {
+                // Check to see if we need to expand the currents across the
+                // mesh.
+                if ((int)mesh_->nz() - 1 !=
+                    (mesh_->macroplane_index().back())) {
+                    // In the presence of subplaning, the currents coming from
+                    // the sweeper are stored by macroplane, packed towards the
+                    // bottom of the mesh.  To safely perform an in-place
+                    // expansion, we will expand the currents in reverse,
+                    // filling from the top down. This prevents over-writing of
+                    // the source currents from the MoC sweep before having a
+                    // chance to expand them, as would happen if the expansion
+                    // went from the bottom up.
+                    int iz = mesh_->nz() - 1;
+                    for (auto mplane_it = mesh_->macroplane_index().crbegin();
+                         mplane_it != mesh_->macroplane_index().crend();
+                         ++mplane_it) {
+                        int stt_out = mesh_->plane_surf_xy_begin(iz);
+                        int stp_out = mesh_->plane_surf_end(iz);
+                        int ip      = *mplane_it;
+                        int stt_in  = mesh_->plane_surf_xy_begin(ip);
+                        int stp_in  = mesh_->plane_surf_end(ip);
+
+                        coarse_data_->current(blitz::Range(stt_out, stp_out),
+                                              group_) =
+                            coarse_data_->current(blitz::Range(stt_in, stp_in),
+                                                  group_);
+
+                        iz--;
+                    }
                 }
-            }
 
-            auto all          = blitz::Range::all();
-            auto current      = coarse_data_->current(all, group_);
-            auto surface_flux = coarse_data_->surface_flux(all, group_);
-            // Normalize the surface currents
-            for (size_t plane = 0; plane < mesh_->nz(); plane++) {
-                for (int surf = mesh_->plane_surf_xy_begin(plane);
-                     surf != (int)mesh_->plane_surf_end(plane); ++surf) {
-                    real_t area = mesh_->coarse_area(surf);
-                    current(surf) /= area;
-                    surface_flux(surf) /= area;
+                auto all          = blitz::Range::all();
+                auto current      = coarse_data_->current(all, group_);
+                auto surface_flux = coarse_data_->surface_flux(all, group_);
+                // Normalize the surface currents
+                for (size_t plane = 0; plane < mesh_->nz(); plane++) {
+                    for (int surf = mesh_->plane_surf_xy_begin(plane);
+                         surf != (int)mesh_->plane_surf_end(plane); ++surf) {
+                        real_t area = mesh_->coarse_area(surf);
+                        current(surf) /= area;
+                        surface_flux(surf) /= area;
+                    }
                 }
             }
         }
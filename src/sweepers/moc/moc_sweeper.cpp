@@ -17,6 +17,7 @@
 #include "moc_sweeper.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include "pugixml.hpp"
@@ -52,9 +53,10 @@ std::vector<mocc::BC_Size_t> bc_size_helper(const mocc::moc::RayData &rays)
 }
 
 const std::vector<std::string> recognized_attributes = {
-    "type",         "update_incoming", "n_inner",
-    "dump_rays",    "boundary_update", "tl_splitting",
-    "dump_fsr_flux"};
+    "type",          "update_incoming", "n_inner",
+    "dump_rays",     "boundary_update", "tl_splitting",
+    "dump_fsr_flux", "inner_solver",    "inner_krylov",
+    "inner_tol",     "inner_dsa",       "compact_xs"};
 }
 
 namespace mocc {
@@ -71,6 +73,7 @@ MoCSweeper::MoCSweeper(const pugi::xml_node &input, const CoreMesh &mesh)
                                   bc_size_helper(rays_))),
       boundary_out_(mesh.nz(), BoundaryCondition(1, ang_quad_, mesh_.boundary(),
                                                  bc_size_helper(rays_))),
+      n_saved_(0),
       xstr_(xs_mesh_.get()),
       flux_1g_(),
       subplane_(mesh.subplane()),
@@ -96,7 +99,11 @@ MoCSweeper::MoCSweeper(const pugi::xml_node &input, const CoreMesh &mesh)
         throw EXCEPT("Invalid number of inner iterations specified "
                      "(n_inner).");
     }
-    n_inner_ = int_in;
+    n_inner_       = int_in;
+    n_inner_input_ = int_in;
+
+    // Within-group Krylov solver, if requested
+    inner_gmres_ = InnerGMRESFactory(input);
 
     // Parse the output options
     dump_rays_     = input.attribute("dump_rays").as_bool(false);
@@ -121,6 +128,12 @@ MoCSweeper::MoCSweeper(const pugi::xml_node &input, const CoreMesh &mesh)
         split_.resize(n_reg_);
     }
 
+    // Look up transport cross sections through a compact per-region index,
+    // rather than expanding them to every region
+    if (input.attribute("compact_xs").as_bool(false)) {
+        xstr_ = ExpandedXS(xs_mesh_.get(), true, allow_splitting_);
+    }
+
     // Sanity-check the subplane parameters. We will operate on the assumption
     // for now that all planes in a macroplane are not only geometrically
     // identical, but completely so. For anyone interested in doing de-cusping,
@@ -172,6 +185,9 @@ MoCSweeper::MoCSweeper(const pugi::xml_node &input, const CoreMesh &mesh)
     }
     first_reg_macroplane_.pop_back();
 
+    active_planes_.assign(subplane_.size(), true);
+    all_planes_active_ = true;
+
     if (dump_rays_) {
         std::ofstream rayfile("rays.py");
         rayfile << rays_ << std::endl;
@@ -193,19 +209,41 @@ void MoCSweeper::sweep(int group)
     timer_.tic();
     timer_sweep_.tic();
 
+    n_sweep_++;
+
     // Expand the cross sections, and perform splitting if necessary
     xstr_.expand(group, split_);
 
     flux_1g_.reference(flux_(blitz::Range::all(), group));
 
-    // Perform inner iterations
-    for (unsigned int inner = 0; inner < n_inner_; inner++) {
+    // Converge the within-group problem with GMRES, if enabled, then finish
+    // with a single regular sweep
+    unsigned int n_inner = n_inner_;
+    if (inner_gmres_) {
+        inner_gmres_->solve(
+            flux_(blitz::Range::all(), blitz::Range(group, group)),
+            [&]() {
+                source_->self_scatter(group, xstr_.xs());
+                moc::NoCurrent cw(coarse_data_, &mesh_);
+                this->sweep1g(group, cw);
+            },
+            *this);
+        n_inner = 1;
+    }
+
+    // Perform inner iterations. With within-group CMFD, currents are needed
+    // from every inner
+    bool dsa = this->inner_dsa_active();
+    for (unsigned int inner = 0; inner < n_inner; inner++) {
         // update the self-scattering source
         source_->self_scatter(group, xstr_.xs());
+        if (dsa) {
+            this->store_inner_dsa_flux(group);
+        }
 
         // Perform the stock sweep unless we are on the last outer and have
         // a CoarseData object.
-        if (inner == n_inner_ - 1 && coarse_data_) {
+        if ((inner == n_inner - 1 || dsa) && coarse_data_) {
             // Wipe out the existing currents (only on X- and Y-normal
             // faces)
             coarse_data_->zero_data_radial(group);
@@ -217,6 +255,10 @@ void MoCSweeper::sweep(int group)
             moc::NoCurrent cw(coarse_data_, &mesh_);
             this->sweep1g(group, cw);
         }
+
+        if (dsa) {
+            this->apply_inner_dsa(group);
+        }
     }
 
     timer_.toc();
@@ -224,6 +266,62 @@ void MoCSweeper::sweep(int group)
     return;
 } // sweep( group )
 
+bool MoCSweeper::prepare_concurrent_groups()
+{
+    if (inner_gmres_ || inner_dsa_ || allow_splitting_) {
+        return false;
+    }
+
+    // Take the flux slices here, since Blitz reference counting is not thread
+    // safe
+    if (group_ws_.empty()) {
+        group_ws_.reserve(n_group_);
+        for (int ig = 0; ig < n_group_; ig++) {
+            group_ws_.emplace_back(std::make_unique<GroupWorkspace>(
+                xs_mesh_.get(), xstr_.compact(), flux_(blitz::Range::all(), ig),
+                boundary_out_));
+        }
+    }
+
+    return true;
+}
+
+void MoCSweeper::sweep_concurrent(int group, Source &source)
+{
+    assert((int)group_ws_.size() == n_group_);
+    auto &ws = *group_ws_[group];
+
+#pragma omp atomic
+    n_sweep_++;
+
+    ws.xstr.expand(group);
+
+    for (unsigned int inner = 0; inner < n_inner_; inner++) {
+        source.self_scatter(group, ws.xstr.xs());
+
+        if (inner == n_inner_ - 1 && coarse_data_) {
+#pragma omp critical
+            {
+                coarse_data_->zero_data_radial(group);
+            }
+
+            moc::Current cw(coarse_data_, &mesh_);
+            this->sweep1g(group, cw, ws.xstr, ws.flux_1g, ws.boundary_out,
+                          source);
+#pragma omp critical
+            {
+                coarse_data_->set_has_radial_data(true);
+            }
+        } else {
+            moc::NoCurrent cw(coarse_data_, &mesh_);
+            this->sweep1g(group, cw, ws.xstr, ws.flux_1g, ws.boundary_out,
+                          source);
+        }
+    }
+
+    return;
+}
+
 /**
  * For now, this doesn't do anything remotely intelligent about the initial
  * guess for the scalar and angular flux values and just sets them to unity
@@ -242,6 +340,7 @@ void MoCSweeper::initialize()
     // There are better ways to do this, but for now, just start with 1.0
     flux_     = val;
     flux_old_ = val;
+    this->mark_flux_dirty();
 
     // Walk through the boundary conditions and initialize them the 1/4pi
     real_t bound_val = val / FPI;
@@ -252,6 +351,109 @@ void MoCSweeper::initialize()
     return;
 } // initialize()
 
+void MoCSweeper::push_state()
+{
+    if ((int)boundary_saved_.size() == n_saved_) {
+        boundary_saved_.emplace_back(boundary_.begin(), boundary_.end());
+    }
+    auto &saved = boundary_saved_[n_saved_];
+    for (unsigned i = 0; i < boundary_.size(); i++) {
+        saved[i].copy_values(boundary_[i]);
+    }
+    n_saved_++;
+    return;
+}
+
+void MoCSweeper::restore_state()
+{
+    assert(n_saved_ > 0);
+    const auto &saved = boundary_saved_[n_saved_ - 1];
+    for (unsigned i = 0; i < boundary_.size(); i++) {
+        boundary_[i].copy_values(saved[i]);
+    }
+
+    // Restoring the state usually accompanies setting the flux externally,
+    // as in TransportGMRES
+    this->mark_flux_dirty();
+    return;
+}
+
+void MoCSweeper::pop_state()
+{
+    assert(n_saved_ > 0);
+    n_saved_--;
+    return;
+}
+
+void MoCSweeper::checkpoint(H5Node &node) const
+{
+    TransportSweeper::checkpoint(node);
+    auto g = node.create_group("boundary");
+    for (unsigned i = 0; i < boundary_.size(); i++) {
+        boundary_[i].checkpoint(g, std::to_string(i));
+    }
+    return;
+}
+
+void MoCSweeper::restart(H5Node &node)
+{
+    TransportSweeper::restart(node);
+    auto g = node["boundary"];
+    for (unsigned i = 0; i < boundary_.size(); i++) {
+        boundary_[i].restart(g, std::to_string(i));
+    }
+    return;
+}
+
+void MoCSweeper::initialize_spectrum(const ArrayB1 &spectrum)
+{
+    TransportSweeper::initialize_spectrum(spectrum);
+
+    ArrayB1 bound_spectrum(spectrum.size());
+    for (int ig = 0; ig < n_group_; ig++) {
+        bound_spectrum(ig) = spectrum(ig) / FPI;
+    }
+    for (auto &boundary : boundary_) {
+        boundary.initialize_spectrum(bound_spectrum);
+    }
+    return;
+}
+
+void MoCSweeper::warm_start(H5Node &node)
+{
+    TransportSweeper::warm_start(node);
+
+    // The boundary flux may only be reused if the rays are the same
+    bool same_rays = true;
+    for (unsigned i = 0; i < boundary_.size(); i++) {
+        same_rays = same_rays &&
+                    dataset_matches(node, "boundary/" + std::to_string(i),
+                                    VecI(1, boundary_[i].size()));
+    }
+
+    if (same_rays) {
+        auto g = node["boundary"];
+        for (unsigned i = 0; i < boundary_.size(); i++) {
+            boundary_[i].restart(g, std::to_string(i));
+        }
+    } else {
+        ArrayB1 spectrum = this->flux_spectrum();
+        for (int ig = 0; ig < n_group_; ig++) {
+            spectrum(ig) /= FPI;
+        }
+        for (auto &boundary : boundary_) {
+            boundary.initialize_spectrum(spectrum);
+        }
+    }
+    return;
+}
+
+void MoCSweeper::set_inner_fraction(real_t fraction)
+{
+    scale_inner_iterations(fraction, n_inner_input_, n_inner_, "MoC");
+    return;
+}
+
 void MoCSweeper::update_incoming_flux()
 {
     assert(coarse_data_);
@@ -296,63 +498,12 @@ void MoCSweeper::get_pin_flux_1g(int group, ArrayB1 &flux,
     assert((int)flux.size() == mesh_.n_reg(treatment));
     /// \todo Put this back in when we address index ordering
     /// assert(flux.isStorageContiguous());
-    flux = 0.0;
-
-    switch (treatment) {
-    case MeshTreatment::PIN_PLANE: {
-        int ireg    = 0;
-        int implane = 0;
-        for (const auto &mplane : mesh_.macroplanes()) {
-            int ipin = 0;
-            for (const auto mpin : mplane) {
-                real_t v        = 0.0;
-                real_t pin_flux = 0.0;
-                for (int ir = 0; ir < mpin->n_reg(); ir++) {
-                    v += vol_[ireg];
-                    pin_flux += flux_(ireg, group) * vol_[ireg];
-                    ireg++;
-                }
-                pin_flux /= v;
-
-                Position pos = mesh_.pin_position(ipin);
-                pos.z        = implane;
-                int i        = mesh_.coarse_cell(pos);
-                flux(i) += pin_flux;
-
-                ipin++;
-            }
-            implane++;
-        }
-    } break;
-
-    case MeshTreatment::PIN: {
-        int ireg = 0;
-        for (const auto &mplane : mesh_.macroplanes()) {
-            int ipin = 0;
-            for (const auto mpin : mplane) {
-                real_t v        = 0.0;
-                real_t pin_flux = 0.0;
-                for (int ir = 0; ir < mpin->n_reg(); ir++) {
-                    v += vol_[ireg];
-                    pin_flux += flux_(ireg, group) * vol_[ireg];
-                    ireg++;
-                }
-                pin_flux /= v;
-
-                Position pos = mesh_.pin_position(ipin);
-                for (int iz = mplane.iz_min; iz <= mplane.iz_max; iz++) {
-                    pos.z = iz;
-                    int i = mesh_.coarse_cell(pos);
-                    flux(i) += pin_flux;
-                }
 
-                ipin++;
-            }
-        }
-    } break;
-    default:
+    if ((treatment != MeshTreatment::PIN) &&
+        (treatment != MeshTreatment::PIN_PLANE)) {
         throw EXCEPT("Unsupported mesh treatment requested");
     }
+    pin_projection_.homogenize(flux_, group, flux, treatment);
 
     return;
 }
@@ -362,8 +513,6 @@ real_t MoCSweeper::set_pin_flux_1g(int group, const ArrayB1 &pin_flux,
 {
     assert((int)pin_flux.size() == mesh_.n_reg(treatment));
 
-    ArrayB1 plane_pin_flux(mesh_.nx() * mesh_.ny() * subplane_.size());
-
     // Check for setting any of the pin fluxes to zero. This can cause lots of
     // issues down the line.
     for(auto v: pin_flux) {
@@ -376,95 +525,70 @@ real_t MoCSweeper::set_pin_flux_1g(int group, const ArrayB1 &pin_flux,
 
     real_t resid = 0.0;
 
-    // Watch out: we use fall-through here, since once we have a
-    // macroplane-homogenized flux, we can use the same logic.
     switch (treatment) {
     case MeshTreatment::PIN:
-        plane_pin_flux = 0.0;
         // homogenize the passed-in pin flux to the coarser axial mesh.
-        for (int i = 0; i < mesh_.n_pin(); i++) {
-            Position pos = mesh_.coarse_position(i);
-            int iz       = pos.z;
-            pos.z        = this->moc_plane_index(pos.z);
-            plane_pin_flux(mesh_.coarse_cell(pos)) +=
-                pin_flux(i) * mesh_.dz(iz);
-        }
-        for (unsigned i = 0; i < plane_pin_flux.size(); i++) {
-            int iz = i / (mesh_.nx() * mesh_.ny());
-            plane_pin_flux(i) /= mesh_.macroplane_heights()[iz];
-        }
-    case MeshTreatment::PIN_PLANE: {
-        plane_pin_flux = pin_flux;
-        int iz       = 0;
-        int ireg     = 0;
-        for (const auto &mplane : mesh_.macroplanes()) {
-            int ipin = 0;
-            for (const auto &pin : mplane) {
-                Position pos   = mesh_.pin_position(ipin);
-                pos.z          = iz;
-                int i_coarse   = mesh_.coarse_cell(pos);
-                real_t fm_flux = 0.0;
-                for (const auto area : pin->areas()) {
-                    fm_flux += flux_(ireg, group) * area;
-                    ireg++;
-                }
-                fm_flux /= pin->area();
-                real_t e = plane_pin_flux(i_coarse) - fm_flux;
-                real_t f = plane_pin_flux(i_coarse) / fm_flux;
-                ireg -= pin->n_reg();
-
-                for (int ir = 0; ir < pin->n_reg(); ir++) {
-                    flux_(ireg, group) *= f;
-                    ireg++;
-                }
-
-                resid += e * e;
-                ipin++;
-            }
-            iz++;
+        if ((int)plane_pin_flux_.size() !=
+            mesh_.n_reg(MeshTreatment::PIN_PLANE)) {
+            plane_pin_flux_.resize(mesh_.n_reg(MeshTreatment::PIN_PLANE));
         }
-    } break;
+        pin_projection_.collapse_axial(pin_flux, plane_pin_flux_);
+        resid = pin_projection_.prolong(plane_pin_flux_, flux_, group);
+        break;
+    case MeshTreatment::PIN_PLANE:
+        resid = pin_projection_.prolong(pin_flux, flux_, group);
+        break;
     default:
         // i suppose there is no reason we couldn't use TRUE...
         throw EXCEPT("Unsupported mesh treatment used");
     }
+    this->mark_flux_dirty(group);
 
-    return std::sqrt(resid) / plane_pin_flux.size();
+    return std::sqrt(resid) / mesh_.n_reg(MeshTreatment::PIN_PLANE);
 } // set_pin_flux_1f( group, pin_flux )
 
 void MoCSweeper::apply_transverse_leakage(int group, const ArrayB1 &tl)
 {
-    assert((int)tl.size() == n_reg_);
+    assert((int)tl.size() == mesh_.n_reg(MeshTreatment::PIN_PLANE));
 
     flux_1g_.reference(flux_(blitz::Range::all(), group));
+    const VecI &cell = pin_projection_.fine_cell();
 
     /// \todo for now, this is using a pretty invasive direct access the the
     /// source. Might be good to do as a call to auxiliary() instead
     if (allow_splitting_) {
-        int n_split = 0;
-        split_      = 0.0;
+        int n_split    = 0;
+        int n_negative = 0;
+#pragma omp parallel for reduction(+ : n_split, n_negative)
         for (int ireg = 0; ireg < n_reg_; ireg++) {
-            real_t s = (*source_)[ireg] + tl(ireg);
+            real_t s = (*source_)[ireg] + tl(cell[ireg]);
             if (s < 0.0) {
                 if (flux_1g_(ireg) < 0.0) {
-                    std::cout << ireg << " " << flux_1g_(ireg) << std::endl;
-                    throw EXCEPT("Negative flux when splitting");
+                    n_negative++;
                 }
                 n_split++;
                 split_(ireg)     = -s / flux_1g_(ireg);
                 (*source_)[ireg] = 0.0;
             } else {
+                split_(ireg)     = 0.0;
                 (*source_)[ireg] = s;
             }
         }
 
+        if (n_negative > 0) {
+            std::stringstream msg;
+            msg << "Negative flux in " << n_negative
+                << " regions when splitting";
+            throw EXCEPT(msg.str());
+        }
+
         if (n_split > 0) {
             LogFile << "Split " << n_split << " region sources" << std::endl;
         }
     } else {
+#pragma omp parallel for
         for (int ireg = 0; ireg < n_reg_; ireg++) {
-            real_t s         = (*source_)[ireg] + tl(ireg);
-            (*source_)[ireg] = s;
+            (*source_)[ireg] += tl(cell[ireg]);
         }
     }
 
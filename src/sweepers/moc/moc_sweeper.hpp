@@ -16,12 +16,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <memory>
 #include "util/omp_guard.h"
 #include "util/pugifwd.hpp"
 #include "util/timers.hpp"
 #include "core/angular_quadrature.hpp"
 #include "core/boundary_condition.hpp"
+#include "core/transport_gmres.hpp"
 #include "core/coarse_data.hpp"
 #include "core/core_mesh.hpp"
 #include "core/eigen_interface.hpp"
@@ -70,6 +73,37 @@ public:
 
     void output(H5Node &node) const override;
 
+    void push_state() override;
+
+    void restore_state() override;
+
+    void pop_state() override;
+
+    void set_inner_fraction(real_t fraction) override;
+
+    /**
+     * \copydoc TransportSweeper::checkpoint()
+     *
+     * This adds the incoming boundary angular flux for each plane.
+     */
+    void checkpoint(H5Node &node) const override;
+
+    void restart(H5Node &node) override;
+
+    void initialize_spectrum(const ArrayB1 &spectrum) override;
+
+    void warm_start(H5Node &node) override;
+
+    /**
+     * \copydoc TransportSweeper::prepare_concurrent_groups()
+     *
+     * Concurrent sweeps are not supported with within-group GMRES or CMFD,
+     * which share state across groups, nor with source splitting.
+     */
+    bool prepare_concurrent_groups() override;
+
+    void sweep_concurrent(int group, Source &source) override;
+
     void homogenize(CoarseData &data) const
     {
         throw EXCEPT("Not Implemented");
@@ -105,7 +139,7 @@ public:
     SP_XSMeshHomogenized_t get_homogenized_xsmesh() override final
     {
         auto xsm = SP_XSMeshHomogenized_t(new XSMeshHomogenized(mesh_));
-        xsm->set_flux(flux_);
+        this->attach_homogenized_xsmesh(xsm);
         return xsm;
     }
 
@@ -116,11 +150,44 @@ public:
      * sweeper's source. If enabled and necessary, source splitting will be
      * used to enforce non-negativity on the external (non-self scatter)
      * source.
+     *
+     * \param group the group to which the source applies
+     * \param tl the transverse leakage source on the \ref
+     * MeshTreatment::PIN_PLANE mesh. It is applied to each FSR in the
+     * corresponding pin.
      */
     void apply_transverse_leakage(int group, const ArrayB1 &tl);
 
     void check_balance(int group) const;
 
+    /**
+     * \brief Restrict subsequent sweeps to a subset of the macroplanes
+     *
+     * \param active a flag for each macroplane, indicating whether it should
+     * be swept.
+     *
+     * Regions in inactive macroplanes keep their current scalar flux, and the
+     * current worker sees no rays from them, so any currents or correction
+     * factors that it would produce for those planes are left as they are.
+     */
+    void set_active_planes(const std::vector<bool> &active)
+    {
+        assert(active.size() == active_planes_.size());
+        active_planes_     = active;
+        all_planes_active_ =
+            std::all_of(active.begin(), active.end(), [](bool a) { return a; });
+        return;
+    }
+
+    /**
+     * \brief Return the macroplanes to be swept, as set by \ref
+     * set_active_planes()
+     */
+    const std::vector<bool> &active_planes() const
+    {
+        return active_planes_;
+    }
+
 protected:
     // Data
     Timer &timer_;
@@ -134,6 +201,10 @@ protected:
     std::vector<BoundaryCondition> boundary_;
     // One-group, outgoing boundary flux
     std::vector<BoundaryCondition> boundary_out_;
+    // Stack of saved incoming boundary flux, and its depth. Storage is kept
+    // when popped, to avoid reallocation. See push_state()
+    std::vector<std::vector<BoundaryCondition>> boundary_saved_;
+    int n_saved_;
 
     // Array of one group transport cross sections, including transverse
     // leakage splitting, if necessary
@@ -163,12 +234,39 @@ protected:
     // CoreMesh, but storing them is just as easy
     VecI nreg_plane_;
 
+    // Whether each macroplane is to be swept, and whether that is all of
+    // them. See set_active_planes()
+    std::vector<bool> active_planes_;
+    bool all_planes_active_;
+
     // The source splitting variable. This stores the degree by which to
     // alter the transport cross section for the current group
     ArrayB1 split_;
 
-    // Number of inner iterations per group sweep
+    // Storage for axially-homogenized pin flux in set_pin_flux_1g()
+    ArrayB1 plane_pin_flux_;
+
+    // Per-group state for concurrent group sweeps. Allocated by
+    // prepare_concurrent_groups(), and empty otherwise
+    struct GroupWorkspace {
+        GroupWorkspace(const XSMesh *xs_mesh, bool compact_xs, ArrayB1 flux,
+                       const std::vector<BoundaryCondition> &bc_out)
+            : xstr(xs_mesh, compact_xs), flux_1g(flux), boundary_out(bc_out)
+        {
+        }
+        ExpandedXS xstr;
+        ArrayB1 flux_1g;
+        std::vector<BoundaryCondition> boundary_out;
+    };
+    std::vector<std::unique_ptr<GroupWorkspace>> group_ws_;
+
+    // Number of inner iterations per group sweep, and the number specified
+    // in the input
     unsigned int n_inner_;
+    unsigned int n_inner_input_;
+
+    // Within-group GMRES solver. Null if using source iteration
+    UP_TransportGMRES_t inner_gmres_;
 
     // Boundary condition enumeration
     std::array<Boundary, 6> bc_type_;
@@ -35,7 +35,59 @@
  */
 template <typename CurrentWorker> void sweep1g(int group, CurrentWorker &cw)
 {
-    flux_1g_ = 0.0;
+    this->sweep1g(group, cw, xstr_, flux_1g_, boundary_out_, *source_);
+    return;
+}
+
+/**
+ * \brief Perform an MoC sweep, using the passed per-group state.
+ *
+ * This is the same as above, but the transport cross sections, scalar flux
+ * slice, outgoing boundary flux storage and source are passed in, rather than
+ * taken from the sweeper. So long as these are distinct, different groups may
+ * be swept concurrently by separate thread teams.
+ */
+template <typename CurrentWorker>
+void sweep1g(int group, CurrentWorker &cw, const ExpandedXS &xstr,
+             ArrayB1 &flux_1g, std::vector<BoundaryCondition> &boundary_outs,
+             const Source &source)
+{
+    // Dispatch on the cross section storage once, so that neither kernel
+    // needs to check it per segment
+    if (xstr.compact()) {
+        this->sweep1g_xs(group, cw, xstr.compact_view(), flux_1g,
+                         boundary_outs, source);
+    } else {
+        this->sweep1g_xs(group, cw, xstr.dense_view(), flux_1g, boundary_outs,
+                         source);
+    }
+
+    // Let any XS meshes homogenized with this flux know that it changed
+    this->mark_flux_dirty(group);
+    return;
+}
+
+/**
+ * \brief The MoC sweep kernel proper, instantiated for each of the \ref
+ * ExpandedXS::Dense and \ref ExpandedXS::Compact cross section views.
+ */
+template <typename CurrentWorker, typename XSView>
+void sweep1g_xs(int group, CurrentWorker &cw, const XSView xstr,
+                ArrayB1 &flux_1g, std::vector<BoundaryCondition> &boundary_outs,
+                const Source &source)
+{
+    // Only clear the flux in the macroplanes that are going to be swept
+    if (all_planes_active_) {
+        flux_1g = 0.0;
+    } else {
+        for (int iplane = 0; iplane < (int)active_planes_.size(); iplane++) {
+            if (active_planes_[iplane]) {
+                int first = first_reg_macroplane_[iplane];
+                flux_1g(blitz::Range(first, first + nreg_plane_[iplane] - 1)) =
+                    0.0;
+            }
+        }
+    }
 
     cw.set_group(group);
 
@@ -49,16 +101,20 @@ template <typename CurrentWorker> void sweep1g(int group, CurrentWorker &cw)
 
         int iplane = 0;
         for (const auto plane_ray_id : macroplane_unique_ids_) {
+            if (!active_planes_[iplane]) {
+                iplane++;
+                continue;
+            }
             int first_reg      = first_reg_macroplane_[iplane];
             auto &boundary_in  = boundary_[iplane];
-            auto &boundary_out = boundary_out_[iplane];
+            auto &boundary_out = boundary_outs[iplane];
             cw.set_plane(iplane);
             const auto &plane_rays = rays_[plane_ray_id];
             int iang               = 0;
             // Angles
             for (const auto &ang_rays : plane_rays) {
                 // Get the source for this angle
-                auto &qbar = source_->get_transport(iang);
+                auto &qbar = source.get_transport(iang);
 
                 int iang1 = iang;
                 int iang2 = ang_quad_.reverse(iang);
@@ -94,7 +150,7 @@ template <typename CurrentWorker> void sweep1g(int group, CurrentWorker &cw)
                     for (int iseg = 0; iseg < ray.nseg(); iseg++) {
                         int ireg    = ray.seg_index(iseg) + first_reg;
                         e_tau(iseg) = 1.0 -
-                                      exp_.exp(-xstr_[ireg] *
+                                      exp_.exp(-xstr[ireg] *
                                                ray.seg_len(iseg) * rstheta);
                     }
 
@@ -157,7 +213,7 @@ template <typename CurrentWorker> void sweep1g(int group, CurrentWorker &cw)
         {
             /// \todo make an array operation after refactoring out valarray
             for (int i = 0; i < (int)n_reg_; i++) {
-                flux_1g_(i) += t_flux(i);
+                flux_1g(i) += t_flux(i);
             }
         }
 #pragma omp barrier
@@ -165,10 +221,18 @@ template <typename CurrentWorker> void sweep1g(int group, CurrentWorker &cw)
 #pragma omp single
         {
             // \todo this is not correct for angle-dependent sources!
-            auto &qbar = source_->get_transport(0);
-            for (int i = 0; i < (int)n_reg_; i++) {
-                flux_1g_(i) =
-                    flux_1g_(i) / (xstr_[i] * vol_[i]) + qbar[i] * FPI;
+            auto &qbar = source.get_transport(0);
+            for (int iplane = 0; iplane < (int)active_planes_.size();
+                 iplane++) {
+                if (!active_planes_[iplane]) {
+                    continue;
+                }
+                int first = first_reg_macroplane_[iplane];
+                int last  = first + nreg_plane_[iplane];
+                for (int i = first; i < last; i++) {
+                    flux_1g(i) =
+                        flux_1g(i) / (xstr[i] * vol_[i]) + qbar[i] * FPI;
+                }
             }
         } // OMP single
 
@@ -177,4 +241,4 @@ template <typename CurrentWorker> void sweep1g(int group, CurrentWorker &cw)
     } // OMP Parallel
 
     return;
-} // sweep1g
+} // sweep1g_xs
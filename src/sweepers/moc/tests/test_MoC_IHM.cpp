@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "pugixml.hpp"
 #include "util/blitz_typedefs.hpp"
 #include "util/global_config.hpp"
@@ -149,6 +150,129 @@ TEST(moc_ihm)
     }
 }
 
+// Same as above, but using a single GMRES within-group solve in place of the
+// many source iterations.
+TEST(moc_ihm_gmres)
+{
+    std::string gmres_xml = ihm_xml;
+    std::string si_sweeper = "n_inner=\"800\"";
+    gmres_xml.replace(gmres_xml.find(si_sweeper), si_sweeper.size(),
+                      "n_inner=\"1\" inner_solver=\"gmres\" "
+                      "inner_tol=\"1e-8\"");
+    auto result = xml_doc.load_string(gmres_xml.c_str());
+    CHECK(result);
+
+    int ng = 7;
+    ArrayB1 flux_ref(ng);
+    ArrayB1 psi_ref(ng);
+    real_t k_ref;
+    reference_solution(k_ref, flux_ref, psi_ref);
+
+    CoreMesh core_mesh(xml_doc);
+
+    TestMoCSweeper sweeper(xml_doc.child("sweeper"), core_mesh);
+    auto source = sweeper.create_source(xml_doc.child("source"));
+    sweeper.assign_source(source.get());
+
+    // The reference flux is normalized to a unit fission source
+    ArrayB1 fission_source(sweeper.n_reg());
+    fission_source = 1.0;
+
+    for (int ig = 0; ig < ng; ig++) {
+        // In-scatter comes from the reference flux in the other groups, but
+        // start the group itself from a wrong guess, so that the inner solve
+        // has something to do.
+        sweeper.set_spectrum(flux_ref);
+        sweeper.flux()(blitz::Range::all(), ig) = 1.0;
+        source->initialize_group(ig);
+        source->fission(fission_source, ig);
+        source->in_scatter(ig);
+        sweeper.sweep(ig);
+
+        for (int ireg = 0; ireg < sweeper.n_reg(); ireg++) {
+            CHECK_CLOSE(flux_ref(ig), sweeper.flux(ig, ireg),
+                        0.005 * flux_ref(ig));
+        }
+    }
+}
+
+// Same as the first test, but with all groups swept at once, each with its own
+// source, as is done for Jacobi iterations in energy
+TEST(moc_ihm_concurrent)
+{
+    auto result = xml_doc.load_string(ihm_xml.c_str());
+    CHECK(result);
+
+    int ng = 7;
+    ArrayB1 flux_ref(ng);
+    ArrayB1 psi_ref(ng);
+    real_t k_ref;
+    reference_solution(k_ref, flux_ref, psi_ref);
+
+    CoreMesh core_mesh(xml_doc);
+
+    TestMoCSweeper sweeper(xml_doc.child("sweeper"), core_mesh);
+    CHECK(sweeper.prepare_concurrent_groups());
+
+    sweeper.set_spectrum(flux_ref);
+
+    ArrayB1 fission_source(sweeper.n_reg());
+    fission_source = 1.0;
+
+    std::vector<UP_Source_t> sources;
+    for (int ig = 0; ig < ng; ig++) {
+        sources.push_back(sweeper.create_source(xml_doc.child("source")));
+        sources.back()->initialize_group(ig);
+        sources.back()->fission(fission_source, ig);
+        sources.back()->in_scatter(ig);
+    }
+
+#pragma omp parallel for num_threads(ng)
+    for (int ig = 0; ig < ng; ig++) {
+        sweeper.sweep_concurrent(ig, *sources[ig]);
+    }
+
+    for (int ig = 0; ig < ng; ig++) {
+        for (int ireg = 0; ireg < sweeper.n_reg(); ireg++) {
+            CHECK_CLOSE(flux_ref(ig), sweeper.flux(ig, ireg),
+                        0.005 * flux_ref(ig));
+        }
+    }
+}
+
+// The infinite-medium spectrum used for the initial guess should reproduce
+// the reference solution directly, since the problem is already an infinite
+// homogeneous medium.
+TEST(moc_ihm_spectrum)
+{
+    auto result = xml_doc.load_string(ihm_xml.c_str());
+    CHECK(result);
+
+    int ng = 7;
+    ArrayB1 flux_ref(ng);
+    ArrayB1 psi_ref(ng);
+    real_t k_ref;
+    reference_solution(k_ref, flux_ref, psi_ref);
+
+    CoreMesh core_mesh(xml_doc);
+
+    TestMoCSweeper sweeper(xml_doc.child("sweeper"), core_mesh);
+
+    real_t k_inf     = 0.0;
+    ArrayB1 spectrum = sweeper.ihm_spectrum(k_inf);
+    CHECK_CLOSE(k_ref, k_inf, 1.0e-12);
+
+    // The spectrum is normalized to an average of one
+    REQUIRE CHECK_EQUAL(ng, (int)spectrum.size());
+    real_t norm = 0.0;
+    for (int ig = 0; ig < ng; ig++) {
+        norm += flux_ref(ig) / ng;
+    }
+    for (int ig = 0; ig < ng; ig++) {
+        CHECK_CLOSE(flux_ref(ig) / norm, spectrum(ig), 1.0e-10);
+    }
+}
+
 void reference_solution(real_t &k_eff, ArrayB1 &flux, ArrayB1 &psi)
 {
     const MaterialLib mat_lib(xml_doc.child("material_lib"));
@@ -35,8 +35,10 @@ BC_Size_t boundary_helper(const Mesh &mesh)
 }
 
 const std::vector<std::string> recognized_attributes = {
-    "type",  "n_inner",         "equation",
-    "axial", "boundary_update", "update_incoming"};
+    "type",         "n_inner",         "equation",
+    "axial",        "boundary_update", "update_incoming",
+    "inner_solver", "inner_krylov",    "inner_tol",
+    "inner_dsa"};
 }
 
 namespace mocc {
@@ -54,7 +56,9 @@ SnSweeper::SnSweeper(const pugi::xml_node &input, const CoreMesh &mesh)
       bc_in_(mesh.mat_lib().n_group(), ang_quad_, bc_type_,
              boundary_helper(mesh)),
       bc_out_(1, ang_quad_, bc_type_, boundary_helper(mesh)),
-      gs_boundary_(true)
+      n_saved_(0),
+      gs_boundary_(true),
+      update_xs_(true)
 {
     LogFile << "Constructing a base Sn sweeper" << std::endl;
     validate_input(input, recognized_attributes);
@@ -93,7 +97,11 @@ SnSweeper::SnSweeper(const pugi::xml_node &input, const CoreMesh &mesh)
         throw EXCEPT("Invalid number of inner iterations specified "
                      "(n_inner).");
     }
-    n_inner_ = int_in;
+    n_inner_       = int_in;
+    n_inner_input_ = int_in;
+
+    // Within-group Krylov solver, if requested
+    inner_gmres_ = InnerGMRESFactory(input);
 
     // Try to read boundary update option
     if (!input.attribute("boundary_update").empty()) {
@@ -173,6 +181,40 @@ void SnSweeper::update_incoming_flux()
     }
 }
 
+void SnSweeper::set_inner_fraction(real_t fraction)
+{
+    scale_inner_iterations(fraction, n_inner_input_, n_inner_, "Sn");
+    return;
+}
+
+void SnSweeper::initialize_spectrum(const ArrayB1 &spectrum)
+{
+    TransportSweeper::initialize_spectrum(spectrum);
+
+    ArrayB1 bound_spectrum(spectrum.size());
+    for (int ig = 0; ig < n_group_; ig++) {
+        bound_spectrum(ig) = spectrum(ig) / FPI;
+    }
+    bc_in_.initialize_spectrum(bound_spectrum);
+    return;
+}
+
+void SnSweeper::warm_start(H5Node &node)
+{
+    TransportSweeper::warm_start(node);
+
+    if (dataset_matches(node, "boundary", VecI(1, bc_in_.size()))) {
+        bc_in_.restart(node, "boundary");
+    } else {
+        ArrayB1 spectrum = this->flux_spectrum();
+        for (int ig = 0; ig < n_group_; ig++) {
+            spectrum(ig) /= FPI;
+        }
+        bc_in_.initialize_spectrum(spectrum);
+    }
+    return;
+}
+
 ArrayB3 SnSweeper::pin_powers() const
 {
     ArrayB3 powers(mesh_.nz(), mesh_.ny(), mesh_.nx());
@@ -15,11 +15,13 @@
 */
 #pragma once
 
+#include <deque>
 #include "util/pugifwd.hpp"
 #include "util/timers.hpp"
 #include "util/utils.hpp"
 #include "core/angular_quadrature.hpp"
 #include "core/boundary_condition.hpp"
+#include "core/transport_gmres.hpp"
 #include "core/transport_sweeper.hpp"
 #include "cell_worker.hpp"
 
@@ -51,30 +53,9 @@ public:
 
         switch (treatment) {
         case MeshTreatment::PIN:
-            flux = flux_(blitz::Range::all(), group);
+        case MeshTreatment::PIN_PLANE:
+            pin_projection_.homogenize(flux_, group, flux, treatment);
             break;
-        case MeshTreatment::PIN_PLANE: {
-            flux            = 0.0;
-            int n_per_plane = mesh_.nx() * mesh_.ny();
-            int imp         = 0;
-            int mplane_stt  = 0;
-            int mplane_stp  = 0;
-            for (const auto &mplane : mesh_.macroplanes()) {
-                mplane_stp = mplane_stt + n_per_plane;
-                for (int iz = mplane.iz_min; iz <= mplane.iz_max; iz++) {
-                    real_t hz = mesh_.dz(iz);
-                    flux(blitz::Range(mplane_stt, mplane_stp - 1)) +=
-                        flux_(blitz::Range(mesh_.plane_cell_begin(iz),
-                                           mesh_.plane_cell_end(iz) - 1),
-                              group) *
-                        hz;
-                }
-                flux(blitz::Range(mplane_stt, mplane_stp - 1)) /= mplane.height;
-
-                mplane_stt = mplane_stp;
-                imp++;
-            }
-        } break;
         default:
             throw EXCEPT("Unsupported mesh treatment");
         }
@@ -116,31 +97,10 @@ public:
                 i++;
             }
         } break;
-        case MeshTreatment::PIN_PLANE: {
-            // use our own ge_pin_flux on the PIN_PLANE basis to get a
-            // projection ratio, then use that.
-            ArrayB1 plane_pin_flux(mesh_.n_reg(MeshTreatment::PIN_PLANE));
-            this->get_pin_flux_1g(group, plane_pin_flux,
-                                  MeshTreatment::PIN_PLANE);
-            plane_pin_flux /= pin_flux;
-
-            int n_per_plane = mesh_.nx() * mesh_.ny();
-            int mplane_stt  = 0;
-            int mplane_stp  = 0;
-            for (const auto &mplane : mesh_.macroplanes()) {
-                mplane_stp = mplane_stt + n_per_plane;
-
-                for (int iz = mplane.iz_min; iz <= mplane.iz_max; iz++) {
-                    flux_(blitz::Range(mesh_.plane_cell_begin(iz),
-                                       mesh_.plane_cell_end(iz) - 1),
-                          group) /=
-                        plane_pin_flux(
-                            blitz::Range(mplane_stt, mplane_stp - 1));
-                }
-
-                mplane_stt = mplane_stp;
-            }
-        } break;
+        case MeshTreatment::PIN_PLANE:
+            // Scale the pins in each macroplane to match the passed flux
+            resid = pin_projection_.prolong(pin_flux, flux_, group);
+            break;
 
         default:
             throw EXCEPT("Unsupported mesh treatement type.");
@@ -168,8 +128,71 @@ public:
         return xstr_;
     }
 
+    /**
+     * \brief Specify whether sweep() should update the homogenized cross
+     * sections before sweeping.
+     *
+     * This is on by default. An owner that updates the cross sections itself
+     * can turn it off, e.g. when they are homogenized from a flux that another
+     * sweeper is writing to at the same time.
+     */
+    void set_update_xs(bool update)
+    {
+        update_xs_ = update;
+        return;
+    }
+
     virtual void output(H5Node &node) const override;
 
+    void push_state() override
+    {
+        if ((int)bc_in_saved_.size() == n_saved_) {
+            bc_in_saved_.push_back(bc_in_);
+        }
+        bc_in_saved_[n_saved_].copy_values(bc_in_);
+        n_saved_++;
+        return;
+    }
+
+    void restore_state() override
+    {
+        assert(n_saved_ > 0);
+        bc_in_.copy_values(bc_in_saved_[n_saved_ - 1]);
+        return;
+    }
+
+    void pop_state() override
+    {
+        assert(n_saved_ > 0);
+        n_saved_--;
+        return;
+    }
+
+    void set_inner_fraction(real_t fraction) override;
+
+    /**
+     * \copydoc TransportSweeper::checkpoint()
+     *
+     * This adds the incoming boundary angular flux.
+     */
+    void checkpoint(H5Node &node) const override
+    {
+        TransportSweeper::checkpoint(node);
+        bc_in_.checkpoint(node, "boundary");
+        return;
+    }
+
+    void restart(H5Node &node) override
+    {
+        TransportSweeper::restart(node);
+        bc_in_.restart(node, "boundary");
+        return;
+    }
+
+    void initialize_spectrum(const ArrayB1 &spectrum) override;
+
+    void warm_start(H5Node &node) override;
+
 protected:
     Timer &timer_;
     Timer &timer_init_;
@@ -179,7 +202,13 @@ protected:
 
     VecI macroplanes_;
 
+    // Number of inner iterations per group sweep, and the number specified
+    // in the input
     unsigned int n_inner_;
+    unsigned int n_inner_input_;
+
+    // Within-group GMRES solver. Null if using source iteration
+    UP_TransportGMRES_t inner_gmres_;
 
     // Boundary condition enumeration
     std::array<Boundary, 6> bc_type_;
@@ -198,9 +227,17 @@ protected:
     // Outgoing boundary condition. Only difined for one group
     BoundaryCondition bc_out_;
 
+    // Stack of saved incoming boundary conditions, and its depth. This is a
+    // deque so that pushing does not copy existing entries. See push_state()
+    std::deque<BoundaryCondition> bc_in_saved_;
+    int n_saved_;
+
     // Gauss-Seidel BC update?
     bool gs_boundary_;
 
+    // Update the cross sections at the start of sweep()?
+    bool update_xs_;
+
     // Protected methods
     /**
      * \brief Grab data (XS, etc.) from one or more external files
@@ -96,9 +96,13 @@ public:
         assert(source_);
         timer_.tic();
 
-        timer_xsupdate_.tic();
-        xs_mesh_->update();
-        timer_xsupdate_.toc();
+        n_sweep_++;
+
+        if (update_xs_) {
+            timer_xsupdate_.tic();
+            xs_mesh_->update();
+            timer_xsupdate_.toc();
+        }
 
         timer_sweep_.tic();
 
@@ -112,11 +116,34 @@ public:
 
         flux_1g_.reference(flux_(blitz::Range::all(), group));
 
-        // Perform inner iterations
-        for (unsigned inner = 0; inner < n_inner_; inner++) {
+        // Converge the within-group problem with GMRES, if enabled, then
+        // finish with a single regular sweep
+        unsigned n_inner = n_inner_;
+        if (inner_gmres_) {
+            inner_gmres_->solve(
+                flux_(blitz::Range::all(), blitz::Range(group, group)),
+                [&]() {
+                    source_->self_scatter(group);
+                    if (core_mesh_->is_2d()) {
+                        this->sweep_1g_2d<sn::NoCurrent>(group);
+                    } else {
+                        this->sweep_1g<sn::NoCurrent>(group);
+                    }
+                },
+                *this);
+            n_inner = 1;
+        }
+
+        // Perform inner iterations. With within-group CMFD, currents are
+        // needed from every inner
+        bool dsa = this->inner_dsa_active();
+        for (unsigned inner = 0; inner < n_inner; inner++) {
             // Set the source (add upscatter and divide by 4PI)
             source_->self_scatter(group);
-            if (inner == n_inner_ - 1 && coarse_data_) {
+            if (dsa) {
+                this->store_inner_dsa_flux(group);
+            }
+            if ((inner == n_inner - 1 || dsa) && coarse_data_) {
                 // Wipe out the existing currents
                 coarse_data_->zero_data(group);
                 coarse_data_->source() = "Sn Sweeper";
@@ -134,6 +161,10 @@ public:
                     this->sweep_1g<sn::NoCurrent>(group);
                 }
             }
+
+            if (dsa) {
+                this->apply_inner_dsa(group);
+            }
         }
 
         // Clean up zeros
@@ -0,0 +1,178 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "util/h5file.hpp"
+#include "input_proc.hpp"
+#include "solvers/eigen_solver.hpp"
+#include "sweepers/cmdo/plane_sweeper_2d3d.hpp"
+
+using namespace mocc;
+
+namespace {
+// Command-line arguments to process the 2d3d.xml problem with the passed
+// amendments
+std::vector<std::string> args_2d3d(const std::vector<std::string> &amendments)
+{
+    std::vector<std::string> args = {"int_test"};
+    for (const auto &a : amendments) {
+        args.push_back("-a");
+        args.push_back(a);
+    }
+    args.push_back("2d3d.xml");
+    return args;
+}
+
+// Solve the 2d3d.xml problem with the passed command-line amendments, and
+// return the eigenvalue
+real_t solve_2d3d(const std::vector<std::string> &amendments)
+{
+    InputProcessor input_proc(args_2d3d(amendments));
+    input_proc.process();
+    auto solver = std::dynamic_pointer_cast<EigenSolver>(input_proc.solver());
+    REQUIRE CHECK(solver);
+    solver->solve();
+    return solver->keff();
+}
+}
+
+/**
+ * Running the MoC and Sn sweeps concurrently lags the correction factors by an
+ * outer iteration, but should converge to the same eigenvalue as the serial
+ * sweeps.
+ */
+TEST(test_2d3d_concurrent)
+{
+    real_t k_serial     = solve_2d3d({});
+    real_t k_concurrent = solve_2d3d({"solver/sweeper/concurrent=t"});
+    CHECK_CLOSE(k_serial, k_concurrent, 1.0e-6);
+}
+
+/**
+ * MoC sweeps of macroplanes that have converged are skipped. The MoC flux and
+ * correction factors of the skipped planes should be left alone, and the
+ * skipping state should survive a checkpoint.
+ */
+TEST(test_2d3d_plane_skip)
+{
+    InputProcessor input_proc(args_2d3d({"solver/sweeper/moc_plane_tol=1e-2"}));
+    input_proc.process();
+    auto solver = std::dynamic_pointer_cast<EigenSolver>(input_proc.solver());
+    REQUIRE CHECK(solver);
+    solver->solve();
+
+    auto sweeper = dynamic_cast<cmdo::PlaneSweeper_2D3D *>(solver->sweeper());
+    REQUIRE CHECK(sweeper);
+    const auto &moc         = sweeper->moc_sweeper();
+    const auto &corrections = sweeper->corrections();
+
+    // Perturb the flux in the bottom plane of the last group, which is the
+    // one that the source was last set up for. After one more sweep, this
+    // should show up in the MoC/Sn residual of that plane, but hardly at all
+    // in the planes further up.
+    const int group        = sweeper->n_group() - 1;
+    const int n_plane      = moc.active_planes().size();
+    const int n_cell       = corrections.n_cell();
+    const int n_cell_plane = n_cell / n_plane;
+    ArrayB1 pin_flux(n_cell);
+    sweeper->get_pin_flux_1g(group, pin_flux, MeshTreatment::PIN_PLANE);
+    pin_flux(blitz::Range(0, n_cell_plane - 1)) *= 1.5;
+    sweeper->set_pin_flux_1g(group, pin_flux, MeshTreatment::PIN_PLANE);
+    sweeper->sweep(group);
+
+    // Sweep again, now with the perturbed plane active
+    const int n_reg_plane = moc.n_reg() / n_plane;
+    const int n_ang       = corrections.extents()[1];
+    ArrayB1 flux_prev(moc.flux()(blitz::Range::all(), group).copy());
+    std::vector<real_t> corrections_prev;
+    for (int i = 0; i < n_cell; i++) {
+        for (int iang = 0; iang < n_ang; iang++) {
+            corrections_prev.push_back(
+                corrections.alpha(i, iang, group, Normal::X_NORM));
+            corrections_prev.push_back(
+                corrections.alpha(i, iang, group, Normal::Y_NORM));
+            corrections_prev.push_back(corrections.beta(i, iang, group));
+        }
+    }
+    sweeper->sweep(group);
+
+    const auto &active = moc.active_planes();
+    CHECK(active[0]);
+    int n_skipped = 0;
+    for (int iplane = 0; iplane < n_plane; iplane++) {
+        if (active[iplane]) {
+            continue;
+        }
+        n_skipped++;
+        for (int i = iplane * n_reg_plane; i < (iplane + 1) * n_reg_plane;
+             i++) {
+            CHECK_EQUAL(flux_prev(i), moc.flux(group, i));
+        }
+        for (int i = iplane * n_cell_plane; i < (iplane + 1) * n_cell_plane;
+             i++) {
+            for (int iang = 0; iang < n_ang; iang++) {
+                const real_t *prev = &corrections_prev[3 * (i * n_ang + iang)];
+                CHECK_EQUAL(prev[0],
+                            corrections.alpha(i, iang, group, Normal::X_NORM));
+                CHECK_EQUAL(prev[1],
+                            corrections.alpha(i, iang, group, Normal::Y_NORM));
+                CHECK_EQUAL(prev[2], corrections.beta(i, iang, group));
+            }
+        }
+    }
+    CHECK(n_skipped > 0);
+
+    // Restore the checkpointed state into a fresh sweeper, and make sure
+    // that the same planes would be skipped
+    {
+        H5Node h5f("2d3d_skip.h5", H5Access::WRITE);
+        sweeper->checkpoint(h5f);
+    }
+    InputProcessor input_proc_r(
+        args_2d3d({"solver/sweeper/moc_plane_tol=1e-2"}));
+    input_proc_r.process();
+    auto solver_r =
+        std::dynamic_pointer_cast<EigenSolver>(input_proc_r.solver());
+    REQUIRE CHECK(solver_r);
+    auto sweeper_r =
+        dynamic_cast<cmdo::PlaneSweeper_2D3D *>(solver_r->sweeper());
+    REQUIRE CHECK(sweeper_r);
+    {
+        H5Node h5f("2d3d_skip.h5", H5Access::READ);
+        sweeper_r->restart(h5f);
+    }
+    CHECK(active == sweeper_r->moc_sweeper().active_planes());
+    {
+        H5Node h5f("2d3d_skip.h5", H5Access::READ);
+        ArrayB2 resid;
+        h5f.read("plane_residual", resid);
+        H5Node h5f_r("2d3d_skip_r.h5", H5Access::WRITE);
+        sweeper_r->checkpoint(h5f_r);
+        ArrayB2 resid_r;
+        h5f_r.read("plane_residual", resid_r);
+        REQUIRE CHECK_EQUAL(resid.size(), resid_r.size());
+        CHECK_ARRAY_EQUAL(resid.data(), resid_r.data(), resid.size());
+    }
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,247 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pugixml.hpp"
+#include "util/blitz_typedefs.hpp"
+#include "util/error.hpp"
+#include "util/omp_guard.h"
+#include "input_proc.hpp"
+#include "solvers/eigen_solver.hpp"
+
+using namespace mocc;
+
+namespace {
+// Attribute paths, relative to the document root, and the values to give
+// them
+typedef std::vector<std::pair<std::string, std::string>> Changes;
+
+// Set the attribute at the passed path (e.g. "solver/wielandt/shift"),
+// creating any tags and the attribute itself if they don't exist yet. This
+// allows options to be enabled that 3x3.xml doesn't mention, which a
+// command-line amendment can't do.
+void set_attribute(pugi::xml_node node, std::string path,
+                   const std::string &value)
+{
+    size_t pos;
+    while ((pos = path.find("/")) != std::string::npos) {
+        std::string name = path.substr(0, pos);
+        path             = path.substr(pos + 1);
+        if (node.child(name.c_str()).empty()) {
+            node.append_child(name.c_str());
+        }
+        node = node.child(name.c_str());
+    }
+    if (node.attribute(path.c_str()).empty()) {
+        node.append_attribute(path.c_str());
+    }
+    node.attribute(path.c_str()).set_value(value.c_str());
+    return;
+}
+
+// Write a copy of 3x3.xml, with the passed changes, to <name>.xml. The case
+// name, and therefore the name of any checkpoint file, follows from the name
+// of the input file.
+std::string write_deck(const std::string &name, const Changes &changes)
+{
+    pugi::xml_document doc;
+    pugi::xml_parse_result result = doc.load_file("3x3.xml");
+    if (!result) {
+        throw EXCEPT("Failed to load 3x3.xml");
+    }
+    for (const auto &c : changes) {
+        set_attribute(doc, c.first, c.second);
+    }
+
+    std::string fname = name + ".xml";
+    if (!doc.save_file(fname.c_str())) {
+        throw EXCEPT("Failed to write " + fname);
+    }
+    return fname;
+}
+
+// The parts of a finished eigenvalue solve that the tests look at
+struct EigenResult {
+    real_t k;
+    ArrayB2 flux;
+    std::vector<ConvergenceCriteria> convergence;
+    int n_sweep;
+};
+
+// Solve 3x3.xml with the passed changes
+EigenResult solve_eigen(const std::string &name, const Changes &changes)
+{
+    std::vector<std::string> args = {"int_test", write_deck(name, changes)};
+
+    // The input processor owns the mesh, so it has to outlive the solver
+    InputProcessor input_proc(args);
+    input_proc.process();
+    auto solver = std::dynamic_pointer_cast<EigenSolver>(input_proc.solver());
+    if (!solver) {
+        throw EXCEPT("Not an eigenvalue solver");
+    }
+    solver->solve();
+
+    EigenResult result;
+    result.k           = solver->keff();
+    result.flux.reference(solver->sweeper()->flux().copy());
+    result.convergence = solver->convergence();
+    result.n_sweep     = solver->sweeper()->n_sweep();
+    return result;
+}
+
+// Whether a solve of 3x3.xml met its convergence criteria
+bool converged(const EigenResult &result)
+{
+    if (result.convergence.empty()) {
+        return false;
+    }
+    const auto &last = result.convergence.back();
+    return (last.error_k < 1.0e-7) && (last.error_psi < 1.0e-6);
+}
+}
+
+/**
+ * Adaptive control of the CMFD convergence criteria and inner iterations
+ * should only change how quickly the solve converges, not what it converges
+ * to.
+ */
+TEST(test_eigen_adaptive)
+{
+    auto fixed    = solve_eigen("eigen_fixed", {});
+    auto adaptive = solve_eigen("eigen_adaptive", {{"solver/adaptive", "t"}});
+
+    CHECK(converged(fixed));
+    CHECK(converged(adaptive));
+    CHECK_CLOSE(fixed.k, adaptive.k, 1.0e-5);
+}
+
+/**
+ * Selective group sweeps should skip groups whose flux has settled, yet still
+ * converge to the same eigenvalue. The tolerances are loose, so that groups
+ * are skipped well before convergence; a full sweep is then forced before
+ * the solve may finish.
+ */
+TEST(test_eigen_selective)
+{
+    auto full      = solve_eigen("eigen_full", {});
+    auto selective = solve_eigen("eigen_selective",
+                                 {{"solver/selective/tol", "1.0e-3"},
+                                  {"solver/selective/source_tol", "1.0e-2"},
+                                  {"solver/selective/period", "4"}});
+
+    CHECK(converged(full));
+    CHECK(converged(selective));
+    CHECK_CLOSE(full.k, selective.k, 1.0e-5);
+
+    // Without skipping, every outer iteration sweeps every group
+    int n_group = full.flux.extent(1);
+    CHECK_EQUAL((int)full.convergence.size() * n_group, full.n_sweep);
+    CHECK((int)selective.convergence.size() * n_group > selective.n_sweep);
+}
+
+/**
+ * Restarting from a checkpoint should continue the iteration exactly where it
+ * left off. Reductions are only reproducible with a fixed thread count, so
+ * this runs serially.
+ */
+TEST(test_eigen_restart)
+{
+    int n_thread = omp_get_max_threads();
+    omp_set_num_threads(1);
+
+    const int n_stop = 5;
+    auto reference   = solve_eigen("eigen_reference", {});
+    auto partial     = solve_eigen(
+        "eigen_partial", {{"solver/max_iter", std::to_string(n_stop)},
+                          {"solver/checkpoint", std::to_string(n_stop)}});
+    auto restarted = solve_eigen(
+        "eigen_restarted",
+        {{"solver/restart", "eigen_partial_checkpoint.h5"}});
+
+    omp_set_num_threads(n_thread);
+
+    CHECK(converged(reference));
+    REQUIRE CHECK((int)reference.convergence.size() > n_stop);
+    CHECK_EQUAL(n_stop, (int)partial.convergence.size());
+
+    CHECK_EQUAL(reference.k, restarted.k);
+    REQUIRE CHECK_EQUAL(reference.convergence.size(),
+                        restarted.convergence.size());
+    for (int i = 0; i < (int)reference.convergence.size(); i++) {
+        CHECK_EQUAL(reference.convergence[i].k, restarted.convergence[i].k);
+        CHECK_EQUAL(reference.convergence[i].error_k,
+                    restarted.convergence[i].error_k);
+        CHECK_EQUAL(reference.convergence[i].error_psi,
+                    restarted.convergence[i].error_psi);
+    }
+
+    REQUIRE CHECK_EQUAL(reference.flux.size(), restarted.flux.size());
+    auto it = restarted.flux.begin();
+    for (auto v : reference.flux) {
+        CHECK_EQUAL(v, *it);
+        ++it;
+    }
+}
+
+/**
+ * A Wielandt shift, fixed or adaptive, should converge to the same eigenvalue
+ * as the unshifted power iteration.
+ */
+TEST(test_eigen_wielandt)
+{
+    auto unshifted = solve_eigen("eigen_unshifted", {});
+    auto shifted   = solve_eigen("eigen_wielandt",
+                               {{"solver/wielandt", "t"},
+                                {"solver/wielandt/shift", "0.5"}});
+    auto adaptive  = solve_eigen("eigen_wielandt_adaptive",
+                                {{"solver/wielandt", "t"},
+                                 {"solver/wielandt/shift", "0.5"},
+                                 {"solver/wielandt/adaptive", "t"}});
+
+    CHECK(converged(unshifted));
+    CHECK(converged(shifted));
+    CHECK(converged(adaptive));
+    CHECK_CLOSE(unshifted.k, shifted.k, 1.0e-5);
+    CHECK_CLOSE(unshifted.k, adaptive.k, 1.0e-5);
+}
+
+/**
+ * The JFNK solver should converge to the same eigenvalue as power iteration,
+ * in fewer transport sweeps. Neither is accelerated with CMFD.
+ */
+TEST(test_eigen_jfnk)
+{
+    auto power = solve_eigen(
+        "eigen_power", {{"solver/cmfd", "f"}, {"solver/max_iter", "1000"}});
+    auto jfnk = solve_eigen("eigen_jfnk",
+                            {{"solver/type", "jfnk"}, {"solver/cmfd", "f"}});
+
+    CHECK(converged(power));
+    CHECK(converged(jfnk));
+    CHECK_CLOSE(power.k, jfnk.k, 1.0e-5);
+    CHECK(jfnk.n_sweep < power.n_sweep);
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,108 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "UnitTest++/UnitTest++.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pugixml.hpp"
+#include "util/blitz_typedefs.hpp"
+#include "util/h5file.hpp"
+#include "core/core_mesh.hpp"
+#include "input_proc.hpp"
+#include "solvers/fixed_source_solver.hpp"
+
+using namespace mocc;
+
+namespace {
+// Number of groups in the C5G7 library
+const int NG = 7;
+
+// Write a flat, fast-group-only external source for the fixed_source.xml
+// problem
+void write_source()
+{
+    pugi::xml_document doc;
+    pugi::xml_parse_result result = doc.load_file("fixed_source.xml");
+    REQUIRE CHECK(result);
+    CoreMesh mesh(doc);
+
+    ArrayB2 source(NG, (int)mesh.n_reg(MeshTreatment::TRUE));
+    source                         = 0.0;
+    source(0, blitz::Range::all()) = 1.0;
+
+    H5Node h5f("fixed_source.h5", H5Access::WRITE);
+    h5f.write("source", source);
+    return;
+}
+
+// Solve the fixed_source.xml problem with the passed command-line
+// amendments, and return the converged scalar flux
+ArrayB2 solve_fixed_source(const std::vector<std::string> &amendments)
+{
+    std::vector<std::string> args = {"int_test"};
+    for (const auto &a : amendments) {
+        args.push_back("-a");
+        args.push_back(a);
+    }
+    args.push_back("fixed_source.xml");
+
+    InputProcessor input_proc(args);
+    input_proc.process();
+    auto solver =
+        std::dynamic_pointer_cast<FixedSourceSolver>(input_proc.solver());
+    REQUIRE CHECK(solver);
+    solver->solve();
+
+    ArrayB2 flux(solver->sweeper()->flux().shape());
+    flux = solver->sweeper()->flux();
+    return flux;
+}
+}
+
+/**
+ * CMFD should only change how quickly the fixed-source problem converges, not
+ * the flux that it converges to.
+ */
+TEST(test_fixed_source_cmfd)
+{
+    write_source();
+
+    ArrayB2 flux      = solve_fixed_source({});
+    ArrayB2 flux_cmfd = solve_fixed_source({"solver/cmfd=t"});
+
+    REQUIRE CHECK_EQUAL(flux.size(), flux_cmfd.size());
+    real_t flux_max = 0.0;
+    for (auto it = flux.begin(); it != flux.end(); ++it) {
+        flux_max = std::max(flux_max, std::abs(*it));
+    }
+    CHECK(flux_max > 0.0);
+
+    real_t tol = 1.0e-5 * flux_max;
+    for (int ireg = 0; ireg < flux.extent(0); ireg++) {
+        for (int ig = 0; ig < flux.extent(1); ig++) {
+            CHECK_CLOSE(flux(ireg, ig), flux_cmfd(ireg, ig), tol);
+        }
+    }
+}
+
+int main()
+{
+    return UnitTest::RunAllTests();
+}
@@ -27,6 +27,9 @@ extern std::fstream OutFile;
 // Print to both the log file and standard output
 extern TeeStream LogScreen;
 
+// Stream that discards everything written to it
+extern onullstream NullStream;
+
 void StartLogFile(std::string arg);
 
 void StopLogFile();
@@ -0,0 +1,54 @@
+/*
+   Copyright 2016 Mitchell Young
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/**
+ * \file xsl2h5.cpp
+ * \brief Convert a text "MPACT user cross-section library" to the binary
+ * HDF5 format understood by \ref mocc::MaterialLib.
+ *
+ * Usage: <tt>xsl2h5 library.xsl library.h5</tt>
+ */
+
+#include <iostream>
+#include "util/error.hpp"
+#include "util/file_scrubber.hpp"
+#include "util/h5file.hpp"
+#include "core/material_lib.hpp"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.xsl> <output.h5>"
+                  << std::endl;
+        return 1;
+    }
+
+    try {
+        mocc::FileScrubber xsl(argv[1], "!");
+        mocc::MaterialLib lib(xsl);
+
+        mocc::H5Node h5f(argv[2], mocc::H5Access::WRITE);
+        lib.output(h5f);
+
+        std::cout << "Wrote " << lib.materials().size() << " materials in "
+                  << lib.n_group() << " groups to " << argv[2] << std::endl;
+    } catch (mocc::Exception e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}